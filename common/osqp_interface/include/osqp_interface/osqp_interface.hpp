@@ -55,6 +55,9 @@ private:
   bool8_t m_work_initialized = false;
   // Exitflag
   int64_t m_exitflag;
+  // Sparsity patterns of the registered problem. The value arrays are updated in place.
+  CSC_Matrix m_P_csc;
+  CSC_Matrix m_A_csc;
 
   // Runs the solver on the stored problem.
   std::tuple<std::vector<float64_t>, std::vector<float64_t>, int64_t, int64_t, int64_t> solve();
@@ -158,6 +161,51 @@ public:
   void updateRhoInterval(const int rho_interval);
   void updateRho(const double rho);
   void updateAlpha(const double alpha);
+  void updateWarmStart(const bool warm_start);
+
+  /****************
+   * STRUCTURE-PRESERVING API
+   ****************/
+  /// \brief Check if the given matrices have the same sparsity pattern as the registered problem.
+  /// \param P_csc upper trapezoidal (n,n) matrix in CSC format.
+  /// \param A_csc (m,n) matrix in CSC format.
+  bool8_t hasSameSparsityPattern(const CSC_Matrix & P_csc, const CSC_Matrix & A_csc) const;
+
+  /// \brief Update the problem while keeping the workspace if the sparsity pattern is unchanged.
+  /// \details The workspace is set up again only when the sparsity pattern or the problem size
+  /// \details differs from the registered one. Otherwise, only the values are copied in place.
+  /// \return The exit flag of the setup or the update (Healthy condition: 0).
+  int64_t updateOrInitializeProblem(
+    const CSC_Matrix & P_csc, const CSC_Matrix & A_csc, const std::vector<float64_t> & q,
+    const std::vector<float64_t> & l, const std::vector<float64_t> & u);
+
+  /// \brief Update the non-zero values of P following the registered sparsity pattern.
+  /// \param P_vals values of the upper trapezoidal part of P in CSC order.
+  /// \return The exit flag of the update (Healthy condition: 0).
+  int64_t updatePValues(const Eigen::Ref<const Eigen::VectorXd> & P_vals);
+  /// \brief Update the non-zero values of A following the registered sparsity pattern.
+  /// \param A_vals values of A in CSC order.
+  /// \return The exit flag of the update (Healthy condition: 0).
+  int64_t updateAValues(const Eigen::Ref<const Eigen::VectorXd> & A_vals);
+  int64_t updateQ(const Eigen::Ref<const Eigen::VectorXd> & q_new);
+  int64_t updateBounds(
+    const Eigen::Ref<const Eigen::VectorXd> & l_new,
+    const Eigen::Ref<const Eigen::VectorXd> & u_new);
+
+  /// \brief Set the primal and dual variables used as the initial guess of the next solve.
+  /// \details The warm start setting has to be enabled for the initial guess to be used.
+  int64_t setWarmStart(
+    const Eigen::Ref<const Eigen::VectorXd> & primal,
+    const Eigen::Ref<const Eigen::VectorXd> & lagrange_multiplier);
+  /// \brief Set only the primal variables used as the initial guess of the next solve.
+  int64_t setPrimalWarmStart(const Eigen::Ref<const Eigen::VectorXd> & primal);
+
+  /// \brief Solves the stored problem and writes the result into the given buffers.
+  /// \details The buffers are resized to the problem size, so that no allocation happens when
+  /// \details they are reused between the optimizations of problems with the same size.
+  /// \return The status value of the solution (Solved: 1).
+  int64_t optimize(
+    std::vector<float64_t> & primal_solution, std::vector<float64_t> & lagrange_multiplier);
 
   /// \brief Get the number of iteration taken to solve the problem
   inline int64_t getTakenIter() const { return static_cast<int64_t>(m_latest_work_info.iter); }
@@ -175,6 +223,19 @@ public:
   }
   /// \brief Get the runtime of the latest problem solved
   inline float64_t getRunTime() const { return m_latest_work_info.run_time; }
+  /// \brief Get the setup time of the latest problem solved (zero when the workspace was reused)
+  inline float64_t getSetupTime() const { return m_latest_work_info.setup_time; }
+  /// \brief Get the time spent in the iterations of the latest problem solved
+  inline float64_t getSolveTime() const { return m_latest_work_info.solve_time; }
+  /// \brief Get the time spent in the data update before the latest problem solved
+  inline float64_t getUpdateTime() const { return m_latest_work_info.update_time; }
+  /// \brief Get the polish time of the latest problem solved
+  inline float64_t getPolishTime() const { return m_latest_work_info.polish_time; }
+  /// \brief Get the number of rho updates of the latest problem solved
+  inline int64_t getRhoUpdates() const
+  {
+    return static_cast<int64_t>(m_latest_work_info.rho_updates);
+  }
   /// \brief Get the objective value the latest problem solved
   inline float64_t getObjVal() const { return m_latest_work_info.obj_val; }
   /// \brief Returns flag asserting interface condition (Healthy condition: 0).
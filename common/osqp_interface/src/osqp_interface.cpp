@@ -17,12 +17,15 @@
 #include "osqp/osqp.h"
 #include "osqp_interface/csc_matrix_conv.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 namespace autoware
@@ -120,33 +123,24 @@ void OSQPInterface::updateCscA(const CSC_Matrix & A_csc)
 
 void OSQPInterface::updateQ(const std::vector<double> & q_new)
 {
-  std::vector<double> q_tmp(q_new.begin(), q_new.end());
-  double * q_dyn = q_tmp.data();
-  osqp_update_lin_cost(m_work.get(), q_dyn);
+  // OSQP copies the given array into the workspace, so no temporary buffer is needed.
+  osqp_update_lin_cost(m_work.get(), q_new.data());
 }
 
 void OSQPInterface::updateL(const std::vector<double> & l_new)
 {
-  std::vector<double> l_tmp(l_new.begin(), l_new.end());
-  double * l_dyn = l_tmp.data();
-  osqp_update_lower_bound(m_work.get(), l_dyn);
+  osqp_update_lower_bound(m_work.get(), l_new.data());
 }
 
 void OSQPInterface::updateU(const std::vector<double> & u_new)
 {
-  std::vector<double> u_tmp(u_new.begin(), u_new.end());
-  double * u_dyn = u_tmp.data();
-  osqp_update_upper_bound(m_work.get(), u_dyn);
+  osqp_update_upper_bound(m_work.get(), u_new.data());
 }
 
 void OSQPInterface::updateBounds(
   const std::vector<double> & l_new, const std::vector<double> & u_new)
 {
-  std::vector<double> l_tmp(l_new.begin(), l_new.end());
-  std::vector<double> u_tmp(u_new.begin(), u_new.end());
-  double * l_dyn = l_tmp.data();
-  double * u_dyn = u_tmp.data();
-  osqp_update_bounds(m_work.get(), l_dyn, u_dyn);
+  osqp_update_bounds(m_work.get(), l_new.data(), u_new.data());
 }
 
 void OSQPInterface::updateEpsAbs(const double eps_abs)
@@ -202,6 +196,126 @@ void OSQPInterface::updateAlpha(const double alpha)
   }
 }
 
+void OSQPInterface::updateWarmStart(const bool warm_start)
+{
+  m_settings->warm_start = warm_start;
+  if (m_work_initialized) {
+    osqp_update_warm_start(m_work.get(), warm_start);
+  }
+}
+
+bool8_t OSQPInterface::hasSameSparsityPattern(
+  const CSC_Matrix & P_csc, const CSC_Matrix & A_csc) const
+{
+  return m_P_csc.m_row_idxs == P_csc.m_row_idxs && m_P_csc.m_col_idxs == P_csc.m_col_idxs &&
+         m_A_csc.m_row_idxs == A_csc.m_row_idxs && m_A_csc.m_col_idxs == A_csc.m_col_idxs;
+}
+
+int64_t OSQPInterface::updateOrInitializeProblem(
+  const CSC_Matrix & P_csc, const CSC_Matrix & A_csc, const std::vector<float64_t> & q,
+  const std::vector<float64_t> & l, const std::vector<float64_t> & u)
+{
+  const bool8_t is_same_size = static_cast<int64_t>(q.size()) == m_param_n &&
+                               static_cast<c_int>(l.size()) == m_data->m &&
+                               static_cast<c_int>(u.size()) == m_data->m;
+  if (!m_work_initialized || !is_same_size || !hasSameSparsityPattern(P_csc, A_csc)) {
+    return initializeProblem(P_csc, A_csc, q, l, u);
+  }
+
+  // Only the values change: copy them into the registered buffers and keep the workspace,
+  // including the factorization structure and the previous solution for warm starting.
+  std::copy(P_csc.m_vals.begin(), P_csc.m_vals.end(), m_P_csc.m_vals.begin());
+  std::copy(A_csc.m_vals.begin(), A_csc.m_vals.end(), m_A_csc.m_vals.begin());
+  m_exitflag = osqp_update_P_A(
+    m_work.get(), m_P_csc.m_vals.data(), OSQP_NULL, static_cast<c_int>(m_P_csc.m_vals.size()),
+    m_A_csc.m_vals.data(), OSQP_NULL, static_cast<c_int>(m_A_csc.m_vals.size()));
+  if (m_exitflag != 0) {
+    return m_exitflag;
+  }
+  m_exitflag = osqp_update_lin_cost(m_work.get(), q.data());
+  if (m_exitflag != 0) {
+    return m_exitflag;
+  }
+  m_exitflag = osqp_update_bounds(m_work.get(), l.data(), u.data());
+  return m_exitflag;
+}
+
+int64_t OSQPInterface::updatePValues(const Eigen::Ref<const Eigen::VectorXd> & P_vals)
+{
+  if (P_vals.size() != static_cast<Eigen::Index>(m_P_csc.m_vals.size())) {
+    std::stringstream ss;
+    ss << "P_vals.size() and the number of non-zero elements of P are not the same. "
+       << "P_vals.size() = " << P_vals.size() << ", P nnz = " << m_P_csc.m_vals.size();
+    throw std::invalid_argument(ss.str());
+  }
+  std::copy(P_vals.data(), P_vals.data() + P_vals.size(), m_P_csc.m_vals.begin());
+  return osqp_update_P(
+    m_work.get(), m_P_csc.m_vals.data(), OSQP_NULL, static_cast<c_int>(m_P_csc.m_vals.size()));
+}
+
+int64_t OSQPInterface::updateAValues(const Eigen::Ref<const Eigen::VectorXd> & A_vals)
+{
+  if (A_vals.size() != static_cast<Eigen::Index>(m_A_csc.m_vals.size())) {
+    std::stringstream ss;
+    ss << "A_vals.size() and the number of non-zero elements of A are not the same. "
+       << "A_vals.size() = " << A_vals.size() << ", A nnz = " << m_A_csc.m_vals.size();
+    throw std::invalid_argument(ss.str());
+  }
+  std::copy(A_vals.data(), A_vals.data() + A_vals.size(), m_A_csc.m_vals.begin());
+  return osqp_update_A(
+    m_work.get(), m_A_csc.m_vals.data(), OSQP_NULL, static_cast<c_int>(m_A_csc.m_vals.size()));
+}
+
+int64_t OSQPInterface::updateQ(const Eigen::Ref<const Eigen::VectorXd> & q_new)
+{
+  if (q_new.size() != m_param_n) {
+    std::stringstream ss;
+    ss << "q_new.size() and the number of parameters are not the same. q_new.size() = "
+       << q_new.size() << ", n = " << m_param_n;
+    throw std::invalid_argument(ss.str());
+  }
+  return osqp_update_lin_cost(m_work.get(), q_new.data());
+}
+
+int64_t OSQPInterface::updateBounds(
+  const Eigen::Ref<const Eigen::VectorXd> & l_new, const Eigen::Ref<const Eigen::VectorXd> & u_new)
+{
+  if (l_new.size() != m_data->m || u_new.size() != m_data->m) {
+    std::stringstream ss;
+    ss << "l_new.size() or u_new.size() and the number of constraints are not the same. "
+       << "l_new.size() = " << l_new.size() << ", u_new.size() = " << u_new.size()
+       << ", m = " << m_data->m;
+    throw std::invalid_argument(ss.str());
+  }
+  return osqp_update_bounds(m_work.get(), l_new.data(), u_new.data());
+}
+
+int64_t OSQPInterface::setWarmStart(
+  const Eigen::Ref<const Eigen::VectorXd> & primal,
+  const Eigen::Ref<const Eigen::VectorXd> & lagrange_multiplier)
+{
+  if (primal.size() != m_param_n || lagrange_multiplier.size() != m_data->m) {
+    std::stringstream ss;
+    ss << "The size of the warm start variables and the problem are not the same. "
+       << "primal.size() = " << primal.size()
+       << ", lagrange_multiplier.size() = " << lagrange_multiplier.size() << ", n = " << m_param_n
+       << ", m = " << m_data->m;
+    throw std::invalid_argument(ss.str());
+  }
+  return osqp_warm_start(m_work.get(), primal.data(), lagrange_multiplier.data());
+}
+
+int64_t OSQPInterface::setPrimalWarmStart(const Eigen::Ref<const Eigen::VectorXd> & primal)
+{
+  if (primal.size() != m_param_n) {
+    std::stringstream ss;
+    ss << "primal.size() and the number of parameters are not the same. primal.size() = "
+       << primal.size() << ", n = " << m_param_n;
+    throw std::invalid_argument(ss.str());
+  }
+  return osqp_warm_start_x(m_work.get(), primal.data());
+}
+
 int64_t OSQPInterface::initializeProblem(
   const Eigen::MatrixXd & P, const Eigen::MatrixXd & A, const std::vector<float64_t> & q,
   const std::vector<float64_t> & l, const std::vector<float64_t> & u)
@@ -260,14 +374,18 @@ int64_t OSQPInterface::initializeProblem(
   /*****************
    * POPULATE DATA
    *****************/
+  // Keep the sparsity patterns so that later updates can be done in place.
+  m_P_csc = std::move(P_csc);
+  m_A_csc = std::move(A_csc);
+
   m_data->n = m_param_n;
   m_data->P = csc_matrix(
-    m_data->n, m_data->n, static_cast<c_int>(P_csc.m_vals.size()), P_csc.m_vals.data(),
-    P_csc.m_row_idxs.data(), P_csc.m_col_idxs.data());
+    m_data->n, m_data->n, static_cast<c_int>(m_P_csc.m_vals.size()), m_P_csc.m_vals.data(),
+    m_P_csc.m_row_idxs.data(), m_P_csc.m_col_idxs.data());
   m_data->q = q_dyn;
   m_data->A = csc_matrix(
-    m_data->m, m_data->n, static_cast<c_int>(A_csc.m_vals.size()), A_csc.m_vals.data(),
-    A_csc.m_row_idxs.data(), A_csc.m_col_idxs.data());
+    m_data->m, m_data->n, static_cast<c_int>(m_A_csc.m_vals.size()), m_A_csc.m_vals.data(),
+    m_A_csc.m_row_idxs.data(), m_A_csc.m_col_idxs.data());
   m_data->l = l_dyn;
   m_data->u = u_dyn;
 
@@ -317,6 +435,22 @@ OSQPInterface::optimize()
   return result;
 }
 
+int64_t OSQPInterface::optimize(
+  std::vector<float64_t> & primal_solution, std::vector<float64_t> & lagrange_multiplier)
+{
+  osqp_solve(m_work.get());
+
+  // assign() keeps the capacity of the buffers, so no allocation happens for the same problem size
+  const float64_t * sol_x = m_work->solution->x;
+  const float64_t * sol_y = m_work->solution->y;
+  primal_solution.assign(sol_x, sol_x + m_param_n);
+  lagrange_multiplier.assign(sol_y, sol_y + m_data->m);
+
+  m_latest_work_info = *(m_work->info);
+
+  return static_cast<int64_t>(m_latest_work_info.status_val);
+}
+
 std::tuple<std::vector<float64_t>, std::vector<float64_t>, int64_t, int64_t, int64_t>
 OSQPInterface::optimize(
   const Eigen::MatrixXd & P, const Eigen::MatrixXd & A, const std::vector<float64_t> & q,
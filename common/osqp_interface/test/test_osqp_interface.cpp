@@ -132,4 +132,70 @@ TEST(TestOsqpInterface, BasicQp)
     check_result(result);
   }
 }
+
+TEST(TestOsqpInterface, StructurePreservingUpdate)
+{
+  using autoware::common::osqp::calCSCMatrix;
+  using autoware::common::osqp::calCSCMatrixTrapezoidal;
+  using autoware::common::osqp::CSC_Matrix;
+
+  static const auto ep = 1.0e-8;
+
+  const Eigen::MatrixXd P = (Eigen::MatrixXd(2, 2) << 4, 1, 1, 2).finished();
+  const Eigen::MatrixXd A = (Eigen::MatrixXd(4, 2) << 1, 1, 1, 0, 0, 1, 0, 1).finished();
+  const std::vector<float64_t> q = {1.0, 1.0};
+  const std::vector<float64_t> l = {1.0, 0.0, 0.0, -autoware::common::osqp::INF};
+  const std::vector<float64_t> u = {1.0, 0.7, 0.7, autoware::common::osqp::INF};
+
+  const CSC_Matrix P_csc = calCSCMatrixTrapezoidal(P);
+  const CSC_Matrix A_csc = calCSCMatrix(A);
+
+  // Register the problem with a scaled cost which has the same sparsity pattern
+  CSC_Matrix P_ini_csc = P_csc;
+  for (auto & val : P_ini_csc.m_vals) {
+    val *= 2.0;
+  }
+  autoware::common::osqp::OSQPInterface osqp(P_ini_csc, A_csc, q, l, u, 1e-6);
+  EXPECT_TRUE(osqp.hasSameSparsityPattern(P_csc, A_csc));
+
+  std::vector<float64_t> primal;
+  std::vector<float64_t> dual;
+  EXPECT_EQ(osqp.optimize(primal, dual), 1);
+
+  // Update the values in place and reuse the output buffers
+  const Eigen::VectorXd P_vals =
+    Eigen::Map<const Eigen::VectorXd>(P_csc.m_vals.data(), P_csc.m_vals.size());
+  EXPECT_EQ(osqp.updatePValues(P_vals), 0);
+  const auto * primal_ptr = primal.data();
+  EXPECT_EQ(osqp.optimize(primal, dual), 1);
+  EXPECT_EQ(primal.data(), primal_ptr);
+  ASSERT_EQ(primal.size(), size_t(2));
+  EXPECT_NEAR(primal[0], 0.3, ep);
+  EXPECT_NEAR(primal[1], 0.7, ep);
+  ASSERT_EQ(dual.size(), size_t(4));
+  EXPECT_NEAR(dual[0], -2.9, ep);
+  EXPECT_NEAR(dual[2], 0.2, ep);
+
+  // Warm starting from the optimal solution converges immediately
+  const Eigen::VectorXd x_opt = (Eigen::VectorXd(2) << 0.3, 0.7).finished();
+  const Eigen::VectorXd y_opt = (Eigen::VectorXd(4) << -2.9, 0.0, 0.2, 0.0).finished();
+  EXPECT_EQ(osqp.setWarmStart(x_opt, y_opt), 0);
+  EXPECT_EQ(osqp.optimize(primal, dual), 1);
+  EXPECT_LE(osqp.getTakenIter(), 25);
+
+  // The same pattern only updates the values while a different one sets up the problem again
+  EXPECT_EQ(osqp.updateOrInitializeProblem(P_csc, A_csc, q, l, u), 0);
+  EXPECT_EQ(osqp.optimize(primal, dual), 1);
+  EXPECT_NEAR(primal[0], 0.3, ep);
+  EXPECT_NEAR(primal[1], 0.7, ep);
+
+  const CSC_Matrix P_diag_csc = calCSCMatrixTrapezoidal(
+    (Eigen::MatrixXd(2, 2) << 4, 0, 0, 2).finished());
+  EXPECT_FALSE(osqp.hasSameSparsityPattern(P_diag_csc, A_csc));
+  EXPECT_EQ(osqp.updateOrInitializeProblem(P_diag_csc, A_csc, q, l, u), 0);
+  EXPECT_TRUE(osqp.hasSameSparsityPattern(P_diag_csc, A_csc));
+
+  // Values which do not match the registered pattern are rejected
+  EXPECT_THROW(osqp.updatePValues(Eigen::VectorXd::Zero(3)), std::invalid_argument);
+}
 }  // namespace
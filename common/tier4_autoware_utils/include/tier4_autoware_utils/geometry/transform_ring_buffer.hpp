@@ -0,0 +1,213 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TIER4_AUTOWARE_UTILS__GEOMETRY__TRANSFORM_RING_BUFFER_HPP_
+#define TIER4_AUTOWARE_UTILS__GEOMETRY__TRANSFORM_RING_BUFFER_HPP_
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace tier4_autoware_utils
+{
+/**
+ * @brief Time ordered transforms with one writer and any number of readers, none of which locks.
+ * Every slot is guarded by a sequence number (seqlock). A reader retries nothing: if the writer
+ * overwrote a slot while it was read, the lookup fails and the caller treats it as a miss.
+ */
+class TransformRingBuffer
+{
+public:
+  /**
+   * @param capacity number of transforms kept, rounded up to a power of two
+   */
+  explicit TransformRingBuffer(const size_t capacity = 256)
+  {
+    size_t rounded_capacity = 1;
+    while (rounded_capacity < capacity) {
+      rounded_capacity <<= 1;
+    }
+    slots_ = std::make_unique<Slot[]>(rounded_capacity);
+    index_mask_ = rounded_capacity - 1;
+  }
+
+  size_t capacity() const { return index_mask_ + 1; }
+
+  size_t size() const
+  {
+    const auto num_pushed = num_pushed_.load(std::memory_order_acquire);
+    return num_pushed < capacity() ? num_pushed : capacity();
+  }
+
+  /**
+   * @brief add a transform, must only be called from one thread
+   * @return false if the stamp is not newer than the latest one
+   */
+  bool push(const int64_t stamp_ns, const Eigen::Isometry3d & transform)
+  {
+    if (stamp_ns <= latest_stamp_ns_) {
+      return false;
+    }
+    latest_stamp_ns_ = stamp_ns;
+
+    const auto index = num_pushed_.load(std::memory_order_relaxed);
+    auto & slot = slots_[index & index_mask_];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const Eigen::Vector3d translation = transform.translation();
+    const Eigen::Quaterniond rotation(transform.rotation());
+    slot.stamp_ns.store(stamp_ns, std::memory_order_relaxed);
+    slot.values[0].store(translation.x(), std::memory_order_relaxed);
+    slot.values[1].store(translation.y(), std::memory_order_relaxed);
+    slot.values[2].store(translation.z(), std::memory_order_relaxed);
+    slot.values[3].store(rotation.w(), std::memory_order_relaxed);
+    slot.values[4].store(rotation.x(), std::memory_order_relaxed);
+    slot.values[5].store(rotation.y(), std::memory_order_relaxed);
+    slot.values[6].store(rotation.z(), std::memory_order_relaxed);
+
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    num_pushed_.store(index + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief get the transform at the stamp, interpolated between the two nearest transforms
+   * @return false if the stamp is out of the buffered range or the slots were overwritten
+   */
+  bool lookup(const int64_t stamp_ns, Eigen::Isometry3d & transform) const
+  {
+    const auto num_pushed = num_pushed_.load(std::memory_order_acquire);
+    if (num_pushed == 0) {
+      return false;
+    }
+
+    uint64_t lower = num_pushed > capacity() ? num_pushed - capacity() : 0;
+    uint64_t upper = num_pushed - 1;
+    Entry lower_entry;
+    Entry upper_entry;
+    if (!read(lower, lower_entry) || !read(upper, upper_entry)) {
+      return false;
+    }
+    if (stamp_ns < lower_entry.stamp_ns || upper_entry.stamp_ns < stamp_ns) {
+      return false;
+    }
+
+    // find the two entries which enclose the stamp
+    while (upper - lower > 1) {
+      const uint64_t middle = lower + (upper - lower) / 2;
+      Entry middle_entry;
+      if (!read(middle, middle_entry)) {
+        return false;
+      }
+      if (middle_entry.stamp_ns <= stamp_ns) {
+        lower = middle;
+        lower_entry = middle_entry;
+      } else {
+        upper = middle;
+        upper_entry = middle_entry;
+      }
+    }
+
+    if (lower_entry.stamp_ns == stamp_ns || lower == upper) {
+      transform = toIsometry(lower_entry.translation, lower_entry.rotation);
+      return true;
+    }
+    const double ratio = static_cast<double>(stamp_ns - lower_entry.stamp_ns) /
+                         static_cast<double>(upper_entry.stamp_ns - lower_entry.stamp_ns);
+    transform = toIsometry(
+      lower_entry.translation + ratio * (upper_entry.translation - lower_entry.translation),
+      lower_entry.rotation.slerp(ratio, upper_entry.rotation));
+    return true;
+  }
+
+  /**
+   * @brief get the newest transform
+   * @return false if the buffer is empty
+   */
+  bool getLatest(int64_t & stamp_ns, Eigen::Isometry3d & transform) const
+  {
+    const auto num_pushed = num_pushed_.load(std::memory_order_acquire);
+    Entry entry;
+    if (num_pushed == 0 || !read(num_pushed - 1, entry)) {
+      return false;
+    }
+    stamp_ns = entry.stamp_ns;
+    transform = toIsometry(entry.translation, entry.rotation);
+    return true;
+  }
+
+private:
+  struct Slot
+  {
+    // 2 * index + 1 while the entry of index is written, 2 * index + 2 after that
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<int64_t> stamp_ns{0};
+    std::array<std::atomic<double>, 7> values{};
+  };
+
+  struct Entry
+  {
+    int64_t stamp_ns;
+    Eigen::Vector3d translation;
+    Eigen::Quaterniond rotation;
+  };
+
+  static Eigen::Isometry3d toIsometry(
+    const Eigen::Vector3d & translation, const Eigen::Quaterniond & rotation)
+  {
+    Eigen::Isometry3d transform = Eigen::Isometry3d::Identity();
+    transform.translate(translation);
+    transform.rotate(rotation.normalized());
+    return transform;
+  }
+
+  bool read(const uint64_t index, Entry & entry) const
+  {
+    const auto & slot = slots_[index & index_mask_];
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      return false;
+    }
+
+    entry.stamp_ns = slot.stamp_ns.load(std::memory_order_relaxed);
+    entry.translation = Eigen::Vector3d(
+      slot.values[0].load(std::memory_order_relaxed),
+      slot.values[1].load(std::memory_order_relaxed),
+      slot.values[2].load(std::memory_order_relaxed));
+    entry.rotation = Eigen::Quaterniond(
+      slot.values[3].load(std::memory_order_relaxed),
+      slot.values[4].load(std::memory_order_relaxed),
+      slot.values[5].load(std::memory_order_relaxed),
+      slot.values[6].load(std::memory_order_relaxed));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+  }
+
+  std::unique_ptr<Slot[]> slots_;
+  uint64_t index_mask_;
+  std::atomic<uint64_t> num_pushed_{0};
+
+  // only accessed by the writer
+  int64_t latest_stamp_ns_{std::numeric_limits<int64_t>::min()};
+};
+}  // namespace tier4_autoware_utils
+
+#endif  // TIER4_AUTOWARE_UTILS__GEOMETRY__TRANSFORM_RING_BUFFER_HPP_
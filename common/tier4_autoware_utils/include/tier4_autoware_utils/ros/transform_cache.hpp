@@ -0,0 +1,270 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TIER4_AUTOWARE_UTILS__ROS__TRANSFORM_CACHE_HPP_
+#define TIER4_AUTOWARE_UTILS__ROS__TRANSFORM_CACHE_HPP_
+
+#include "tier4_autoware_utils/geometry/transform_ring_buffer.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <rclcpp/rclcpp.hpp>
+
+#include <geometry_msgs/msg/transform.hpp>
+#include <tf2_msgs/msg/tf_message.hpp>
+
+#include <boost/optional.hpp>
+
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/create_timer_ros.h>
+#include <tf2_ros/qos.hpp>
+#include <tf2_ros/transform_listener.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace tier4_autoware_utils
+{
+struct TransformCacheStatistics
+{
+  uint64_t static_hits{0};
+  uint64_t static_misses{0};
+  uint64_t dynamic_hits{0};
+  uint64_t dynamic_misses{0};
+  double average_latency_us{0.0};
+};
+
+/**
+ * @brief Cache of transforms for the hot path, none of the queries blocks.
+ *
+ * Static transforms (e.g. sensor extrinsics) are looked up from tf2 once and then kept as
+ * immutable Eigen transforms. The dynamic transform from `dynamic_source_frame` to
+ * `dynamic_target_frame` (map and base_link by default) is written to a lock-free ring buffer on
+ * every /tf message and interpolated at the queried stamp.
+ */
+class TransformCache
+{
+public:
+  explicit TransformCache(
+    rclcpp::Node * node, const std::string & dynamic_target_frame = "map",
+    const std::string & dynamic_source_frame = "base_link", const size_t capacity = 256)
+  : logger_(node->get_logger()),
+    dynamic_target_frame_(dynamic_target_frame),
+    dynamic_source_frame_(dynamic_source_frame),
+    dynamic_transforms_(capacity),
+    static_transforms_(std::make_shared<const StaticTransformMap>())
+  {
+    tf_buffer_ = std::make_shared<tf2_ros::Buffer>(node->get_clock());
+    auto timer_interface = std::make_shared<tf2_ros::CreateTimerROS>(
+      node->get_node_base_interface(), node->get_node_timers_interface());
+    tf_buffer_->setCreateTimerInterface(timer_interface);
+    tf_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
+
+    // /tf is received on a dedicated thread, which is the only writer of the ring buffer
+    callback_group_ =
+      node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive, false);
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = callback_group_;
+    sub_tf_ = node->create_subscription<tf2_msgs::msg::TFMessage>(
+      "/tf", tf2_ros::DynamicListenerQoS(),
+      std::bind(&TransformCache::onTransform, this, std::placeholders::_1), options);
+    executor_.add_callback_group(callback_group_, node->get_node_base_interface());
+    executor_thread_ = std::thread([this]() { executor_.spin(); });
+  }
+
+  ~TransformCache()
+  {
+    executor_.cancel();
+    if (executor_thread_.joinable()) {
+      executor_thread_.join();
+    }
+  }
+
+  TransformCache(const TransformCache &) = delete;
+  TransformCache & operator=(const TransformCache &) = delete;
+
+  /**
+   * @brief transform from `source_frame` to `target_frame`, which must not change over time
+   * @return none if tf2 does not know the transform yet
+   */
+  boost::optional<Eigen::Isometry3d> getStaticTransform(
+    const std::string & target_frame, const std::string & source_frame)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    const auto key = target_frame + "\n" + source_frame;
+    const auto static_transforms = std::atomic_load(&static_transforms_);
+    const auto itr = static_transforms->find(key);
+    if (itr != static_transforms->end()) {
+      static_hits_.fetch_add(1, std::memory_order_relaxed);
+      addLatency(start);
+      return itr->second;
+    }
+
+    // resolve it once, without waiting for tf2
+    Eigen::Isometry3d transform;
+    try {
+      transform = toIsometry(
+        tf_buffer_->lookupTransform(target_frame, source_frame, tf2::TimePointZero).transform);
+    } catch (tf2::TransformException & ex) {
+      RCLCPP_WARN_THROTTLE(
+        logger_, *tf_buffer_->getClock(), 5000, "failed to get transform from %s to %s: %s",
+        source_frame.c_str(), target_frame.c_str(), ex.what());
+      static_misses_.fetch_add(1, std::memory_order_relaxed);
+      addLatency(start);
+      return {};
+    }
+
+    {
+      // copy on write, readers keep using the map they loaded
+      std::lock_guard<std::mutex> lock(static_mutex_);
+      auto new_static_transforms =
+        std::make_shared<StaticTransformMap>(*std::atomic_load(&static_transforms_));
+      new_static_transforms->emplace(key, transform);
+      std::atomic_store(
+        &static_transforms_, std::shared_ptr<const StaticTransformMap>(new_static_transforms));
+    }
+    static_misses_.fetch_add(1, std::memory_order_relaxed);
+    addLatency(start);
+    return transform;
+  }
+
+  /**
+   * @brief dynamic transform at the stamp, interpolated between the buffered transforms
+   * @return none if the stamp is out of the buffered range
+   */
+  boost::optional<Eigen::Isometry3d> getDynamicTransform(const rclcpp::Time & stamp)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    Eigen::Isometry3d transform;
+    const bool is_found = dynamic_transforms_.lookup(stamp.nanoseconds(), transform);
+    (is_found ? dynamic_hits_ : dynamic_misses_).fetch_add(1, std::memory_order_relaxed);
+    addLatency(start);
+    if (!is_found) {
+      return {};
+    }
+    return transform;
+  }
+
+  /**
+   * @brief newest dynamic transform
+   * @return none if no transform has been received
+   */
+  boost::optional<Eigen::Isometry3d> getLatestDynamicTransform()
+  {
+    const auto start = std::chrono::steady_clock::now();
+    int64_t stamp_ns;
+    Eigen::Isometry3d transform;
+    const bool is_found = dynamic_transforms_.getLatest(stamp_ns, transform);
+    (is_found ? dynamic_hits_ : dynamic_misses_).fetch_add(1, std::memory_order_relaxed);
+    addLatency(start);
+    if (!is_found) {
+      return {};
+    }
+    return transform;
+  }
+
+  TransformCacheStatistics getStatistics() const
+  {
+    TransformCacheStatistics statistics;
+    statistics.static_hits = static_hits_.load(std::memory_order_relaxed);
+    statistics.static_misses = static_misses_.load(std::memory_order_relaxed);
+    statistics.dynamic_hits = dynamic_hits_.load(std::memory_order_relaxed);
+    statistics.dynamic_misses = dynamic_misses_.load(std::memory_order_relaxed);
+    const auto num_queries = statistics.static_hits + statistics.static_misses +
+                             statistics.dynamic_hits + statistics.dynamic_misses;
+    if (num_queries > 0) {
+      statistics.average_latency_us =
+        static_cast<double>(total_latency_ns_.load(std::memory_order_relaxed)) * 1e-3 /
+        static_cast<double>(num_queries);
+    }
+    return statistics;
+  }
+
+  std::shared_ptr<tf2_ros::Buffer> getBuffer() const { return tf_buffer_; }
+
+private:
+  using StaticTransformMap = std::unordered_map<std::string, Eigen::Isometry3d>;
+
+  static Eigen::Isometry3d toIsometry(const geometry_msgs::msg::Transform & transform)
+  {
+    Eigen::Isometry3d isometry = Eigen::Isometry3d::Identity();
+    isometry.translate(
+      Eigen::Vector3d(transform.translation.x, transform.translation.y, transform.translation.z));
+    isometry.rotate(Eigen::Quaterniond(
+      transform.rotation.w, transform.rotation.x, transform.rotation.y, transform.rotation.z));
+    return isometry;
+  }
+
+  void onTransform(const tf2_msgs::msg::TFMessage::ConstSharedPtr msg)
+  {
+    for (const auto & transform : msg->transforms) {
+      if (
+        transform.header.frame_id == dynamic_target_frame_ &&
+        transform.child_frame_id == dynamic_source_frame_) {
+        dynamic_transforms_.push(
+          rclcpp::Time(transform.header.stamp).nanoseconds(), toIsometry(transform.transform));
+        return;
+      }
+    }
+
+    // the frames are not directly connected, ask tf2 for the chain
+    try {
+      const auto transform = tf_buffer_->lookupTransform(
+        dynamic_target_frame_, dynamic_source_frame_, tf2::TimePointZero);
+      dynamic_transforms_.push(
+        rclcpp::Time(transform.header.stamp).nanoseconds(), toIsometry(transform.transform));
+    } catch (tf2::TransformException &) {
+      // not available yet
+    }
+  }
+
+  void addLatency(const std::chrono::steady_clock::time_point & start)
+  {
+    const auto latency = std::chrono::steady_clock::now() - start;
+    total_latency_ns_.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(),
+      std::memory_order_relaxed);
+  }
+
+  rclcpp::Logger logger_;
+  std::string dynamic_target_frame_;
+  std::string dynamic_source_frame_;
+
+  std::shared_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::shared_ptr<tf2_ros::TransformListener> tf_listener_;
+
+  TransformRingBuffer dynamic_transforms_;
+
+  std::mutex static_mutex_;
+  std::shared_ptr<const StaticTransformMap> static_transforms_;
+
+  std::atomic<uint64_t> static_hits_{0};
+  std::atomic<uint64_t> static_misses_{0};
+  std::atomic<uint64_t> dynamic_hits_{0};
+  std::atomic<uint64_t> dynamic_misses_{0};
+  std::atomic<uint64_t> total_latency_ns_{0};
+
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  rclcpp::Subscription<tf2_msgs::msg::TFMessage>::SharedPtr sub_tf_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  std::thread executor_thread_;
+};
+}  // namespace tier4_autoware_utils
+
+#endif  // TIER4_AUTOWARE_UTILS__ROS__TRANSFORM_CACHE_HPP_
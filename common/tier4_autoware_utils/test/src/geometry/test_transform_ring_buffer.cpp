@@ -0,0 +1,153 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tier4_autoware_utils/geometry/transform_ring_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+Eigen::Isometry3d createTransform(const double x, const double y, const double yaw)
+{
+  Eigen::Isometry3d transform = Eigen::Isometry3d::Identity();
+  transform.translate(Eigen::Vector3d(x, y, 0.0));
+  transform.rotate(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+  return transform;
+}
+
+double getYaw(const Eigen::Isometry3d & transform)
+{
+  return std::atan2(transform.rotation()(1, 0), transform.rotation()(0, 0));
+}
+}  // namespace
+
+TEST(transform_ring_buffer, capacity)
+{
+  using tier4_autoware_utils::TransformRingBuffer;
+
+  EXPECT_EQ(TransformRingBuffer(1).capacity(), 1U);
+  EXPECT_EQ(TransformRingBuffer(100).capacity(), 128U);
+  EXPECT_EQ(TransformRingBuffer(256).capacity(), 256U);
+}
+
+TEST(transform_ring_buffer, empty)
+{
+  using tier4_autoware_utils::TransformRingBuffer;
+
+  const TransformRingBuffer buffer(4);
+  Eigen::Isometry3d transform;
+  int64_t stamp_ns;
+  EXPECT_EQ(buffer.size(), 0U);
+  EXPECT_FALSE(buffer.lookup(0, transform));
+  EXPECT_FALSE(buffer.getLatest(stamp_ns, transform));
+}
+
+TEST(transform_ring_buffer, lookup)
+{
+  using tier4_autoware_utils::TransformRingBuffer;
+
+  TransformRingBuffer buffer(8);
+  EXPECT_TRUE(buffer.push(100, createTransform(0.0, 0.0, 0.0)));
+  EXPECT_TRUE(buffer.push(200, createTransform(2.0, 4.0, M_PI_2)));
+  EXPECT_TRUE(buffer.push(300, createTransform(4.0, 4.0, M_PI_2)));
+
+  Eigen::Isometry3d transform;
+
+  // exact
+  EXPECT_TRUE(buffer.lookup(200, transform));
+  EXPECT_NEAR(transform.translation().x(), 2.0, 1e-9);
+  EXPECT_NEAR(transform.translation().y(), 4.0, 1e-9);
+  EXPECT_NEAR(getYaw(transform), M_PI_2, 1e-9);
+
+  // interpolated
+  EXPECT_TRUE(buffer.lookup(150, transform));
+  EXPECT_NEAR(transform.translation().x(), 1.0, 1e-9);
+  EXPECT_NEAR(transform.translation().y(), 2.0, 1e-9);
+  EXPECT_NEAR(getYaw(transform), M_PI_4, 1e-9);
+
+  EXPECT_TRUE(buffer.lookup(300, transform));
+  EXPECT_NEAR(transform.translation().x(), 4.0, 1e-9);
+
+  // out of range
+  EXPECT_FALSE(buffer.lookup(99, transform));
+  EXPECT_FALSE(buffer.lookup(301, transform));
+
+  int64_t stamp_ns;
+  EXPECT_TRUE(buffer.getLatest(stamp_ns, transform));
+  EXPECT_EQ(stamp_ns, 300);
+  EXPECT_NEAR(transform.translation().x(), 4.0, 1e-9);
+}
+
+TEST(transform_ring_buffer, push)
+{
+  using tier4_autoware_utils::TransformRingBuffer;
+
+  TransformRingBuffer buffer(4);
+  EXPECT_TRUE(buffer.push(100, createTransform(0.0, 0.0, 0.0)));
+  EXPECT_FALSE(buffer.push(100, createTransform(1.0, 0.0, 0.0)));
+  EXPECT_FALSE(buffer.push(50, createTransform(1.0, 0.0, 0.0)));
+  EXPECT_EQ(buffer.size(), 1U);
+
+  // the oldest transforms are overwritten
+  for (int64_t i = 2; i <= 10; ++i) {
+    EXPECT_TRUE(buffer.push(100 * i, createTransform(static_cast<double>(i), 0.0, 0.0)));
+  }
+  EXPECT_EQ(buffer.size(), 4U);
+
+  Eigen::Isometry3d transform;
+  EXPECT_FALSE(buffer.lookup(600, transform));
+  EXPECT_TRUE(buffer.lookup(700, transform));
+  EXPECT_NEAR(transform.translation().x(), 7.0, 1e-9);
+  EXPECT_TRUE(buffer.lookup(950, transform));
+  EXPECT_NEAR(transform.translation().x(), 9.5, 1e-9);
+}
+
+TEST(transform_ring_buffer, concurrent_lookup)
+{
+  using tier4_autoware_utils::TransformRingBuffer;
+
+  // x is always equal to the stamp, so any torn read would show up as a mismatch
+  TransformRingBuffer buffer(16);
+  constexpr int64_t num_pushes = 100000;
+  std::atomic<bool> is_done{false};
+
+  std::thread writer([&]() {
+    for (int64_t i = 1; i <= num_pushes; ++i) {
+      buffer.push(i, createTransform(static_cast<double>(i), 0.0, 0.0));
+    }
+    is_done = true;
+  });
+
+  while (!is_done) {
+    int64_t stamp_ns;
+    Eigen::Isometry3d transform;
+    if (!buffer.getLatest(stamp_ns, transform)) {
+      continue;
+    }
+    EXPECT_NEAR(transform.translation().x(), static_cast<double>(stamp_ns), 1e-9);
+    if (buffer.lookup(stamp_ns - 1, transform)) {
+      EXPECT_NEAR(transform.translation().x(), static_cast<double>(stamp_ns - 1), 1e-9);
+    }
+  }
+  writer.join();
+
+  int64_t stamp_ns;
+  Eigen::Isometry3d transform;
+  EXPECT_TRUE(buffer.getLatest(stamp_ns, transform));
+  EXPECT_EQ(stamp_ns, num_pushes);
+}
@@ -0,0 +1,326 @@
+// Copyright 2022 Arm Limited and Contributors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tvm_utility/pipeline.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#ifndef TVM_UTILITY__ASYNC_PIPELINE_HPP_
+#define TVM_UTILITY__ASYNC_PIPELINE_HPP_
+
+namespace tvm_utility
+{
+namespace pipeline
+{
+
+/**
+ * @class BoundedQueue
+ * @brief Blocking FIFO queue with a maximum size, used between the stages of
+ * an AsyncPipeline.
+ */
+template <class T>
+class BoundedQueue
+{
+public:
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+  /**
+   * @brief Add an item, waiting while the queue is full.
+   *
+   * @return false if the queue has been closed
+   */
+  bool push(T item)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Take the oldest item, waiting while the queue is empty.
+   *
+   * @return false if the queue has been closed and all items have been taken
+   */
+  bool pop(T & item)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) {
+      return false;
+    }
+    item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Wake up all waiting threads. No item can be added after this.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+  }
+
+private:
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<T> items_;
+  bool closed_{false};
+};
+
+struct StageStatistics
+{
+  // Number of inputs the stage has run on, including failed ones
+  size_t num_processed{0};
+  double latest_latency_ms{0.0};
+  double average_latency_ms{0.0};
+  // Number of inputs waiting for the stage
+  size_t queue_depth{0};
+};
+
+struct AsyncPipelineStatistics
+{
+  StageStatistics pre_processor;
+  StageStatistics inference_engine;
+  StageStatistics post_processor;
+};
+
+/**
+ * @class AsyncPipeline
+ * @brief Inference Pipeline whose 3 stages run on dedicated threads and are
+ * connected by bounded queues, so that pre-processing of an input overlaps
+ * with the inference of the previous one. Outputs are returned in a callback,
+ * in the order of the inputs, from the post-processor thread.
+ *
+ * The stages must not share state with each other, and tensors passed between
+ * stages must not be reused by the producing stage while they are in flight
+ * (see TVMArrayContainerPool).
+ */
+template <class PreProcessorType, class InferenceEngineType, class PostProcessorType>
+class AsyncPipeline
+{
+  using InputType = decltype(std::declval<PreProcessorType>().input_type_indicator_);
+  using OutputType = decltype(std::declval<PostProcessorType>().output_type_indicator_);
+
+public:
+  using Callback = std::function<void(const OutputType &)>;
+
+  /**
+   * @brief Construct a new AsyncPipeline object and start its threads
+   *
+   * @param pre_processor a PreProcessor object
+   * @param inference_engine a InferenceEngine object
+   * @param post_processor a PostProcessor object
+   * @param callback function called with the output of every input
+   * @param queue_capacity maximum number of inputs waiting in front of each stage
+   */
+  AsyncPipeline(
+    PreProcessorType pre_processor, InferenceEngineType inference_engine,
+    PostProcessorType post_processor, Callback callback, size_t queue_capacity = 2)
+  : pre_processor_(std::move(pre_processor)),
+    inference_engine_(std::move(inference_engine)),
+    post_processor_(std::move(post_processor)),
+    callback_(std::move(callback)),
+    input_queue_(queue_capacity),
+    input_tensor_queue_(queue_capacity),
+    output_tensor_queue_(queue_capacity)
+  {
+    pre_processor_thread_ = std::thread([this] {
+      runStage(input_queue_, pre_processor_statistics_, [this](auto & in) {
+        return input_tensor_queue_.push(pre_processor_.schedule(in));
+      });
+      input_tensor_queue_.close();
+    });
+    inference_engine_thread_ = std::thread([this] {
+      runStage(input_tensor_queue_, inference_engine_statistics_, [this](auto & in) {
+        return output_tensor_queue_.push(inference_engine_.schedule(in));
+      });
+      output_tensor_queue_.close();
+    });
+    post_processor_thread_ = std::thread([this] {
+      runStage(output_tensor_queue_, post_processor_statistics_, [this](auto & in) {
+        callback_(post_processor_.schedule(in));
+        return false;
+      });
+    });
+  }
+
+  ~AsyncPipeline()
+  {
+    input_queue_.close();
+    input_tensor_queue_.close();
+    output_tensor_queue_.close();
+    pre_processor_thread_.join();
+    inference_engine_thread_.join();
+    post_processor_thread_.join();
+  }
+
+  AsyncPipeline(const AsyncPipeline &) = delete;
+  AsyncPipeline & operator=(const AsyncPipeline &) = delete;
+
+  /**
+   * @brief Push data into the pipeline. Waits while the pre-processor queue
+   * is full. An exception thrown by a stage for an earlier input is rethrown
+   * here, that input has no output.
+   *
+   * @param input The data to push into the pipeline
+   */
+  void schedule(const InputType & input)
+  {
+    rethrowStageException();
+    {
+      std::lock_guard<std::mutex> lock(progress_mutex_);
+      ++num_scheduled_;
+    }
+    if (!input_queue_.push(input)) {
+      finishInput();
+    }
+  }
+
+  /**
+   * @brief Wait until the outputs of all scheduled inputs have been returned.
+   */
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock(progress_mutex_);
+    progress_.wait(lock, [this] { return num_finished_ == num_scheduled_; });
+    lock.unlock();
+    rethrowStageException();
+  }
+
+  AsyncPipelineStatistics getStatistics() const
+  {
+    AsyncPipelineStatistics statistics;
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    statistics.pre_processor = pre_processor_statistics_;
+    statistics.inference_engine = inference_engine_statistics_;
+    statistics.post_processor = post_processor_statistics_;
+    statistics.pre_processor.queue_depth = input_queue_.size();
+    statistics.inference_engine.queue_depth = input_tensor_queue_.size();
+    statistics.post_processor.queue_depth = output_tensor_queue_.size();
+    return statistics;
+  }
+
+private:
+  /**
+   * @brief Run one stage until its input queue is closed. `process` returns
+   * true if the input moved on to the next stage, otherwise the input is done.
+   */
+  template <class StageInputType, class ProcessFunction>
+  void runStage(
+    BoundedQueue<StageInputType> & input_queue, StageStatistics & statistics,
+    ProcessFunction process)
+  {
+    StageInputType input;
+    while (input_queue.pop(input)) {
+      const auto start = std::chrono::steady_clock::now();
+      bool is_handed_over = false;
+      try {
+        is_handed_over = process(input);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        if (!stage_exception_) {
+          stage_exception_ = std::current_exception();
+        }
+      }
+      const auto end = std::chrono::steady_clock::now();
+
+      {
+        const double latency_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::lock_guard<std::mutex> lock(statistics_mutex_);
+        ++statistics.num_processed;
+        statistics.latest_latency_ms = latency_ms;
+        statistics.average_latency_ms += (latency_ms - statistics.average_latency_ms) /
+                                         static_cast<double>(statistics.num_processed);
+      }
+      if (!is_handed_over) {
+        finishInput();
+      }
+      // release the tensors of the input to their pool
+      input = StageInputType{};
+    }
+  }
+
+  void finishInput()
+  {
+    std::lock_guard<std::mutex> lock(progress_mutex_);
+    ++num_finished_;
+    progress_.notify_all();
+  }
+
+  void rethrowStageException()
+  {
+    std::exception_ptr stage_exception;
+    {
+      std::lock_guard<std::mutex> lock(progress_mutex_);
+      std::swap(stage_exception, stage_exception_);
+    }
+    if (stage_exception) {
+      std::rethrow_exception(stage_exception);
+    }
+  }
+
+  PreProcessorType pre_processor_;
+  InferenceEngineType inference_engine_;
+  PostProcessorType post_processor_;
+  Callback callback_;
+
+  BoundedQueue<InputType> input_queue_;
+  BoundedQueue<TVMArrayContainerVector> input_tensor_queue_;
+  BoundedQueue<TVMArrayContainerVector> output_tensor_queue_;
+
+  mutable std::mutex statistics_mutex_;
+  StageStatistics pre_processor_statistics_;
+  StageStatistics inference_engine_statistics_;
+  StageStatistics post_processor_statistics_;
+
+  std::mutex progress_mutex_;
+  std::condition_variable progress_;
+  size_t num_scheduled_{0};
+  size_t num_finished_{0};
+  std::exception_ptr stage_exception_{nullptr};
+
+  std::thread pre_processor_thread_;
+  std::thread inference_engine_thread_;
+  std::thread post_processor_thread_;
+};
+
+}  // namespace pipeline
+}  // namespace tvm_utility
+#endif  // TVM_UTILITY__ASYNC_PIPELINE_HPP_
@@ -22,6 +22,8 @@
 
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,6 +52,13 @@ public:
     handle_ = std::make_shared<TVMArrayHandle>(x);
   }
 
+  /**
+   * @brief Wrap an array whose lifetime is managed by the deleter of the handle.
+   */
+  explicit TVMArrayContainer(std::shared_ptr<TVMArrayHandle> handle) : handle_(std::move(handle))
+  {
+  }
+
   TVMArrayHandle getArray() const { return *handle_.get(); }
 
 private:
@@ -62,6 +71,115 @@ private:
 
 using TVMArrayContainerVector = std::vector<TVMArrayContainer>;
 
+/**
+ * @class TVMArrayContainerPool
+ * @brief Thread safe pool of tensors of fixed shapes. The tensors of an acquired
+ * TVMArrayContainerVector go back to the pool once the last copy of them is
+ * destroyed, so that steady state operation does not allocate.
+ */
+class TVMArrayContainerPool
+{
+public:
+  TVMArrayContainerPool() = default;
+
+  TVMArrayContainerPool(
+    std::vector<std::vector<int64_t>> shapes, DLDataTypeCode dtype_code, int32_t dtype_bits,
+    int32_t dtype_lanes, DLDeviceType device_type, int32_t device_id)
+  : state_(std::make_shared<State>())
+  {
+    state_->shapes = std::move(shapes);
+    state_->dtype_code = dtype_code;
+    state_->dtype_bits = dtype_bits;
+    state_->dtype_lanes = dtype_lanes;
+    state_->device_type = device_type;
+    state_->device_id = device_id;
+    state_->free_arrays.resize(state_->shapes.size());
+  }
+
+  /**
+   * @brief Get one tensor of each shape, allocating new ones if the pool is empty.
+   */
+  TVMArrayContainerVector acquire()
+  {
+    if (!state_) {
+      throw std::runtime_error("the tensor pool is not initialized");
+    }
+
+    TVMArrayContainerVector arrays;
+    arrays.reserve(state_->shapes.size());
+    for (size_t index = 0; index < state_->shapes.size(); ++index) {
+      TVMArrayHandle x{nullptr};
+      {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->free_arrays[index].empty()) {
+          x = state_->free_arrays[index].back();
+          state_->free_arrays[index].pop_back();
+        }
+      }
+      if (x == nullptr) {
+        auto & shape = state_->shapes[index];
+        TVMArrayAlloc(
+          &shape[0], static_cast<int>(shape.size()), state_->dtype_code, state_->dtype_bits,
+          state_->dtype_lanes, state_->device_type, state_->device_id, &x);
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        ++state_->num_allocated;
+      }
+
+      // the pool may be gone when the tensor is released, then it is freed
+      std::weak_ptr<State> weak_state = state_;
+      arrays.emplace_back(
+        std::shared_ptr<TVMArrayHandle>(new TVMArrayHandle(x), [weak_state, index](auto ptr) {
+          if (auto state = weak_state.lock()) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->free_arrays[index].push_back(*ptr);
+          } else {
+            TVMArrayFree(*ptr);
+          }
+          delete ptr;
+        }));
+    }
+    return arrays;
+  }
+
+  /**
+   * @brief Number of tensor sets allocated so far.
+   */
+  size_t numAllocated() const
+  {
+    if (!state_) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->shapes.empty() ? 0 : state_->num_allocated / state_->shapes.size();
+  }
+
+private:
+  struct State
+  {
+    ~State()
+    {
+      for (auto & arrays : free_arrays) {
+        for (auto & x : arrays) {
+          TVMArrayFree(x);
+        }
+      }
+    }
+
+    std::vector<std::vector<int64_t>> shapes;
+    DLDataTypeCode dtype_code;
+    int32_t dtype_bits;
+    int32_t dtype_lanes;
+    DLDeviceType device_type;
+    int32_t device_id;
+
+    std::mutex mutex;
+    std::vector<std::vector<TVMArrayHandle>> free_arrays;
+    size_t num_allocated{0};
+  };
+
+  std::shared_ptr<State> state_{nullptr};
+};
+
 /**
  * @class PipelineStage
  * @brief Base class for all types of pipeline stages.
@@ -153,7 +271,8 @@ public:
   }
 
   /**
-   * @brief run the pipeline. Return asynchronously in a callback.
+   * @brief run the pipeline on the calling thread. See AsyncPipeline for
+   * running the stages concurrently.
    *
    * @param input The data to push into the pipeline
    * @return The pipeline output
@@ -264,11 +383,13 @@ public:
     // Get the function to get output data
     get_output = runtime_mod.GetFunction("get_output");
 
+    std::vector<std::vector<int64_t>> output_shapes;
     for (auto & output_config : config.network_outputs) {
-      output_.push_back(TVMArrayContainer(
-        output_config.second, config.tvm_dtype_code, config.tvm_dtype_bits, config.tvm_dtype_lanes,
-        kDLCPU, 0));
+      output_shapes.push_back(output_config.second);
     }
+    output_pool_ = TVMArrayContainerPool(
+      output_shapes, config.tvm_dtype_code, config.tvm_dtype_bits, config.tvm_dtype_lanes, kDLCPU,
+      0);
   }
 
   TVMArrayContainerVector schedule(const TVMArrayContainerVector & input)
@@ -284,19 +405,20 @@ public:
     // Execute the inference
     execute();
 
-    // Get output(s)
-    for (uint32_t index = 0; index < output_.size(); ++index) {
-      if (output_[index].getArray() == nullptr) {
+    // Get output(s), into tensors which are not in use by a previous result
+    auto output = output_pool_.acquire();
+    for (uint32_t index = 0; index < output.size(); ++index) {
+      if (output[index].getArray() == nullptr) {
         throw std::runtime_error("output variable is null");
       }
-      get_output(index, output_[index].getArray());
+      get_output(index, output[index].getArray());
     }
-    return output_;
+    return output;
   }
 
 private:
   InferenceEngineTVMConfig config_;
-  TVMArrayContainerVector output_;
+  TVMArrayContainerPool output_pool_;
   tvm::runtime::PackedFunc set_input;
   tvm::runtime::PackedFunc execute;
   tvm::runtime::PackedFunc get_output;
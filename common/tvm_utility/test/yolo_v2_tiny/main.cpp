@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "gtest/gtest.h"
+#include "tvm_utility/async_pipeline.hpp"
 #include "tvm_utility/model_zoo.hpp"
 #include "tvm_utility/pipeline.hpp"
 
@@ -50,17 +51,12 @@ public:
     network_input_depth(config.network_inputs[0].second[3]),
     network_datatype_bytes(config.tvm_dtype_bits / 8)
   {
-    // Allocate input variable
+    // Input variables are taken from a pool so that an input can be prepared while the previous
+    // one is still in use by the inference engine
     std::vector<int64_t> shape_x{1, network_input_width, network_input_height, network_input_depth};
-    tvm_utility::pipeline::TVMArrayContainer x{
-      shape_x,
-      config.tvm_dtype_code,
-      config.tvm_dtype_bits,
-      config.tvm_dtype_lanes,
-      config.tvm_device_type,
-      config.tvm_device_id};
-
-    output = x;
+    output_pool = tvm_utility::pipeline::TVMArrayContainerPool(
+      {shape_x}, config.tvm_dtype_code, config.tvm_dtype_bits, config.tvm_dtype_lanes,
+      config.tvm_device_type, config.tvm_device_id);
   }
 
   // The cv::Mat can't be used as an input because it throws an exception when
@@ -99,11 +95,12 @@ public:
     // cv library uses BGR as a default color format, the network expects the data in RGB format
     cv::cvtColor(image_3f, image_3f, cv::COLOR_BGR2RGB);
 
+    auto output = output_pool.acquire();
     TVMArrayCopyFromBytes(
-      output.getArray(), image_3f.data,
+      output[0].getArray(), image_3f.data,
       network_input_width * network_input_height * network_input_depth * network_datatype_bytes);
 
-    return {output};
+    return output;
   }
 
 private:
@@ -111,7 +108,7 @@ private:
   int64_t network_input_height;
   int64_t network_input_depth;
   int64_t network_datatype_bytes;
-  tvm_utility::pipeline::TVMArrayContainer output;
+  tvm_utility::pipeline::TVMArrayContainerPool output_pool;
 };
 
 class PostProcessorYoloV2Tiny : public tvm_utility::pipeline::PostProcessor<std::vector<float>>
@@ -232,6 +229,22 @@ private:
   std::vector<std::pair<float, float>> anchors{};
 };
 
+std::vector<float> getExpectedOutput()
+{
+  // Define reference vector containing expected values, expressed as hexadecimal integers
+  std::vector<int32_t> int_output{0x3eb64594, 0x3f435656, 0x3ece1600, 0x3e99d381,
+                                  0x3f1cd6bc, 0x3f14f4dd, 0x3ed8065f, 0x3ee9f4fa,
+                                  0x3ec1b5e8, 0x3f4e7c6c, 0x3f136af1};
+
+  std::vector<float> expected_output(int_output.size());
+
+  // A memcpy means that the floats in expected_output have a well-defined binary value
+  for (size_t i = 0; i < int_output.size(); i++) {
+    memcpy(&expected_output[i], &int_output[i], sizeof(expected_output[i]));
+  }
+  return expected_output;
+}
+
 TEST(PipelineExamples, SimplePipeline)
 {
   // Instantiate the pipeline
@@ -248,17 +261,7 @@ TEST(PipelineExamples, SimplePipeline)
   // Push data input the pipeline and get the output
   auto output = pipeline.schedule(IMAGE_FILENAME);
 
-  // Define reference vector containing expected values, expressed as hexadecimal integers
-  std::vector<int32_t> int_output{0x3eb64594, 0x3f435656, 0x3ece1600, 0x3e99d381,
-                                  0x3f1cd6bc, 0x3f14f4dd, 0x3ed8065f, 0x3ee9f4fa,
-                                  0x3ec1b5e8, 0x3f4e7c6c, 0x3f136af1};
-
-  std::vector<float> expected_output(int_output.size());
-
-  // A memcpy means that the floats in expected_output have a well-defined binary value
-  for (size_t i = 0; i < int_output.size(); i++) {
-    memcpy(&expected_output[i], &int_output[i], sizeof(expected_output[i]));
-  }
+  const auto expected_output = getExpectedOutput();
 
   // Test: check if the generated output is equal to the reference
   EXPECT_EQ(expected_output.size(), output.size()) << "Unexpected output size";
@@ -267,5 +270,45 @@ TEST(PipelineExamples, SimplePipeline)
   }
 }
 
+TEST(PipelineExamples, AsyncPipeline)
+{
+  // Instantiate the pipeline
+  using PrePT = PreProcessorYoloV2Tiny;
+  using IET = tvm_utility::pipeline::InferenceEngineTVM;
+  using PostPT = PostProcessorYoloV2Tiny;
+
+  PrePT PreP{config};
+  IET IE{config};
+  PostPT PostP{config};
+
+  std::vector<std::vector<float>> outputs;
+  tvm_utility::pipeline::AsyncPipeline<PrePT, IET, PostPT> pipeline(
+    PreP, IE, PostP, [&outputs](const std::vector<float> & output) { outputs.push_back(output); });
+
+  // Push the same input several times so that the stages overlap
+  constexpr size_t num_inputs = 4;
+  for (size_t i = 0; i < num_inputs; ++i) {
+    pipeline.schedule(IMAGE_FILENAME);
+  }
+  pipeline.flush();
+
+  const auto expected_output = getExpectedOutput();
+
+  // Test: check if every output is equal to the reference
+  ASSERT_EQ(outputs.size(), num_inputs) << "Unexpected number of outputs";
+  for (const auto & output : outputs) {
+    EXPECT_EQ(expected_output.size(), output.size()) << "Unexpected output size";
+    for (size_t i = 0; i < output.size(); ++i) {
+      EXPECT_NEAR(expected_output[i], output[i], 0.0001) << "at index: " << i;
+    }
+  }
+
+  const auto statistics = pipeline.getStatistics();
+  EXPECT_EQ(statistics.pre_processor.num_processed, num_inputs);
+  EXPECT_EQ(statistics.inference_engine.num_processed, num_inputs);
+  EXPECT_EQ(statistics.post_processor.num_processed, num_inputs);
+  EXPECT_EQ(statistics.post_processor.queue_depth, 0U);
+}
+
 }  // namespace yolo_v2_tiny
 }  // namespace tvm_utility
@@ -30,6 +30,7 @@
 #include <geometry_msgs/msg/twist_stamped.hpp>
 #include <nav_msgs/msg/odometry.hpp>
 
+#include <boost/geometry/index/rtree.hpp>
 #include <boost/optional.hpp>
 
 #include <lanelet2_core/LaneletMap.h>
@@ -37,6 +38,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace lane_departure_checker
@@ -45,6 +47,7 @@ using autoware_auto_planning_msgs::msg::HADMapRoute;
 using autoware_auto_planning_msgs::msg::PathWithLaneId;
 using autoware_auto_planning_msgs::msg::Trajectory;
 using autoware_auto_planning_msgs::msg::TrajectoryPoint;
+using tier4_autoware_utils::Box2d;
 using tier4_autoware_utils::LinearRing2d;
 using tier4_autoware_utils::PoseDeviation;
 using TrajectoryPoints = std::vector<TrajectoryPoint>;
@@ -107,10 +110,37 @@ public:
   bool checkPathWillLeaveLane(
     const lanelet::ConstLanelets & lanelets, const PathWithLaneId & path) const;
 
+  /**
+   * @brief build the spatial index of the route lanelets
+   * @details update() calls this automatically when input.route_lanelets has changed
+   */
+  void setRouteLanelets(const lanelet::ConstLanelets & route_lanelets);
+
 private:
   Param param_;
   std::shared_ptr<vehicle_info_util::VehicleInfo> vehicle_info_ptr_;
 
+  // route lanelets cache, rebuilt only when the route lanelets change
+  using LaneletBox = std::pair<Box2d, size_t>;
+  lanelet::ConstLanelets route_lanelets_;
+  std::vector<lanelet::BasicPolygon2d> route_lanelet_polygons_;
+  boost::geometry::index::rtree<LaneletBox, boost::geometry::index::rstar<16>> route_lanelet_rtree_;
+
+  // out-of-lane result of the previous cycle, reused while the footprints are unchanged
+  std::vector<LinearRing2d> prev_vehicle_footprints_;
+  std::vector<bool> prev_out_of_lane_flags_;
+
+  bool isSameRouteLanelets(const lanelet::ConstLanelets & route_lanelets) const;
+
+  lanelet::ConstLanelets getRouteCandidateLanelets(
+    const std::vector<LinearRing2d> & vehicle_footprints) const;
+
+  bool isOutOfRouteLanelets(const LinearRing2d & vehicle_footprint) const;
+
+  //! Evaluate the footprints in order until the first one out of lane is found
+  std::vector<bool> calcOutOfLaneFlags(
+    const std::vector<LinearRing2d> & vehicle_footprints, const bool is_route_updated);
+
   static PoseDeviation calcTrajectoryDeviation(
     const Trajectory & trajectory, const geometry_msgs::msg::Pose & pose,
     const double dist_threshold, const double yaw_threshold);
@@ -28,8 +28,10 @@
 #include <tf2/utils.h>
 
 #include <algorithm>
+#include <iterator>
 #include <vector>
 
+using tier4_autoware_utils::Box2d;
 using tier4_autoware_utils::LinearRing2d;
 using tier4_autoware_utils::MultiPoint2d;
 using tier4_autoware_utils::Point2d;
@@ -89,6 +91,27 @@ lanelet::ConstLanelets getCandidateLanelets(
 
   return candidate_lanelets;
 }
+
+Box2d calcEnvelope(const lanelet::BasicPolygon2d & polygon)
+{
+  Box2d box;
+  boost::geometry::assign_inverse(box);
+  for (const auto & p : polygon) {
+    boost::geometry::expand(box, Point2d(p.x(), p.y()));
+  }
+  return box;
+}
+
+bool isSameFootprint(const LinearRing2d & footprint1, const LinearRing2d & footprint2)
+{
+  if (footprint1.size() != footprint2.size()) {
+    return false;
+  }
+
+  return std::equal(
+    footprint1.begin(), footprint1.end(), footprint2.begin(),
+    [](const Point2d & p1, const Point2d & p2) { return p1.x() == p2.x() && p1.y() == p2.y(); });
+}
 }  // namespace
 
 namespace lane_departure_checker
@@ -99,6 +122,12 @@ Output LaneDepartureChecker::update(const Input & input)
 
   tier4_autoware_utils::StopWatch<std::chrono::milliseconds> stop_watch;
 
+  const bool is_route_updated = !isSameRouteLanelets(input.route_lanelets);
+  if (is_route_updated) {
+    setRouteLanelets(input.route_lanelets);
+  }
+  output.processing_time_map["setRouteLanelets"] = stop_watch.toc(true);
+
   output.trajectory_deviation = calcTrajectoryDeviation(
     *input.reference_trajectory, input.current_pose->pose, param_.ego_nearest_dist_threshold,
     param_.ego_nearest_yaw_threshold);
@@ -123,13 +152,17 @@ Output LaneDepartureChecker::update(const Input & input)
   output.vehicle_passing_areas = createVehiclePassingAreas(output.vehicle_footprints);
   output.processing_time_map["createVehiclePassingAreas"] = stop_watch.toc(true);
 
-  output.candidate_lanelets = getCandidateLanelets(input.route_lanelets, output.vehicle_footprints);
+  output.candidate_lanelets = getRouteCandidateLanelets(output.vehicle_footprints);
   output.processing_time_map["getCandidateLanelets"] = stop_watch.toc(true);
 
-  output.will_leave_lane = willLeaveLane(output.candidate_lanelets, output.vehicle_footprints);
+  // A footprint point inside a route lanelet is always inside a candidate lanelet, so the route
+  // lanelet index gives the same result as checking against candidate_lanelets.
+  const auto out_of_lane_flags = calcOutOfLaneFlags(output.vehicle_footprints, is_route_updated);
+  output.will_leave_lane =
+    std::find(out_of_lane_flags.begin(), out_of_lane_flags.end(), true) != out_of_lane_flags.end();
   output.processing_time_map["willLeaveLane"] = stop_watch.toc(true);
 
-  output.is_out_of_lane = isOutOfLane(output.candidate_lanelets, output.vehicle_footprints.front());
+  output.is_out_of_lane = out_of_lane_flags.front();
   output.processing_time_map["isOutOfLane"] = stop_watch.toc(true);
 
   return output;
@@ -143,6 +176,114 @@ bool LaneDepartureChecker::checkPathWillLeaveLane(
   return willLeaveLane(candidate_lanelets, vehicle_footprints);
 }
 
+void LaneDepartureChecker::setRouteLanelets(const lanelet::ConstLanelets & route_lanelets)
+{
+  route_lanelets_ = route_lanelets;
+
+  route_lanelet_polygons_.clear();
+  route_lanelet_polygons_.reserve(route_lanelets.size());
+  std::vector<LaneletBox> boxes;
+  boxes.reserve(route_lanelets.size());
+  for (size_t i = 0; i < route_lanelets.size(); ++i) {
+    route_lanelet_polygons_.push_back(route_lanelets.at(i).polygon2d().basicPolygon());
+    boxes.emplace_back(calcEnvelope(route_lanelet_polygons_.back()), i);
+  }
+  // packing constructor
+  route_lanelet_rtree_ = decltype(route_lanelet_rtree_)(boxes.begin(), boxes.end());
+
+  prev_vehicle_footprints_.clear();
+  prev_out_of_lane_flags_.clear();
+}
+
+bool LaneDepartureChecker::isSameRouteLanelets(const lanelet::ConstLanelets & route_lanelets) const
+{
+  if (route_lanelets.size() != route_lanelets_.size()) {
+    return false;
+  }
+
+  return std::equal(
+    route_lanelets.begin(), route_lanelets.end(), route_lanelets_.begin(),
+    [](const lanelet::ConstLanelet & ll1, const lanelet::ConstLanelet & ll2) {
+      return ll1.id() == ll2.id();
+    });
+}
+
+lanelet::ConstLanelets LaneDepartureChecker::getRouteCandidateLanelets(
+  const std::vector<LinearRing2d> & vehicle_footprints) const
+{
+  const auto footprint_hull = createHullFromFootprints(vehicle_footprints);
+
+  Box2d hull_box;
+  boost::geometry::envelope(footprint_hull, hull_box);
+  std::vector<LaneletBox> hits;
+  route_lanelet_rtree_.query(
+    boost::geometry::index::intersects(hull_box), std::back_inserter(hits));
+
+  // keep the order of the route lanelets
+  std::sort(hits.begin(), hits.end(), [](const LaneletBox & a, const LaneletBox & b) {
+    return a.second < b.second;
+  });
+
+  lanelet::ConstLanelets candidate_lanelets;
+  for (const auto & hit : hits) {
+    if (!boost::geometry::disjoint(route_lanelet_polygons_.at(hit.second), footprint_hull)) {
+      candidate_lanelets.push_back(route_lanelets_.at(hit.second));
+    }
+  }
+
+  return candidate_lanelets;
+}
+
+bool LaneDepartureChecker::isOutOfRouteLanelets(const LinearRing2d & vehicle_footprint) const
+{
+  // Query the lanelets once per footprint and test all of its points against them
+  Box2d footprint_box;
+  boost::geometry::envelope(vehicle_footprint, footprint_box);
+  std::vector<LaneletBox> hits;
+  route_lanelet_rtree_.query(
+    boost::geometry::index::intersects(footprint_box), std::back_inserter(hits));
+
+  for (const auto & point : vehicle_footprint) {
+    const auto is_in_any_lane = std::any_of(hits.begin(), hits.end(), [&](const LaneletBox & hit) {
+      return boost::geometry::within(point, route_lanelet_polygons_.at(hit.second));
+    });
+    if (!is_in_any_lane) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::vector<bool> LaneDepartureChecker::calcOutOfLaneFlags(
+  const std::vector<LinearRing2d> & vehicle_footprints, const bool is_route_updated)
+{
+  std::vector<bool> out_of_lane_flags;
+  out_of_lane_flags.reserve(vehicle_footprints.size());
+
+  // Reuse the previous result as long as the footprints are identical from the beginning, e.g.
+  // while the vehicle is stopped
+  bool can_reuse = !is_route_updated;
+  for (size_t i = 0; i < vehicle_footprints.size(); ++i) {
+    const auto & vehicle_footprint = vehicle_footprints.at(i);
+    can_reuse = can_reuse && i < prev_out_of_lane_flags_.size() &&
+                isSameFootprint(vehicle_footprint, prev_vehicle_footprints_.at(i));
+
+    const bool is_out_of_lane =
+      can_reuse ? prev_out_of_lane_flags_.at(i) : isOutOfRouteLanelets(vehicle_footprint);
+    out_of_lane_flags.push_back(is_out_of_lane);
+    if (is_out_of_lane) {
+      break;
+    }
+  }
+
+  prev_vehicle_footprints_.assign(
+    vehicle_footprints.begin(), vehicle_footprints.begin() + out_of_lane_flags.size());
+  prev_out_of_lane_flags_ = out_of_lane_flags;
+
+  return out_of_lane_flags;
+}
+
 PoseDeviation LaneDepartureChecker::calcTrajectoryDeviation(
   const Trajectory & trajectory, const geometry_msgs::msg::Pose & pose, const double dist_threshold,
   const double yaw_threshold)
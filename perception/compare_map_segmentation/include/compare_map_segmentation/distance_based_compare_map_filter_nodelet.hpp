@@ -15,11 +15,13 @@
 #ifndef COMPARE_MAP_SEGMENTATION__DISTANCE_BASED_COMPARE_MAP_FILTER_NODELET_HPP_
 #define COMPARE_MAP_SEGMENTATION__DISTANCE_BASED_COMPARE_MAP_FILTER_NODELET_HPP_
 
+#include "compare_map_segmentation/map_tile_loader.hpp"
 #include "pointcloud_preprocessor/filter.hpp"
 
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/search/pcl_search.h>
 
+#include <memory>
 #include <vector>
 
 namespace compare_map_segmentation
@@ -31,6 +33,7 @@ protected:
     const PointCloud2ConstPtr & input, const IndicesPtr & indices, PointCloud2 & output);
 
   void input_target_callback(const PointCloud2ConstPtr map);
+  void set_map(const PointCloudConstPtr & map);
 
 private:
   rclcpp::Subscription<PointCloud2>::SharedPtr sub_map_;
@@ -44,6 +47,9 @@ private:
   /** \brief Parameter service callback */
   rcl_interfaces::msg::SetParametersResult paramCallback(const std::vector<rclcpp::Parameter> & p);
 
+  // declared last so that its thread calling set_map() stops first
+  std::unique_ptr<MapTileLoader> map_loader_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
   explicit DistanceBasedCompareMapFilterComponent(const rclcpp::NodeOptions & options);
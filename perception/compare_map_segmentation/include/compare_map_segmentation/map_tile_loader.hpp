@@ -0,0 +1,97 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMPARE_MAP_SEGMENTATION__MAP_TILE_LOADER_HPP_
+#define COMPARE_MAP_SEGMENTATION__MAP_TILE_LOADER_HPP_
+
+#include <boost/optional.hpp>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <tf2_ros/buffer.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace compare_map_segmentation
+{
+/** \brief Rolling window over a pointcloud map split into square tiles on the xy plane.
+ *
+ * Only the tiles within load_radius from the latest position are handed to the filter, so the
+ * search structures built by the filter are bounded by the window size instead of the map size.
+ * The window is assembled on a background thread whenever the set of tiles around the position
+ * changes, and the callback is called from that thread. The callback is expected to build the
+ * search structures without holding the filter lock and swap them in at the end.
+ */
+class MapTileLoader
+{
+public:
+  using PointCloud = pcl::PointCloud<pcl::PointXYZ>;
+  using OnMapUpdated = std::function<void(const PointCloud::ConstPtr &)>;
+
+  MapTileLoader(const double tile_size, const double load_radius, OnMapUpdated on_map_updated);
+  ~MapTileLoader();
+
+  MapTileLoader(const MapTileLoader &) = delete;
+  MapTileLoader & operator=(const MapTileLoader &) = delete;
+
+  /** \brief Split the whole map into tiles. The window around the latest position is reloaded. */
+  void setMap(const PointCloud & map);
+
+  /** \brief Request the tiles around (x, y). This does not block the caller. */
+  void updatePosition(const double x, const double y);
+
+  /** \brief Request the current window again, e.g. when the filter parameters have changed. */
+  void requestReload();
+
+private:
+  using Tiles = std::unordered_map<uint64_t, PointCloud::Ptr>;
+
+  std::vector<uint64_t> getTileKeysAround(const double x, const double y) const;
+  uint64_t toTileKey(const int32_t ix, const int32_t iy) const;
+  int32_t toTileIndex(const double v) const;
+
+  void run();
+
+  const double tile_size_;
+  const double load_radius_;
+  OnMapUpdated on_map_updated_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::shared_ptr<const Tiles> tiles_;
+  pcl::PCLHeader map_header_;
+  boost::optional<std::pair<double, double>> position_;
+  std::vector<uint64_t> requested_tile_keys_;
+  bool has_request_{false};
+  bool is_shutdown_{false};
+
+  // must be the last member to be started after the others are initialized
+  std::thread worker_;
+};
+
+/** \brief Look up the latest position of base_link in the map frame. */
+boost::optional<std::pair<double, double>> lookupEgoPosition(
+  const tf2_ros::Buffer & tf_buffer, const std::string & map_frame);
+}  // namespace compare_map_segmentation
+
+#endif  // COMPARE_MAP_SEGMENTATION__MAP_TILE_LOADER_HPP_
@@ -15,11 +15,13 @@
 #ifndef COMPARE_MAP_SEGMENTATION__VOXEL_DISTANCE_BASED_COMPARE_MAP_FILTER_NODELET_HPP_  // NOLINT
 #define COMPARE_MAP_SEGMENTATION__VOXEL_DISTANCE_BASED_COMPARE_MAP_FILTER_NODELET_HPP_  // NOLINT
 
+#include "compare_map_segmentation/map_tile_loader.hpp"
 #include "pointcloud_preprocessor/filter.hpp"
 
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/search/pcl_search.h>
 
+#include <memory>
 #include <vector>
 
 namespace compare_map_segmentation
@@ -31,6 +33,7 @@ protected:
     const PointCloud2ConstPtr & input, const IndicesPtr & indices, PointCloud2 & output);
 
   void input_target_callback(const PointCloud2ConstPtr map);
+  void set_map(const PointCloudConstPtr & map);
 
 private:
   // pcl::SegmentDifferences<pcl::PointXYZ> impl_;
@@ -39,8 +42,7 @@ private:
   PointCloudConstPtr map_ptr_;
   double distance_threshold_;
   pcl::search::Search<pcl::PointXYZ>::Ptr tree_;
-  pcl::VoxelGrid<pcl::PointXYZ> voxel_grid_;
-  bool set_map_in_voxel_grid_;
+  pcl::VoxelGrid<pcl::PointXYZ>::Ptr voxel_grid_;
 
   /** \brief Parameter service callback result : needed to be hold */
   OnSetParametersCallbackHandle::SharedPtr set_param_res_;
@@ -48,6 +50,9 @@ private:
   /** \brief Parameter service callback */
   rcl_interfaces::msg::SetParametersResult paramCallback(const std::vector<rclcpp::Parameter> & p);
 
+  // declared last so that its thread calling set_map() stops first
+  std::unique_ptr<MapTileLoader> map_loader_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
   explicit VoxelDistanceBasedCompareMapFilterComponent(const rclcpp::NodeOptions & options);
@@ -0,0 +1,96 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMPARE_MAP_SEGMENTATION__VOXEL_GRID_MAP_INDEX_HPP_
+#define COMPARE_MAP_SEGMENTATION__VOXEL_GRID_MAP_INDEX_HPP_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace compare_map_segmentation
+{
+/** \brief Sparse voxel hash of the map voxel centroids.
+ *
+ * The map is voxelized with the leaf size given to build(), the same way as pcl::VoxelGrid does,
+ * but only the occupied voxels are stored instead of a leaf layout covering the whole map bounds.
+ * Every voxel within one voxel of an occupied one is also stored with a bitmask of its occupied
+ * neighbors, i.e. the occupancy dilated by the leaf size. A single probe therefore tells whether
+ * any map centroid can be within the leaf size from a point, and only the occupied neighbors are
+ * visited for the exact distance check.
+ */
+class VoxelGridMapIndex
+{
+public:
+  void build(const pcl::PointCloud<pcl::PointXYZ> & map, const double leaf_size);
+  void clear();
+
+  bool empty() const { return cells_.empty(); }
+  double getLeafSize() const { return leaf_size_; }
+
+  /** \brief Return true if the centroid of the voxel containing (x, y, z) or of one of its 26
+   * neighbors is closer than the leaf size to (x, y, z).
+   */
+  bool isNearMap(const float x, const float y, const float z) const
+  {
+    const int32_t i = toGrid(x);
+    const int32_t j = toGrid(y);
+    const int32_t k = toGrid(z);
+    const auto itr = cells_.find(toKey(i, j, k));
+    if (itr == cells_.end()) {
+      return false;
+    }
+    return isNearCentroid(itr->second, i, j, k, x, y, z);
+  }
+
+private:
+  struct Cell
+  {
+    float x{0.0f};
+    float y{0.0f};
+    float z{0.0f};
+    // bit (dx + 1) * 9 + (dy + 1) * 3 + (dz + 1) is set if the neighbor at (dx, dy, dz) is occupied
+    uint32_t neighbor_mask{0U};
+  };
+
+  static constexpr int center_bit = 13;
+
+  int32_t toGrid(const float v) const
+  {
+    return static_cast<int32_t>(std::floor(v * inverse_leaf_size_));
+  }
+
+  static uint64_t toKey(const int32_t i, const int32_t j, const int32_t k)
+  {
+    // 21 bits for each axis is enough for any map in the range of a 32 bit float grid index
+    constexpr uint64_t mask = (1ULL << 21) - 1;
+    return ((static_cast<uint64_t>(i) & mask) << 42) | ((static_cast<uint64_t>(j) & mask) << 21) |
+           (static_cast<uint64_t>(k) & mask);
+  }
+
+  bool isNearCentroid(
+    const Cell & cell, const int32_t i, const int32_t j, const int32_t k, const float x,
+    const float y, const float z) const;
+
+  double leaf_size_{0.0};
+  float inverse_leaf_size_{0.0f};
+  float sqr_leaf_size_{0.0f};
+  std::unordered_map<uint64_t, Cell> cells_;
+};
+}  // namespace compare_map_segmentation
+
+#endif  // COMPARE_MAP_SEGMENTATION__VOXEL_GRID_MAP_INDEX_HPP_
@@ -30,6 +30,13 @@ DistanceBasedCompareMapFilterComponent::DistanceBasedCompareMapFilterComponent(
 {
   distance_threshold_ = static_cast<double>(declare_parameter("distance_threshold", 0.3));
 
+  if (static_cast<bool>(declare_parameter("use_rolling_map", false))) {
+    map_loader_ = std::make_unique<MapTileLoader>(
+      static_cast<double>(declare_parameter("map_tile_size", 50.0)),
+      static_cast<double>(declare_parameter("map_load_radius", 150.0)),
+      [this](const PointCloudConstPtr & map) { set_map(map); });
+  }
+
   using std::placeholders::_1;
   sub_map_ = this->create_subscription<PointCloud2>(
     "map", rclcpp::QoS{1}.transient_local(),
@@ -43,6 +50,13 @@ void DistanceBasedCompareMapFilterComponent::filter(
   const PointCloud2ConstPtr & input, [[maybe_unused]] const IndicesPtr & indices,
   PointCloud2 & output)
 {
+  if (map_loader_) {
+    const auto ego_position = lookupEgoPosition(*tf_buffer_, input->header.frame_id);
+    if (ego_position) {
+      map_loader_->updatePosition(ego_position->first, ego_position->second);
+    }
+  }
+
   std::scoped_lock lock(mutex_);
   if (map_ptr_ == NULL || tree_ == NULL) {
     output = *input;
@@ -63,19 +77,35 @@ void DistanceBasedCompareMapFilterComponent::input_target_callback(const PointCl
 {
   pcl::PointCloud<pcl::PointXYZ> map_pcl;
   pcl::fromROSMsg<pcl::PointXYZ>(*map, map_pcl);
-  const auto map_pcl_ptr = pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl);
+  {
+    std::scoped_lock lock(mutex_);
+    tf_input_frame_ = map_pcl.header.frame_id;
+  }
 
-  std::scoped_lock lock(mutex_);
-  map_ptr_ = map_pcl_ptr;
-  tf_input_frame_ = map_ptr_->header.frame_id;
-  if (!tree_) {
-    if (map_ptr_->isOrganized()) {
-      tree_.reset(new pcl::search::OrganizedNeighbor<pcl::PointXYZ>());
+  if (map_loader_) {
+    // the window around ego is passed to set_map() from the loader thread
+    map_loader_->setMap(map_pcl);
+    return;
+  }
+  set_map(pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl));
+}
+
+void DistanceBasedCompareMapFilterComponent::set_map(const PointCloudConstPtr & map)
+{
+  // build the search tree without the lock so that filter() is not blocked
+  pcl::search::Search<pcl::PointXYZ>::Ptr tree;
+  if (!map->points.empty()) {
+    if (map->isOrganized()) {
+      tree.reset(new pcl::search::OrganizedNeighbor<pcl::PointXYZ>());
     } else {
-      tree_.reset(new pcl::search::KdTree<pcl::PointXYZ>(false));
+      tree.reset(new pcl::search::KdTree<pcl::PointXYZ>(false));
     }
+    tree->setInputCloud(map);
   }
-  tree_->setInputCloud(map_ptr_);
+
+  std::scoped_lock lock(mutex_);
+  map_ptr_ = map;
+  tree_ = tree;
 }
 
 rcl_interfaces::msg::SetParametersResult DistanceBasedCompareMapFilterComponent::paramCallback(
@@ -0,0 +1,183 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "compare_map_segmentation/map_tile_loader.hpp"
+
+#include <tf2/exceptions.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace compare_map_segmentation
+{
+MapTileLoader::MapTileLoader(
+  const double tile_size, const double load_radius, OnMapUpdated on_map_updated)
+: tile_size_(tile_size),
+  load_radius_(load_radius),
+  on_map_updated_(std::move(on_map_updated)),
+  worker_(&MapTileLoader::run, this)
+{
+}
+
+MapTileLoader::~MapTileLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_shutdown_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void MapTileLoader::setMap(const PointCloud & map)
+{
+  auto tiles = std::make_shared<Tiles>();
+  for (const auto & p : map.points) {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    auto & tile = (*tiles)[toTileKey(toTileIndex(p.x), toTileIndex(p.y))];
+    if (!tile) {
+      tile.reset(new PointCloud);
+    }
+    tile->points.push_back(p);
+  }
+  for (auto & tile : *tiles) {
+    tile.second->width = static_cast<uint32_t>(tile.second->points.size());
+    tile.second->height = 1;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tiles_ = tiles;
+    map_header_ = map.header;
+    if (position_) {
+      requested_tile_keys_ = getTileKeysAround(position_->first, position_->second);
+      has_request_ = true;
+    } else {
+      requested_tile_keys_.clear();
+    }
+  }
+  cv_.notify_one();
+}
+
+void MapTileLoader::updatePosition(const double x, const double y)
+{
+  const auto tile_keys = getTileKeysAround(x, y);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    position_ = std::make_pair(x, y);
+    if (!tiles_ || tile_keys == requested_tile_keys_) {
+      return;
+    }
+    requested_tile_keys_ = tile_keys;
+    has_request_ = true;
+  }
+  cv_.notify_one();
+}
+
+void MapTileLoader::requestReload()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!tiles_ || !position_) {
+      return;
+    }
+    has_request_ = true;
+  }
+  cv_.notify_one();
+}
+
+std::vector<uint64_t> MapTileLoader::getTileKeysAround(const double x, const double y) const
+{
+  // measure from the center of the tile containing (x, y) so that the window changes only when
+  // the position moves to another tile
+  const double center_x = (toTileIndex(x) + 0.5) * tile_size_;
+  const double center_y = (toTileIndex(y) + 0.5) * tile_size_;
+
+  std::vector<uint64_t> tile_keys;
+  const auto min_ix = toTileIndex(center_x - load_radius_);
+  const auto max_ix = toTileIndex(center_x + load_radius_);
+  const auto min_iy = toTileIndex(center_y - load_radius_);
+  const auto max_iy = toTileIndex(center_y + load_radius_);
+  for (int32_t ix = min_ix; ix <= max_ix; ++ix) {
+    for (int32_t iy = min_iy; iy <= max_iy; ++iy) {
+      // distance from the center to the nearest point of the tile
+      const double tile_min_x = ix * tile_size_;
+      const double tile_min_y = iy * tile_size_;
+      const double dx =
+        std::max({tile_min_x - center_x, 0.0, center_x - (tile_min_x + tile_size_)});
+      const double dy =
+        std::max({tile_min_y - center_y, 0.0, center_y - (tile_min_y + tile_size_)});
+      if (dx * dx + dy * dy <= load_radius_ * load_radius_) {
+        tile_keys.push_back(toTileKey(ix, iy));
+      }
+    }
+  }
+  return tile_keys;
+}
+
+uint64_t MapTileLoader::toTileKey(const int32_t ix, const int32_t iy) const
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+}
+
+int32_t MapTileLoader::toTileIndex(const double v) const
+{
+  return static_cast<int32_t>(std::floor(v / tile_size_));
+}
+
+void MapTileLoader::run()
+{
+  while (true) {
+    std::shared_ptr<const Tiles> tiles;
+    std::vector<uint64_t> tile_keys;
+    pcl::PCLHeader header;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return has_request_ || is_shutdown_; });
+      if (is_shutdown_) {
+        return;
+      }
+      tiles = tiles_;
+      tile_keys = requested_tile_keys_;
+      header = map_header_;
+      has_request_ = false;
+    }
+
+    PointCloud::Ptr window(new PointCloud);
+    window->header = header;
+    for (const auto & key : tile_keys) {
+      const auto itr = tiles->find(key);
+      if (itr != tiles->end()) {
+        *window += *itr->second;
+      }
+    }
+
+    // the filter swaps in its search structures in this callback
+    on_map_updated_(window);
+  }
+}
+
+boost::optional<std::pair<double, double>> lookupEgoPosition(
+  const tf2_ros::Buffer & tf_buffer, const std::string & map_frame)
+{
+  try {
+    const auto transform = tf_buffer.lookupTransform(map_frame, "base_link", tf2::TimePointZero);
+    return std::make_pair(transform.transform.translation.x, transform.transform.translation.y);
+  } catch (const tf2::TransformException &) {
+    return boost::none;
+  }
+}
+}  // namespace compare_map_segmentation
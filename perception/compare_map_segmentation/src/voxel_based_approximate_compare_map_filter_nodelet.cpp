@@ -41,7 +41,12 @@ VoxelBasedApproximateCompareMapFilterComponent::VoxelBasedApproximateCompareMapF
 
   distance_threshold_ = static_cast<double>(declare_parameter("distance_threshold", 0.3));
 
-  set_map_in_voxel_grid_ = false;
+  if (static_cast<bool>(declare_parameter("use_rolling_map", false))) {
+    map_loader_ = std::make_unique<MapTileLoader>(
+      static_cast<double>(declare_parameter("map_tile_size", 50.0)),
+      static_cast<double>(declare_parameter("map_load_radius", 150.0)),
+      [this](const PointCloudConstPtr & map) { set_map(map); });
+  }
 
   using std::placeholders::_1;
   sub_map_ = this->create_subscription<PointCloud2>(
@@ -56,6 +61,13 @@ void VoxelBasedApproximateCompareMapFilterComponent::filter(
   const PointCloud2ConstPtr & input, [[maybe_unused]] const IndicesPtr & indices,
   PointCloud2 & output)
 {
+  if (map_loader_) {
+    const auto ego_position = lookupEgoPosition(*tf_buffer_, input->header.frame_id);
+    if (ego_position) {
+      map_loader_->updatePosition(ego_position->first, ego_position->second);
+    }
+  }
+
   std::scoped_lock lock(mutex_);
   if (voxel_map_ptr_ == NULL) {
     output = *input;
@@ -66,7 +78,7 @@ void VoxelBasedApproximateCompareMapFilterComponent::filter(
   pcl::fromROSMsg(*input, *pcl_input);
   pcl_output->points.reserve(pcl_input->points.size());
   for (size_t i = 0; i < pcl_input->points.size(); ++i) {
-    const int index = voxel_grid_.getCentroidIndexAt(voxel_grid_.getGridCoordinates(
+    const int index = voxel_grid_->getCentroidIndexAt(voxel_grid_->getGridCoordinates(
       pcl_input->points.at(i).x, pcl_input->points.at(i).y, pcl_input->points.at(i).z));
     if (index == -1) {  // empty voxel
       // map_ptr_->points.at(index)
@@ -84,16 +96,17 @@ void VoxelBasedApproximateCompareMapFilterComponent::input_target_callback(
   stop_watch_ptr_->toc("processing_time", true);
   pcl::PointCloud<pcl::PointXYZ> map_pcl;
   pcl::fromROSMsg<pcl::PointXYZ>(*map, map_pcl);
-  const auto map_pcl_ptr = pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl);
+  {
+    std::scoped_lock lock(mutex_);
+    tf_input_frame_ = map_pcl.header.frame_id;
+  }
 
-  std::scoped_lock lock(mutex_);
-  set_map_in_voxel_grid_ = true;
-  tf_input_frame_ = map_pcl_ptr->header.frame_id;
-  voxel_map_ptr_.reset(new pcl::PointCloud<pcl::PointXYZ>);
-  voxel_grid_.setLeafSize(distance_threshold_, distance_threshold_, distance_threshold_);
-  voxel_grid_.setInputCloud(map_pcl_ptr);
-  voxel_grid_.setSaveLeafLayout(true);
-  voxel_grid_.filter(*voxel_map_ptr_);
+  if (map_loader_) {
+    // the window around ego is passed to set_map() from the loader thread
+    map_loader_->setMap(map_pcl);
+  } else {
+    set_map(pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl));
+  }
   // add processing time for debug
   if (debug_publisher_) {
     const double cyclic_time_ms = stop_watch_ptr_->toc("cyclic_time", true);
@@ -105,19 +118,59 @@ void VoxelBasedApproximateCompareMapFilterComponent::input_target_callback(
   }
 }
 
+void VoxelBasedApproximateCompareMapFilterComponent::set_map(const PointCloudConstPtr & map)
+{
+  if (map->points.empty()) {
+    // e.g. no map tile around ego, pass the input through
+    std::scoped_lock lock(mutex_);
+    map_ptr_ = map;
+    voxel_grid_.reset();
+    voxel_map_ptr_.reset();
+    return;
+  }
+
+  double leaf_size;
+  {
+    std::scoped_lock lock(mutex_);
+    leaf_size = distance_threshold_;
+  }
+
+  // build the voxel grid without the lock so that filter() is not blocked
+  pcl::VoxelGrid<pcl::PointXYZ>::Ptr voxel_grid(new pcl::VoxelGrid<pcl::PointXYZ>);
+  PointCloudPtr voxel_map_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+  voxel_grid->setLeafSize(leaf_size, leaf_size, leaf_size);
+  voxel_grid->setInputCloud(map);
+  voxel_grid->setSaveLeafLayout(true);
+  voxel_grid->filter(*voxel_map_ptr);
+
+  std::scoped_lock lock(mutex_);
+  map_ptr_ = map;
+  voxel_grid_ = voxel_grid;
+  voxel_map_ptr_ = voxel_map_ptr;
+}
+
 rcl_interfaces::msg::SetParametersResult
 VoxelBasedApproximateCompareMapFilterComponent::paramCallback(
   const std::vector<rclcpp::Parameter> & p)
 {
-  std::scoped_lock lock(mutex_);
+  PointCloudConstPtr map;
+  bool is_threshold_updated = false;
+  {
+    std::scoped_lock lock(mutex_);
+    if (get_param(p, "distance_threshold", distance_threshold_)) {
+      map = map_ptr_;
+      is_threshold_updated = true;
+      RCLCPP_DEBUG(get_logger(), "Setting new distance threshold to: %f.", distance_threshold_);
+    }
+  }
 
-  if (get_param(p, "distance_threshold", distance_threshold_)) {
-    voxel_grid_.setLeafSize(distance_threshold_, distance_threshold_, distance_threshold_);
-    voxel_grid_.setSaveLeafLayout(true);
-    if (set_map_in_voxel_grid_) {
-      voxel_grid_.filter(*voxel_map_ptr_);
+  // rebuild the voxel grid with the new leaf size
+  if (is_threshold_updated) {
+    if (map_loader_) {
+      map_loader_->requestReload();
+    } else if (map) {
+      set_map(map);
     }
-    RCLCPP_DEBUG(get_logger(), "Setting new distance threshold to: %f.", distance_threshold_);
   }
 
   rcl_interfaces::msg::SetParametersResult result;
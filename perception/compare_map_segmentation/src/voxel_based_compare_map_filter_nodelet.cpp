@@ -14,12 +14,32 @@
 
 #include "compare_map_segmentation/voxel_based_compare_map_filter_nodelet.hpp"
 
+#include <boost/optional.hpp>
+
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/search/kdtree.h>
 #include <pcl/segmentation/segment_differences.h>
 
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
+namespace
+{
+boost::optional<uint32_t> getFieldOffset(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & field_name)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == field_name) {
+      return field.offset;
+    }
+  }
+  return boost::none;
+}
+}  // namespace
+
 namespace compare_map_segmentation
 {
 using pointcloud_preprocessor::get_param;
@@ -40,7 +60,12 @@ VoxelBasedCompareMapFilterComponent::VoxelBasedCompareMapFilterComponent(
 
   distance_threshold_ = static_cast<double>(declare_parameter("distance_threshold", 0.3));
 
-  set_map_in_voxel_grid_ = false;
+  if (static_cast<bool>(declare_parameter("use_rolling_map", false))) {
+    map_loader_ = std::make_unique<MapTileLoader>(
+      static_cast<double>(declare_parameter("map_tile_size", 50.0)),
+      static_cast<double>(declare_parameter("map_load_radius", 150.0)),
+      [this](const PointCloudConstPtr & map) { set_map(map); });
+  }
 
   using std::placeholders::_1;
   sub_map_ = this->create_subscription<PointCloud2>(
@@ -55,211 +80,76 @@ void VoxelBasedCompareMapFilterComponent::filter(
   const PointCloud2ConstPtr & input, [[maybe_unused]] const IndicesPtr & indices,
   PointCloud2 & output)
 {
+  if (map_loader_) {
+    const auto ego_position = lookupEgoPosition(*tf_buffer_, input->header.frame_id);
+    if (ego_position) {
+      map_loader_->updatePosition(ego_position->first, ego_position->second);
+    }
+  }
+
   std::scoped_lock lock(mutex_);
-  if (voxel_map_ptr_ == NULL) {
+  if (map_ptr_ == NULL) {
     output = *input;
     return;
   }
-  pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_input(new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_output(new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::fromROSMsg(*input, *pcl_input);
-  pcl_output->points.reserve(pcl_input->points.size());
-  for (size_t i = 0; i < pcl_input->points.size(); ++i) {
-    const pcl::PointXYZ point = pcl_input->points.at(i);
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y, point.z), point, distance_threshold_, voxel_map_ptr_,
-          voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y - distance_threshold_, point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y - distance_threshold_, point.z), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y - distance_threshold_, point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y, point.z - distance_threshold_), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y, point.z + distance_threshold_), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y + distance_threshold_, point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y + distance_threshold_, point.z), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x, point.y + distance_threshold_, point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
 
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x - distance_threshold_, point.y - distance_threshold_,
-            point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x - distance_threshold_, point.y - distance_threshold_, point.z),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x - distance_threshold_, point.y - distance_threshold_,
-            point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x - distance_threshold_, point.y, point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x - distance_threshold_, point.y, point.z), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x - distance_threshold_, point.y, point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x - distance_threshold_, point.y + distance_threshold_,
-            point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x - distance_threshold_, point.y + distance_threshold_, point.z),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x - distance_threshold_, point.y + distance_threshold_,
-            point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
+  const auto x_offset = getFieldOffset(*input, "x");
+  const auto y_offset = getFieldOffset(*input, "y");
+  const auto z_offset = getFieldOffset(*input, "z");
+  if (!x_offset || !y_offset || !z_offset) {
+    RCLCPP_ERROR(get_logger(), "Input pointcloud does not have x, y, z fields.");
+    output = *input;
+    return;
+  }
 
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x + distance_threshold_, point.y - distance_threshold_,
-            point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x + distance_threshold_, point.y - distance_threshold_, point.z),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x + distance_threshold_, point.y - distance_threshold_,
-            point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x + distance_threshold_, point.y, point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x + distance_threshold_, point.y, point.z), point,
-          distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x + distance_threshold_, point.y, point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x + distance_threshold_, point.y + distance_threshold_,
-            point.z - distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(point.x + distance_threshold_, point.y + distance_threshold_, point.z),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
-      continue;
-    }
-    if (is_in_voxel(
-          pcl::PointXYZ(
-            point.x + distance_threshold_, point.y + distance_threshold_,
-            point.z + distance_threshold_),
-          point, distance_threshold_, voxel_map_ptr_, voxel_grid_)) {
+  // read the coordinates directly from the message and probe the map index in parallel
+  const auto num_points = static_cast<int64_t>(input->width) * input->height;
+  std::vector<uint8_t> is_on_map(num_points, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < num_points; ++i) {
+    const uint8_t * point_data = &input->data[i * input->point_step];
+    float x, y, z;
+    std::memcpy(&x, point_data + *x_offset, sizeof(float));
+    std::memcpy(&y, point_data + *y_offset, sizeof(float));
+    std::memcpy(&z, point_data + *z_offset, sizeof(float));
+    is_on_map[i] = map_index_.isNearMap(x, y, z);
+  }
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_output(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl_output->points.reserve(num_points);
+  for (int64_t i = 0; i < num_points; ++i) {
+    if (is_on_map[i]) {
       continue;
     }
-
-    pcl_output->points.push_back(pcl_input->points.at(i));
+    const uint8_t * point_data = &input->data[i * input->point_step];
+    pcl::PointXYZ point;
+    std::memcpy(&point.x, point_data + *x_offset, sizeof(float));
+    std::memcpy(&point.y, point_data + *y_offset, sizeof(float));
+    std::memcpy(&point.z, point_data + *z_offset, sizeof(float));
+    pcl_output->points.push_back(point);
   }
   pcl::toROSMsg(*pcl_output, output);
   output.header = input->header;
 }
 
-bool VoxelBasedCompareMapFilterComponent::is_in_voxel(
-  const pcl::PointXYZ & src_point, const pcl::PointXYZ & target_point,
-  const double distance_threshold, const PointCloudPtr & map,
-  pcl::VoxelGrid<pcl::PointXYZ> & voxel) const
-{
-  int voxel_index =
-    voxel.getCentroidIndexAt(voxel.getGridCoordinates(src_point.x, src_point.y, src_point.z));
-  if (voxel_index != -1) {  // not empty voxel
-    const double dist_x = map->points.at(voxel_index).x - target_point.x;
-    const double dist_y = map->points.at(voxel_index).y - target_point.y;
-    const double dist_z = map->points.at(voxel_index).z - target_point.z;
-    const double sqr_distance = dist_x * dist_x + dist_y * dist_y + dist_z * dist_z;
-    if (sqr_distance < distance_threshold * distance_threshold) {
-      return true;
-    }
-  }
-  return false;
-}
-
 void VoxelBasedCompareMapFilterComponent::input_target_callback(const PointCloud2ConstPtr map)
 {
   stop_watch_ptr_->toc("processing_time", true);
   pcl::PointCloud<pcl::PointXYZ> map_pcl;
   pcl::fromROSMsg<pcl::PointXYZ>(*map, map_pcl);
-  const auto map_pcl_ptr = pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl);
+  {
+    std::scoped_lock lock(mutex_);
+    tf_input_frame_ = map_pcl.header.frame_id;
+  }
 
-  std::scoped_lock lock(mutex_);
-  set_map_in_voxel_grid_ = true;
-  tf_input_frame_ = map_pcl_ptr->header.frame_id;
-  voxel_map_ptr_.reset(new pcl::PointCloud<pcl::PointXYZ>);
-  voxel_grid_.setLeafSize(distance_threshold_, distance_threshold_, distance_threshold_);
-  voxel_grid_.setInputCloud(map_pcl_ptr);
-  voxel_grid_.setSaveLeafLayout(true);
-  voxel_grid_.filter(*voxel_map_ptr_);
+  if (map_loader_) {
+    // the window around ego is passed to set_map() from the loader thread
+    map_loader_->setMap(map_pcl);
+  } else {
+    set_map(pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(map_pcl));
+  }
 
   // add processing time for debug
   if (debug_publisher_) {
@@ -272,18 +162,44 @@ void VoxelBasedCompareMapFilterComponent::input_target_callback(const PointCloud
   }
 }
 
+void VoxelBasedCompareMapFilterComponent::set_map(const PointCloudConstPtr & map)
+{
+  double leaf_size;
+  {
+    std::scoped_lock lock(mutex_);
+    leaf_size = distance_threshold_;
+  }
+
+  // build the index without the lock so that filter() is not blocked
+  VoxelGridMapIndex map_index;
+  map_index.build(*map, leaf_size);
+
+  std::scoped_lock lock(mutex_);
+  map_ptr_ = map;
+  map_index_ = std::move(map_index);
+}
+
 rcl_interfaces::msg::SetParametersResult VoxelBasedCompareMapFilterComponent::paramCallback(
   const std::vector<rclcpp::Parameter> & p)
 {
-  std::scoped_lock lock(mutex_);
+  PointCloudConstPtr map;
+  bool is_threshold_updated = false;
+  {
+    std::scoped_lock lock(mutex_);
+    if (get_param(p, "distance_threshold", distance_threshold_)) {
+      map = map_ptr_;
+      is_threshold_updated = true;
+      RCLCPP_DEBUG(get_logger(), "Setting new distance threshold to: %f.", distance_threshold_);
+    }
+  }
 
-  if (get_param(p, "distance_threshold", distance_threshold_)) {
-    voxel_grid_.setLeafSize(distance_threshold_, distance_threshold_, distance_threshold_);
-    voxel_grid_.setSaveLeafLayout(true);
-    if (set_map_in_voxel_grid_) {
-      voxel_grid_.filter(*voxel_map_ptr_);
+  // rebuild the index with the new leaf size
+  if (is_threshold_updated) {
+    if (map_loader_) {
+      map_loader_->requestReload();
+    } else if (map) {
+      set_map(map);
     }
-    RCLCPP_DEBUG(get_logger(), "Setting new distance threshold to: %f.", distance_threshold_);
   }
 
   rcl_interfaces::msg::SetParametersResult result;
@@ -0,0 +1,127 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "compare_map_segmentation/voxel_grid_map_index.hpp"
+
+#include <cmath>
+
+namespace compare_map_segmentation
+{
+namespace
+{
+struct CentroidAccumulator
+{
+  double x{0.0};
+  double y{0.0};
+  double z{0.0};
+  size_t num_points{0U};
+  int32_t i{0};
+  int32_t j{0};
+  int32_t k{0};
+};
+
+int neighborBit(const int dx, const int dy, const int dz)
+{
+  return (dx + 1) * 9 + (dy + 1) * 3 + (dz + 1);
+}
+}  // namespace
+
+void VoxelGridMapIndex::build(const pcl::PointCloud<pcl::PointXYZ> & map, const double leaf_size)
+{
+  clear();
+  leaf_size_ = leaf_size;
+  inverse_leaf_size_ = static_cast<float>(1.0 / leaf_size);
+  sqr_leaf_size_ = static_cast<float>(leaf_size * leaf_size);
+
+  // voxelize the map and compute the centroid of each occupied voxel
+  std::unordered_map<uint64_t, CentroidAccumulator> accumulators;
+  for (const auto & p : map.points) {
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    const int32_t i = toGrid(p.x);
+    const int32_t j = toGrid(p.y);
+    const int32_t k = toGrid(p.z);
+    auto & accumulator = accumulators[toKey(i, j, k)];
+    accumulator.x += p.x;
+    accumulator.y += p.y;
+    accumulator.z += p.z;
+    accumulator.num_points++;
+    accumulator.i = i;
+    accumulator.j = j;
+    accumulator.k = k;
+  }
+
+  // dilate the occupancy by one voxel
+  cells_.reserve(accumulators.size() * 9);
+  for (const auto & [key, accumulator] : accumulators) {
+    auto & cell = cells_[key];
+    const auto num_points = static_cast<double>(accumulator.num_points);
+    cell.x = static_cast<float>(accumulator.x / num_points);
+    cell.y = static_cast<float>(accumulator.y / num_points);
+    cell.z = static_cast<float>(accumulator.z / num_points);
+
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+          // seen from the neighbor, this voxel is at (-dx, -dy, -dz)
+          const auto neighbor_key =
+            toKey(accumulator.i + dx, accumulator.j + dy, accumulator.k + dz);
+          cells_[neighbor_key].neighbor_mask |= 1U << neighborBit(-dx, -dy, -dz);
+        }
+      }
+    }
+  }
+}
+
+void VoxelGridMapIndex::clear()
+{
+  cells_.clear();
+  leaf_size_ = 0.0;
+  inverse_leaf_size_ = 0.0f;
+  sqr_leaf_size_ = 0.0f;
+}
+
+bool VoxelGridMapIndex::isNearCentroid(
+  const Cell & cell, const int32_t i, const int32_t j, const int32_t k, const float x,
+  const float y, const float z) const
+{
+  const auto is_near = [&](const Cell & c) {
+    const float dist_x = c.x - x;
+    const float dist_y = c.y - y;
+    const float dist_z = c.z - z;
+    return dist_x * dist_x + dist_y * dist_y + dist_z * dist_z < sqr_leaf_size_;
+  };
+
+  // check the voxel containing the point first since it is the most likely one
+  if ((cell.neighbor_mask & (1U << center_bit)) && is_near(cell)) {
+    return true;
+  }
+
+  const uint32_t neighbor_mask = cell.neighbor_mask & ~(1U << center_bit);
+  for (int bit = 0; bit < 27; ++bit) {
+    if (!(neighbor_mask & (1U << bit))) {
+      continue;
+    }
+    const int dx = bit / 9 - 1;
+    const int dy = (bit / 3) % 3 - 1;
+    const int dz = bit % 3 - 1;
+    const auto itr = cells_.find(toKey(i + dx, j + dy, k + dz));
+    if (itr != cells_.end() && is_near(itr->second)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace compare_map_segmentation
@@ -23,15 +23,18 @@
 #include <autoware_auto_mapping_msgs/msg/had_map_bin.hpp>
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
 
+#include <boost/geometry/index/rtree.hpp>
+
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace object_lanelet_filter
 {
-using tier4_autoware_utils::LinearRing2d;
-using tier4_autoware_utils::MultiPoint2d;
+using tier4_autoware_utils::Box2d;
 using tier4_autoware_utils::Point2d;
 using tier4_autoware_utils::Polygon2d;
 
@@ -61,17 +64,18 @@ private:
   rclcpp::Subscription<autoware_auto_perception_msgs::msg::DetectedObjects>::SharedPtr object_sub_;
 
   lanelet::LaneletMapPtr lanelet_map_ptr_;
-  lanelet::ConstLanelets road_lanelets_;
+
+  // road lanelet polygons and their bounding boxes, built once per map
+  using LaneletBox = std::pair<Box2d, size_t>;
+  std::vector<lanelet::BasicPolygon2d> road_lanelet_polygons_;
+  boost::geometry::index::rtree<LaneletBox, boost::geometry::index::rstar<16>> road_lanelet_rtree_;
 
   tf2_ros::Buffer tf_buffer_;
   tf2_ros::TransformListener tf_listener_;
 
   Filter_target_label filter_target_;
 
-  LinearRing2d getConvexHull(const autoware_auto_perception_msgs::msg::DetectedObjects &);
-  lanelet::ConstLanelets getIntersectedLanelets(
-    const LinearRing2d &, const lanelet::ConstLanelets &);
-  bool isPolygonOverlapLanelets(const Polygon2d &, const lanelet::ConstLanelets &);
+  bool isPolygonOverlapLanelets(const Polygon2d &) const;
 };
 
 }  // namespace object_lanelet_filter
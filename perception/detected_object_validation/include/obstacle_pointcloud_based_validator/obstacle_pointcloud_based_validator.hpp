@@ -16,6 +16,7 @@
 #define OBSTACLE_POINTCLOUD_BASED_VALIDATOR__OBSTACLE_POINTCLOUD_BASED_VALIDATOR_HPP_
 
 #include "obstacle_pointcloud_based_validator/debugger.hpp"
+#include "obstacle_pointcloud_based_validator/point_grid.hpp"
 
 #include <rclcpp/rclcpp.hpp>
 
@@ -32,6 +33,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace obstacle_pointcloud_based_validator
 {
@@ -53,6 +55,7 @@ private:
   typedef message_filters::Synchronizer<SyncPolicy> Sync;
   Sync sync_;
   size_t min_pointcloud_num_;
+  PointGrid point_grid_;
 
   std::shared_ptr<Debugger> debugger_;
 
@@ -61,13 +64,12 @@ private:
     const autoware_auto_perception_msgs::msg::DetectedObjects::ConstSharedPtr & input_objects,
     const sensor_msgs::msg::PointCloud2::ConstSharedPtr & input_obstacle_pointcloud);
   std::optional<size_t> getPointCloudNumWithinPolygon(
-    const autoware_auto_perception_msgs::msg::DetectedObject & object,
-    const pcl::PointCloud<pcl::PointXY>::Ptr pointcloud);
+    const pcl::PointCloud<pcl::PointXY> & polygon,
+    const pcl::PointCloud<pcl::PointXY>::Ptr & neighbor_pointcloud,
+    const pcl::PointCloud<pcl::PointXYZ>::Ptr & pointcloud_within_polygon) const;
   void toPolygon2d(
     const autoware_auto_perception_msgs::msg::DetectedObject & object,
-    const pcl::PointCloud<pcl::PointXY>::Ptr & polygon);
-  std::optional<float> getMaxRadius(
-    const autoware_auto_perception_msgs::msg::DetectedObject & object);
+    pcl::PointCloud<pcl::PointXY> & polygon);
 };
 }  // namespace obstacle_pointcloud_based_validator
 
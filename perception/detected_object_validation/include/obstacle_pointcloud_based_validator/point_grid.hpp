@@ -0,0 +1,136 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBSTACLE_POINTCLOUD_BASED_VALIDATOR__POINT_GRID_HPP_
+#define OBSTACLE_POINTCLOUD_BASED_VALIDATOR__POINT_GRID_HPP_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace obstacle_pointcloud_based_validator
+{
+/**
+ * @brief 2D grid of point indices, built with a counting sort in linear time.
+ * The points of a cell are stored contiguously, so a range of cells can be swept without any
+ * tree traversal. The grid is read-only after setInputCloud and can be queried concurrently.
+ */
+class PointGrid
+{
+public:
+  explicit PointGrid(const float cell_size, const size_t max_cell_num = 1 << 22)
+  : cell_size_(cell_size), max_cell_num_(max_cell_num)
+  {
+  }
+
+  void setInputCloud(const pcl::PointCloud<pcl::PointXY>::ConstPtr & cloud)
+  {
+    cloud_ = cloud;
+    if (cloud_->empty()) {
+      width_ = height_ = 0;
+      cell_begin_.assign(1, 0);
+      indices_.clear();
+      return;
+    }
+
+    min_x_ = min_y_ = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+    for (const auto & point : *cloud_) {
+      min_x_ = std::min(min_x_, point.x);
+      min_y_ = std::min(min_y_, point.y);
+      max_x = std::max(max_x, point.x);
+      max_y = std::max(max_y, point.y);
+    }
+
+    // coarsen the grid if the cloud is spread too widely for the configured cell size
+    const double area = (static_cast<double>(max_x - min_x_) + cell_size_) *
+                        (static_cast<double>(max_y - min_y_) + cell_size_);
+    const double min_resolution = std::sqrt(area / static_cast<double>(max_cell_num_));
+    resolution_ = std::max(cell_size_, static_cast<float>(min_resolution) * 1.01f);
+    width_ = static_cast<int>((max_x - min_x_) / resolution_) + 1;
+    height_ = static_cast<int>((max_y - min_y_) / resolution_) + 1;
+
+    // counting sort of the point indices by cell
+    std::vector<int> cell_indices(cloud_->size());
+    cell_begin_.assign(static_cast<size_t>(width_) * height_ + 1, 0);
+    for (size_t i = 0; i < cloud_->size(); ++i) {
+      const auto & point = cloud_->points[i];
+      cell_indices[i] = toCellIndex(toCellX(point.x), toCellY(point.y));
+      ++cell_begin_[cell_indices[i] + 1];
+    }
+    for (size_t i = 1; i < cell_begin_.size(); ++i) {
+      cell_begin_[i] += cell_begin_[i - 1];
+    }
+    std::vector<size_t> cell_end(cell_begin_.begin(), cell_begin_.end() - 1);
+    indices_.resize(cloud_->size());
+    for (size_t i = 0; i < cloud_->size(); ++i) {
+      indices_[cell_end[cell_indices[i]]++] = static_cast<int>(i);
+    }
+  }
+
+  bool empty() const { return width_ == 0; }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  float resolution() const { return resolution_; }
+  float originX() const { return min_x_; }
+  float originY() const { return min_y_; }
+
+  // cell coordinates, clamped to the grid
+  int toCellX(const float x) const { return clamp((x - min_x_) / resolution_, width_); }
+  int toCellY(const float y) const { return clamp((y - min_y_) / resolution_, height_); }
+
+  size_t getCellPointNum(const int cell_x, const int cell_y) const
+  {
+    const int cell_index = toCellIndex(cell_x, cell_y);
+    return cell_begin_[cell_index + 1] - cell_begin_[cell_index];
+  }
+
+  template <class Function>
+  void forEachPointInCell(const int cell_x, const int cell_y, Function function) const
+  {
+    const int cell_index = toCellIndex(cell_x, cell_y);
+    for (size_t i = cell_begin_[cell_index]; i < cell_begin_[cell_index + 1]; ++i) {
+      function(cloud_->points[indices_[i]]);
+    }
+  }
+
+private:
+  int toCellIndex(const int cell_x, const int cell_y) const { return cell_y * width_ + cell_x; }
+
+  static int clamp(const float value, const int size)
+  {
+    if (!(value > 0.0f)) return 0;
+    return static_cast<int>(std::min(value, static_cast<float>(size - 1)));
+  }
+
+  float cell_size_;
+  size_t max_cell_num_;
+  float resolution_{0.0f};
+  float min_x_{0.0f};
+  float min_y_{0.0f};
+  int width_{0};
+  int height_{0};
+  pcl::PointCloud<pcl::PointXY>::ConstPtr cloud_;
+  // points of cell i are indices_[cell_begin_[i]] ... indices_[cell_begin_[i + 1] - 1]
+  std::vector<size_t> cell_begin_{0};
+  std::vector<int> indices_;
+};
+}  // namespace obstacle_pointcloud_based_validator
+
+#endif  // OBSTACLE_POINTCLOUD_BASED_VALIDATOR__POINT_GRID_HPP_
@@ -17,12 +17,27 @@
 #include <perception_utils/perception_utils.hpp>
 #include <tier4_autoware_utils/tier4_autoware_utils.hpp>
 
-#include <boost/geometry/algorithms/convex_hull.hpp>
 #include <boost/geometry/algorithms/disjoint.hpp>
-#include <boost/geometry/algorithms/intersects.hpp>
+#include <boost/geometry/algorithms/envelope.hpp>
 
 #include <lanelet2_core/geometry/Polygon.h>
 
+#include <iterator>
+#include <vector>
+
+namespace
+{
+tier4_autoware_utils::Box2d calcEnvelope(const lanelet::BasicPolygon2d & polygon)
+{
+  tier4_autoware_utils::Box2d box;
+  boost::geometry::assign_inverse(box);
+  for (const auto & p : polygon) {
+    boost::geometry::expand(box, tier4_autoware_utils::Point2d(p.x(), p.y()));
+  }
+  return box;
+}
+}  // namespace
+
 namespace object_lanelet_filter
 {
 ObjectLaneletFilterNode::ObjectLaneletFilterNode(const rclcpp::NodeOptions & node_options)
@@ -58,7 +73,18 @@ void ObjectLaneletFilterNode::mapCallback(
   lanelet_map_ptr_ = std::make_shared<lanelet::LaneletMap>();
   lanelet::utils::conversion::fromBinMsg(*map_msg, lanelet_map_ptr_);
   const lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(lanelet_map_ptr_);
-  road_lanelets_ = lanelet::utils::query::roadLanelets(all_lanelets);
+  const lanelet::ConstLanelets road_lanelets = lanelet::utils::query::roadLanelets(all_lanelets);
+
+  road_lanelet_polygons_.clear();
+  road_lanelet_polygons_.reserve(road_lanelets.size());
+  std::vector<LaneletBox> boxes;
+  boxes.reserve(road_lanelets.size());
+  for (size_t i = 0; i < road_lanelets.size(); ++i) {
+    road_lanelet_polygons_.push_back(road_lanelets.at(i).polygon2d().basicPolygon());
+    boxes.emplace_back(calcEnvelope(road_lanelet_polygons_.back()), i);
+  }
+  // packing constructor
+  road_lanelet_rtree_ = decltype(road_lanelet_rtree_)(boxes.begin(), boxes.end());
 }
 
 void ObjectLaneletFilterNode::objectCallback(
@@ -82,13 +108,14 @@ void ObjectLaneletFilterNode::objectCallback(
     return;
   }
 
-  // calculate convex hull
-  const auto convex_hull = getConvexHull(transformed_objects);
-  // get intersected lanelets
-  lanelet::ConstLanelets intersected_lanelets = getIntersectedLanelets(convex_hull, road_lanelets_);
-
-  int index = 0;
-  for (const auto & object : transformed_objects.objects) {
+  // the objects are checked in parallel and published in the input order
+  const auto & objects = transformed_objects.objects;
+  std::vector<char> is_kept(objects.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (size_t index = 0; index < objects.size(); ++index) {
+    const auto & object = objects.at(index);
     const auto & footprint = object.shape.footprint;
     const auto & position = object.kinematics.pose_with_covariance.pose.position;
     const auto & label = object.classification.front().label;
@@ -106,51 +133,31 @@ void ObjectLaneletFilterNode::objectCallback(
         polygon.outer().emplace_back(point.x + position.x, point.y + position.y);
       }
       polygon.outer().push_back(polygon.outer().front());
-      if (isPolygonOverlapLanelets(polygon, intersected_lanelets)) {
-        output_object_msg.objects.emplace_back(input_msg->objects.at(index));
-      }
+      is_kept.at(index) = isPolygonOverlapLanelets(polygon);
     } else {
-      output_object_msg.objects.emplace_back(input_msg->objects.at(index));
-    }
-    ++index;
-  }
-  object_pub_->publish(output_object_msg);
-}
-
-LinearRing2d ObjectLaneletFilterNode::getConvexHull(
-  const autoware_auto_perception_msgs::msg::DetectedObjects & detected_objects)
-{
-  MultiPoint2d candidate_points;
-  for (const auto & object : detected_objects.objects) {
-    const auto & pos = object.kinematics.pose_with_covariance.pose.position;
-    for (const auto & p : object.shape.footprint.points) {
-      candidate_points.emplace_back(p.x + pos.x, p.y + pos.y);
+      is_kept.at(index) = true;
     }
   }
 
-  LinearRing2d convex_hull;
-  boost::geometry::convex_hull(candidate_points, convex_hull);
-
-  return convex_hull;
-}
-
-lanelet::ConstLanelets ObjectLaneletFilterNode::getIntersectedLanelets(
-  const LinearRing2d & convex_hull, const lanelet::ConstLanelets & road_lanelets)
-{
-  lanelet::ConstLanelets intersected_lanelets;
-  for (const auto & road_lanelet : road_lanelets) {
-    if (boost::geometry::intersects(convex_hull, road_lanelet.polygon2d().basicPolygon())) {
-      intersected_lanelets.emplace_back(road_lanelet);
+  for (size_t index = 0; index < objects.size(); ++index) {
+    if (is_kept.at(index)) {
+      output_object_msg.objects.emplace_back(input_msg->objects.at(index));
     }
   }
-  return intersected_lanelets;
+  object_pub_->publish(output_object_msg);
 }
 
-bool ObjectLaneletFilterNode::isPolygonOverlapLanelets(
-  const Polygon2d & polygon, const lanelet::ConstLanelets & intersected_lanelets)
+bool ObjectLaneletFilterNode::isPolygonOverlapLanelets(const Polygon2d & polygon) const
 {
-  for (const auto & lanelet : intersected_lanelets) {
-    if (!boost::geometry::disjoint(polygon, lanelet.polygon2d().basicPolygon())) {
+  // only the lanelets whose bounding box intersects the one of the polygon can overlap it
+  Box2d polygon_box;
+  boost::geometry::envelope(polygon, polygon_box);
+  std::vector<LaneletBox> hits;
+  road_lanelet_rtree_.query(
+    boost::geometry::index::intersects(polygon_box), std::back_inserter(hits));
+
+  for (const auto & hit : hits) {
+    if (!boost::geometry::disjoint(polygon, road_lanelet_polygons_.at(hit.second))) {
       return true;
     }
   }
@@ -17,10 +17,6 @@
 #include <perception_utils/perception_utils.hpp>
 #include <tier4_autoware_utils/tier4_autoware_utils.hpp>
 
-#include <pcl/filters/crop_hull.h>
-#include <pcl/kdtree/kdtree_flann.h>
-#include <pcl/search/kdtree.h>
-#include <pcl/search/pcl_search.h>
 #include <pcl_conversions/pcl_conversions.h>
 
 #ifdef ROS_DISTRO_GALACTIC
@@ -33,6 +29,10 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace
 {
 inline pcl::PointXY toPCL(const double x, const double y)
@@ -43,27 +43,27 @@ inline pcl::PointXY toPCL(const double x, const double y)
   return pcl_point;
 }
 
-inline pcl::PointXY toPCL(const geometry_msgs::msg::Point & point)
-{
-  return toPCL(point.x, point.y);
-}
-
 inline pcl::PointXYZ toXYZ(const pcl::PointXY & point)
 {
   return pcl::PointXYZ(point.x, point.y, 0.0);
 }
 
-inline pcl::PointCloud<pcl::PointXYZ>::Ptr toXYZ(
-  const pcl::PointCloud<pcl::PointXY>::Ptr & pointcloud)
+// Crossing number test, same as the one pcl::CropHull runs with dim 2.
+inline bool isPointInPolygon(
+  const pcl::PointXY & point, const pcl::PointCloud<pcl::PointXY> & polygon)
 {
-  pcl::PointCloud<pcl::PointXYZ>::Ptr pointcloud_xyz(new pcl::PointCloud<pcl::PointXYZ>);
-  pointcloud_xyz->reserve(pointcloud->size());
-  for (const auto & point : *pointcloud) {
-    pointcloud_xyz->push_back(toXYZ(point));
+  bool is_inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const auto & p0 = polygon[i];
+    const auto & p1 = polygon[j];
+    if (
+      (p0.y > point.y) != (p1.y > point.y) &&
+      point.x < (p1.x - p0.x) * (point.y - p0.y) / (p1.y - p0.y) + p0.x) {
+      is_inside = !is_inside;
+    }
   }
-  return pointcloud_xyz;
+  return is_inside;
 }
-
 }  // namespace
 
 namespace obstacle_pointcloud_based_validator
@@ -80,7 +80,8 @@ ObstaclePointCloudBasedValidator::ObstaclePointCloudBasedValidator(
     rclcpp::SensorDataQoS{}.keep_last(1).get_rmw_qos_profile()),
   tf_buffer_(get_clock()),
   tf_listener_(tf_buffer_),
-  sync_(SyncPolicy(10), objects_sub_, obstacle_pointcloud_sub_)
+  sync_(SyncPolicy(10), objects_sub_, obstacle_pointcloud_sub_),
+  point_grid_(declare_parameter<double>("grid_resolution", 0.5))
 {
   using std::placeholders::_1;
   using std::placeholders::_2;
@@ -121,34 +122,42 @@ void ObstaclePointCloudBasedValidator::onObjectsAndObstaclePointCloud(
     return;
   }
 
-  // Create Kd-tree to search neighbor pointcloud to reduce cost.
-  pcl::search::Search<pcl::PointXY>::Ptr kdtree =
-    pcl::make_shared<pcl::search::KdTree<pcl::PointXY>>(false);
-  kdtree->setInputCloud(obstacle_pointcloud);
+  // Bin the obstacle points into a 2D grid, which is built in one pass instead of a kd-tree.
+  point_grid_.setInputCloud(obstacle_pointcloud);
 
-  for (size_t i = 0; i < transformed_objects.objects.size(); ++i) {
-    const auto & transformed_object = transformed_objects.objects.at(i);
-    const auto & object = input_objects->objects.at(i);
-    const auto search_radius = getMaxRadius(transformed_object);
-    if (!search_radius) {
-      output.objects.push_back(object);
-      continue;
+  const auto & objects = transformed_objects.objects;
+  std::vector<pcl::PointCloud<pcl::PointXY>> polygons(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    toPolygon2d(objects.at(i), polygons.at(i));
+  }
+
+  // Count the points of all objects in parallel, the debug points are collected per object.
+  std::vector<std::optional<size_t>> nums(objects.size());
+  std::vector<pcl::PointCloud<pcl::PointXY>::Ptr> neighbor_pointclouds(objects.size());
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> pointclouds_within_polygon(objects.size());
+  if (debugger_) {
+    for (size_t i = 0; i < objects.size(); ++i) {
+      neighbor_pointclouds.at(i).reset(new pcl::PointCloud<pcl::PointXY>);
+      pointclouds_within_polygon.at(i).reset(new pcl::PointCloud<pcl::PointXYZ>);
     }
+  }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
+    nums.at(i) = getPointCloudNumWithinPolygon(
+      polygons.at(i), neighbor_pointclouds.at(i), pointclouds_within_polygon.at(i));
+  }
 
-    // Search neighbor pointcloud to reduce cost.
-    pcl::PointCloud<pcl::PointXY>::Ptr neighbor_pointcloud(new pcl::PointCloud<pcl::PointXY>);
-    std::vector<int> indices;
-    std::vector<float> distances;
-    kdtree->radiusSearch(
-      toPCL(transformed_object.kinematics.pose_with_covariance.pose.position),
-      search_radius.value(), indices, distances);
-    for (const auto & index : indices) {
-      neighbor_pointcloud->push_back(obstacle_pointcloud->at(index));
+  for (size_t i = 0; i < objects.size(); ++i) {
+    const auto & object = input_objects->objects.at(i);
+    if (debugger_) {
+      debugger_->addNeighborPointcloud(neighbor_pointclouds.at(i));
+      debugger_->addPointcloudWithinPolygon(pointclouds_within_polygon.at(i));
     }
-    if (debugger_) debugger_->addNeighborPointcloud(neighbor_pointcloud);
 
     // Filter object that have few pointcloud in them.
-    const auto num = getPointCloudNumWithinPolygon(transformed_object, neighbor_pointcloud);
+    const auto & num = nums.at(i);
     if (num) {
       if (min_pointcloud_num_ <= num.value())
         output.objects.push_back(object);
@@ -168,35 +177,70 @@ void ObstaclePointCloudBasedValidator::onObjectsAndObstaclePointCloud(
 }
 
 std::optional<size_t> ObstaclePointCloudBasedValidator::getPointCloudNumWithinPolygon(
-  const autoware_auto_perception_msgs::msg::DetectedObject & object,
-  const pcl::PointCloud<pcl::PointXY>::Ptr pointcloud)
+  const pcl::PointCloud<pcl::PointXY> & polygon,
+  const pcl::PointCloud<pcl::PointXY>::Ptr & neighbor_pointcloud,
+  const pcl::PointCloud<pcl::PointXYZ>::Ptr & pointcloud_within_polygon) const
 {
-  pcl::PointCloud<pcl::PointXY>::Ptr polygon(new pcl::PointCloud<pcl::PointXY>);
-  pcl::PointCloud<pcl::PointXYZ>::Ptr cropped_pointcloud(new pcl::PointCloud<pcl::PointXYZ>);
-  std::vector<pcl::Vertices> vertices_array;
-  pcl::Vertices vertices;
+  if (polygon.empty()) return std::nullopt;
 
-  toPolygon2d(object, polygon);
-  if (polygon->empty()) return std::nullopt;
-
-  for (size_t i = 0; i < polygon->size(); ++i) vertices.vertices.push_back(i);
-  vertices_array.push_back(vertices);
-
-  pcl::CropHull<pcl::PointXYZ> cropper;  // don't be implemented PointXY by PCL
-  cropper.setInputCloud(toXYZ(pointcloud));
-  cropper.setDim(2);
-  cropper.setHullIndices(vertices_array);
-  cropper.setHullCloud(toXYZ(polygon));
-  cropper.setCropOutside(true);
-  cropper.filter(*cropped_pointcloud);
+  // Rasterize the footprint to the cells covered by its bounding box.
+  float min_x = std::numeric_limits<float>::max();
+  float min_y = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::lowest();
+  float max_y = std::numeric_limits<float>::lowest();
+  for (const auto & vertex : polygon) {
+    min_x = std::min(min_x, vertex.x);
+    min_y = std::min(min_y, vertex.y);
+    max_x = std::max(max_x, vertex.x);
+    max_y = std::max(max_y, vertex.y);
+  }
+  const float resolution = point_grid_.resolution();
+  if (
+    max_x < point_grid_.originX() || max_y < point_grid_.originY() ||
+    point_grid_.originX() + point_grid_.width() * resolution < min_x ||
+    point_grid_.originY() + point_grid_.height() * resolution < min_y) {
+    return 0;
+  }
 
-  if (debugger_) debugger_->addPointcloudWithinPolygon(cropped_pointcloud);
-  return cropped_pointcloud->size();
+  const bool is_debug = neighbor_pointcloud && pointcloud_within_polygon;
+  size_t num = 0;
+  const auto count_point = [&](const pcl::PointXY & point) {
+    if (is_debug) neighbor_pointcloud->push_back(point);
+    if (isPointInPolygon(point, polygon)) {
+      ++num;
+      if (is_debug) pointcloud_within_polygon->push_back(toXYZ(point));
+    }
+  };
+  for (int cell_y = point_grid_.toCellY(min_y); cell_y <= point_grid_.toCellY(max_y); ++cell_y) {
+    const float cell_min_y = point_grid_.originY() + cell_y * resolution;
+    for (int cell_x = point_grid_.toCellX(min_x); cell_x <= point_grid_.toCellX(max_x);
+         ++cell_x) {
+      const float cell_min_x = point_grid_.originX() + cell_x * resolution;
+      // The footprints are convex, so a cell whose corners are all inside is covered entirely.
+      const bool is_covered =
+        isPointInPolygon(toPCL(cell_min_x, cell_min_y), polygon) &&
+        isPointInPolygon(toPCL(cell_min_x + resolution, cell_min_y), polygon) &&
+        isPointInPolygon(toPCL(cell_min_x, cell_min_y + resolution), polygon) &&
+        isPointInPolygon(toPCL(cell_min_x + resolution, cell_min_y + resolution), polygon);
+      if (!is_covered) {
+        point_grid_.forEachPointInCell(cell_x, cell_y, count_point);
+        continue;
+      }
+      num += point_grid_.getCellPointNum(cell_x, cell_y);
+      if (is_debug) {
+        point_grid_.forEachPointInCell(cell_x, cell_y, [&](const pcl::PointXY & point) {
+          neighbor_pointcloud->push_back(point);
+          pointcloud_within_polygon->push_back(toXYZ(point));
+        });
+      }
+    }
+  }
+  return num;
 }
 
 void ObstaclePointCloudBasedValidator::toPolygon2d(
   const autoware_auto_perception_msgs::msg::DetectedObject & object,
-  const pcl::PointCloud<pcl::PointXY>::Ptr & polygon)
+  pcl::PointCloud<pcl::PointXY> & polygon)
 {
   if (object.shape.type == Shape::BOUNDING_BOX) {
     const auto & pose = object.kinematics.pose_with_covariance.pose;
@@ -212,13 +256,13 @@ void ObstaclePointCloudBasedValidator::toPolygon2d(
               Eigen::Vector2d(-object.shape.dimensions.x * 0.5f, -object.shape.dimensions.y * 0.5f);
     offset3 = rotation *
               Eigen::Vector2d(-object.shape.dimensions.x * 0.5f, object.shape.dimensions.y * 0.5f);
-    polygon->push_back(
+    polygon.push_back(
       pcl::PointXY(toPCL(pose.position.x + offset0.x(), pose.position.y + offset0.y())));
-    polygon->push_back(
+    polygon.push_back(
       pcl::PointXY(toPCL(pose.position.x + offset1.x(), pose.position.y + offset1.y())));
-    polygon->push_back(
+    polygon.push_back(
       pcl::PointXY(toPCL(pose.position.x + offset2.x(), pose.position.y + offset2.y())));
-    polygon->push_back(
+    polygon.push_back(
       pcl::PointXY(toPCL(pose.position.x + offset3.x(), pose.position.y + offset3.y())));
   } else if (object.shape.type == Shape::CYLINDER) {
     const auto & center = object.kinematics.pose_with_covariance.pose.position;
@@ -236,31 +280,13 @@ void ObstaclePointCloudBasedValidator::toPolygon2d(
                     M_PI / static_cast<double>(n)) *
                     radius +
                   center.y;
-      polygon->push_back(toPCL(point.x(), point.y()));
+      polygon.push_back(toPCL(point.x(), point.y()));
     }
   } else if (object.shape.type == Shape::POLYGON) {
     RCLCPP_WARN_THROTTLE(
       this->get_logger(), *this->get_clock(), 5000, "POLYGON type is not supported");
-  }
-}
-
-std::optional<float> ObstaclePointCloudBasedValidator::getMaxRadius(
-  const autoware_auto_perception_msgs::msg::DetectedObject & object)
-{
-  if (object.shape.type == Shape::BOUNDING_BOX) {
-    return std::hypot(object.shape.dimensions.x * 0.5f, object.shape.dimensions.y * 0.5f);
-  } else if (object.shape.type == Shape::CYLINDER) {
-    return std::hypot(object.shape.dimensions.x * 0.5f, object.shape.dimensions.y * 0.5f);
-  } else if (object.shape.type == Shape::POLYGON) {
-    float max_dist = 0.0;
-    for (const auto & point : object.shape.footprint.points) {
-      const float dist = std::hypot(point.x, point.y);
-      max_dist = max_dist < dist ? dist : max_dist;
-    }
-    return max_dist;
   } else {
     RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 5000, "unknown shape type");
-    return std::nullopt;
   }
 }
 
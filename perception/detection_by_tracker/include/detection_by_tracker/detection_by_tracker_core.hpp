@@ -18,6 +18,7 @@
 #include "detection_by_tracker/debugger.hpp"
 
 #include <euclidean_cluster/euclidean_cluster.hpp>
+#include <euclidean_cluster/multi_scale_euclidean_cluster.hpp>
 #include <euclidean_cluster/utils.hpp>
 #include <euclidean_cluster/voxel_grid_based_euclidean_cluster.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -92,7 +93,8 @@ private:
 
   float optimizeUnderSegmentedObject(
     const autoware_auto_perception_msgs::msg::DetectedObject & target_object,
-    const sensor_msgs::msg::PointCloud2 & under_segmented_cluster,
+    const euclidean_cluster::MultiScaleEuclideanCluster & under_segmented_cluster,
+    const std_msgs::msg::Header & header,
     tier4_perception_msgs::msg::DetectedObjectWithFeature & output);
 
   void mergeOverSegmentedObjects(
@@ -17,6 +17,7 @@
 #include "perception_utils/perception_utils.hpp"
 
 #include <chrono>
+#include <cmath>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,12 @@
 using Label = autoware_auto_perception_msgs::msg::ObjectClassification;
 namespace
 {
+// clustering tolerances tried to divide an under segmented cluster
+constexpr float iter_rate = 0.8;
+constexpr int iter_max_count = 5;
+constexpr float initial_cluster_range = 0.7;
+constexpr float initial_voxel_size = initial_cluster_range / 2.0f;
+
 void setClusterInObjectWithFeature(
   const std_msgs::msg::Header & header, const pcl::PointCloud<pcl::PointXYZ> & cluster,
   tier4_perception_msgs::msg::DetectedObjectWithFeature & feature_object)
@@ -216,15 +223,22 @@ void DetectionByTracker::divideUnderSegmentedObjects(
   out_objects.header = in_cluster_objects.header;
   out_no_found_tracked_objects.header = tracked_objects.header;
 
-  for (const auto & tracked_object : tracked_objects.objects) {
-    const auto & label = tracked_object.classification.front().label;
-    if (ignore_unknown_tracker_ && (label == Label::UNKNOWN)) continue;
+  const auto & initial_objects = in_cluster_objects.feature_objects;
 
-    std::optional<tier4_perception_msgs::msg::DetectedObjectWithFeature>
-      highest_score_divided_object = std::nullopt;
-    float highest_score = 0.0;
+  // find the under segmented clusters of each tracked object
+  std::vector<char> is_ignored(tracked_objects.objects.size(), false);
+  std::vector<std::vector<size_t>> under_segmented_indices(tracked_objects.objects.size());
+  std::vector<char> is_under_segmented_cluster(initial_objects.size(), false);
+  for (size_t i = 0; i < tracked_objects.objects.size(); ++i) {
+    const auto & tracked_object = tracked_objects.objects.at(i);
+    const auto & label = tracked_object.classification.front().label;
+    if (ignore_unknown_tracker_ && (label == Label::UNKNOWN)) {
+      is_ignored.at(i) = true;
+      continue;
+    }
 
-    for (const auto & initial_object : in_cluster_objects.feature_objects) {
+    for (size_t j = 0; j < initial_objects.size(); ++j) {
+      const auto & initial_object = initial_objects.at(j);
       // search near object
       const float distance = tier4_autoware_utils::calcDistance2d(
         tracked_object.kinematics.pose_with_covariance.pose,
@@ -241,59 +255,83 @@ void DetectionByTracker::divideUnderSegmentedObjects(
       if (!is_under_segmented) {
         continue;
       }
-      // optimize clustering
+      under_segmented_indices.at(i).push_back(j);
+      is_under_segmented_cluster.at(j) = true;
+    }
+  }
+
+  // build the clustering hierarchy of each under segmented cluster once for all tracked objects
+  std::vector<std::shared_ptr<euclidean_cluster::MultiScaleEuclideanCluster>> multi_scale_clusters(
+    initial_objects.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int j = 0; j < static_cast<int>(initial_objects.size()); ++j) {
+    if (!is_under_segmented_cluster.at(j)) {
+      continue;
+    }
+    pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_cluster(new pcl::PointCloud<pcl::PointXYZ>);
+    pcl::fromROSMsg(initial_objects.at(j).feature.cluster, *pcl_cluster);
+    const float finest_voxel_size =
+      initial_voxel_size * std::pow(iter_rate, static_cast<float>(iter_max_count - 1));
+    multi_scale_clusters.at(j) = std::make_shared<euclidean_cluster::MultiScaleEuclideanCluster>(
+      4, 10000, initial_cluster_range, finest_voxel_size);
+    multi_scale_clusters.at(j)->setInputCloud(pcl_cluster);
+  }
+
+  // optimize clustering of the tracked objects in parallel
+  std::vector<std::optional<tier4_perception_msgs::msg::DetectedObjectWithFeature>>
+    highest_score_divided_objects(tracked_objects.objects.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(tracked_objects.objects.size()); ++i) {
+    float highest_score = 0.0;
+    for (const auto j : under_segmented_indices.at(i)) {
       tier4_perception_msgs::msg::DetectedObjectWithFeature divided_object;
       float score = optimizeUnderSegmentedObject(
-        tracked_object, initial_object.feature.cluster, divided_object);
+        tracked_objects.objects.at(i), *multi_scale_clusters.at(j),
+        initial_objects.at(j).feature.cluster.header, divided_object);
       if (score < min_score_threshold) {
         continue;
       }
 
       if (highest_score < score) {
         highest_score = score;
-        highest_score_divided_object = divided_object;
+        highest_score_divided_objects.at(i) = divided_object;
       }
     }
-    if (highest_score_divided_object) {  // found
-      out_objects.feature_objects.push_back(highest_score_divided_object.value());
+  }
+
+  for (size_t i = 0; i < tracked_objects.objects.size(); ++i) {
+    if (is_ignored.at(i)) {
+      continue;
+    }
+    if (highest_score_divided_objects.at(i)) {  // found
+      out_objects.feature_objects.push_back(highest_score_divided_objects.at(i).value());
     } else {  // not found
-      out_no_found_tracked_objects.objects.push_back(tracked_object);
+      out_no_found_tracked_objects.objects.push_back(tracked_objects.objects.at(i));
     }
   }
 }
 
 float DetectionByTracker::optimizeUnderSegmentedObject(
   const autoware_auto_perception_msgs::msg::DetectedObject & target_object,
-  const sensor_msgs::msg::PointCloud2 & under_segmented_cluster,
+  const euclidean_cluster::MultiScaleEuclideanCluster & under_segmented_cluster,
+  const std_msgs::msg::Header & header,
   tier4_perception_msgs::msg::DetectedObjectWithFeature & output)
 {
-  constexpr float iter_rate = 0.8;
-  constexpr int iter_max_count = 5;
-  constexpr float initial_cluster_range = 0.7;
   float cluster_range = initial_cluster_range;
-  constexpr float initial_voxel_size = initial_cluster_range / 2.0f;
-  float voxel_size = initial_voxel_size;
 
   const auto & label = target_object.classification.front().label;
 
-  // initialize clustering parameters
-  euclidean_cluster::VoxelGridBasedEuclideanCluster cluster(
-    false, 4, 10000, initial_cluster_range, initial_voxel_size, 0);
-
-  // convert to pcl
-  pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_cluster(new pcl::PointCloud<pcl::PointXYZ>);
-  pcl::fromROSMsg(under_segmented_cluster, *pcl_cluster);
-
   // iterate to find best fit divided object
   float highest_iou = 0.0;
   tier4_perception_msgs::msg::DetectedObjectWithFeature highest_iou_object;
-  for (int iter_count = 0; iter_count < iter_max_count;
-       ++iter_count, cluster_range *= iter_rate, voxel_size *= iter_rate) {
-    // divide under segmented cluster
+  for (int iter_count = 0; iter_count < iter_max_count; ++iter_count, cluster_range *= iter_rate) {
+    // divide under segmented cluster, read off the hierarchy built for all the ranges
     std::vector<pcl::PointCloud<pcl::PointXYZ>> divided_clusters;
-    cluster.setTolerance(cluster_range);
-    cluster.setVoxelLeafSize(voxel_size);
-    cluster.cluster(pcl_cluster, divided_clusters);
+    under_segmented_cluster.cluster(cluster_range, divided_clusters);
 
     // find highest iou object in divided clusters
     float highest_iou_in_current_iter = 0.0f;
@@ -313,8 +351,7 @@ float DetectionByTracker::optimizeUnderSegmentedObject(
         perception_utils::get2dIoU(highest_iou_object_in_current_iter.object, target_object);
       if (highest_iou_in_current_iter < iou) {
         highest_iou_in_current_iter = iou;
-        setClusterInObjectWithFeature(
-          under_segmented_cluster.header, divided_cluster, highest_iou_object_in_current_iter);
+        setClusterInObjectWithFeature(header, divided_cluster, highest_iou_object_in_current_iter);
       }
     }
 
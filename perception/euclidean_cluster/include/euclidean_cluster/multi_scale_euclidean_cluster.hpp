@@ -0,0 +1,66 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <vector>
+
+namespace euclidean_cluster
+{
+/**
+ * @brief Euclidean clustering at several tolerances of the same pointcloud.
+ *
+ * The points are voxelized in 2D once and a single-linkage hierarchy (the merges of a minimum
+ * spanning tree) of the voxel centroids is built up to `max_tolerance`. The clusters of any
+ * tolerance up to `max_tolerance` are then read off the hierarchy without rebuilding the voxel
+ * grid or a kd-tree. The object is read-only after setInputCloud.
+ */
+class MultiScaleEuclideanCluster
+{
+public:
+  MultiScaleEuclideanCluster(
+    int min_cluster_size, int max_cluster_size, float max_tolerance, float voxel_leaf_size);
+
+  void setInputCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr & pointcloud);
+
+  /**
+   * @brief clusters whose voxel centroids are connected within `tolerance`
+   */
+  bool cluster(const float tolerance, std::vector<pcl::PointCloud<pcl::PointXYZ>> & clusters) const;
+
+private:
+  struct Merge
+  {
+    float distance;
+    int voxel_a;
+    int voxel_b;
+  };
+
+  int min_cluster_size_;
+  int max_cluster_size_;
+  float max_tolerance_;
+  float voxel_leaf_size_;
+
+  pcl::PointCloud<pcl::PointXYZ>::ConstPtr pointcloud_;
+  // voxel of each point
+  std::vector<int> point_voxels_;
+  int voxel_num_{0};
+  // sorted by distance
+  std::vector<Merge> merges_;
+};
+
+}  // namespace euclidean_cluster
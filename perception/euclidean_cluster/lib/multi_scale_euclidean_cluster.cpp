@@ -0,0 +1,172 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "euclidean_cluster/multi_scale_euclidean_cluster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+int64_t toKey(const int x, const int y)
+{
+  return static_cast<int64_t>(
+    (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y));
+}
+
+int findRoot(std::vector<int> & parents, int index)
+{
+  while (parents[index] != index) {
+    parents[index] = parents[parents[index]];
+    index = parents[index];
+  }
+  return index;
+}
+}  // namespace
+
+namespace euclidean_cluster
+{
+MultiScaleEuclideanCluster::MultiScaleEuclideanCluster(
+  int min_cluster_size, int max_cluster_size, float max_tolerance, float voxel_leaf_size)
+: min_cluster_size_(min_cluster_size),
+  max_cluster_size_(max_cluster_size),
+  max_tolerance_(max_tolerance),
+  voxel_leaf_size_(voxel_leaf_size)
+{
+}
+
+void MultiScaleEuclideanCluster::setInputCloud(
+  const pcl::PointCloud<pcl::PointXYZ>::ConstPtr & pointcloud)
+{
+  pointcloud_ = pointcloud;
+  merges_.clear();
+
+  // voxelize in 2D and calculate the centroid of each voxel
+  std::unordered_map<int64_t, int> voxel_indices;
+  std::vector<double> sum_x, sum_y;
+  std::vector<int> point_num;
+  point_voxels_.resize(pointcloud->size());
+  for (size_t i = 0; i < pointcloud->size(); ++i) {
+    const auto & point = pointcloud->points[i];
+    const auto key = toKey(
+      static_cast<int>(std::floor(point.x / voxel_leaf_size_)),
+      static_cast<int>(std::floor(point.y / voxel_leaf_size_)));
+    const auto itr = voxel_indices.emplace(key, static_cast<int>(sum_x.size())).first;
+    if (itr->second == static_cast<int>(sum_x.size())) {
+      sum_x.push_back(0.0);
+      sum_y.push_back(0.0);
+      point_num.push_back(0);
+    }
+    point_voxels_[i] = itr->second;
+    sum_x[itr->second] += point.x;
+    sum_y[itr->second] += point.y;
+    ++point_num[itr->second];
+  }
+  voxel_num_ = static_cast<int>(sum_x.size());
+  std::vector<float> centroid_x(voxel_num_), centroid_y(voxel_num_);
+  for (int i = 0; i < voxel_num_; ++i) {
+    centroid_x[i] = static_cast<float>(sum_x[i] / point_num[i]);
+    centroid_y[i] = static_cast<float>(sum_y[i] / point_num[i]);
+  }
+
+  // bucket the centroids by max_tolerance, so the neighbors of a centroid are in 3x3 buckets
+  std::unordered_map<int64_t, std::vector<int>> buckets;
+  std::vector<int> bucket_x(voxel_num_), bucket_y(voxel_num_);
+  for (int i = 0; i < voxel_num_; ++i) {
+    bucket_x[i] = static_cast<int>(std::floor(centroid_x[i] / max_tolerance_));
+    bucket_y[i] = static_cast<int>(std::floor(centroid_y[i] / max_tolerance_));
+    buckets[toKey(bucket_x[i], bucket_y[i])].push_back(i);
+  }
+
+  // all the centroid pairs within max_tolerance
+  std::vector<Merge> edges;
+  for (int i = 0; i < voxel_num_; ++i) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        const auto itr = buckets.find(toKey(bucket_x[i] + dx, bucket_y[i] + dy));
+        if (itr == buckets.end()) continue;
+        for (const int j : itr->second) {
+          if (j <= i) continue;
+          const float distance =
+            std::hypot(centroid_x[i] - centroid_x[j], centroid_y[i] - centroid_y[j]);
+          if (distance <= max_tolerance_) edges.push_back(Merge{distance, i, j});
+        }
+      }
+    }
+  }
+
+  // Kruskal: the edges joining two components are the merges of the single-linkage hierarchy
+  std::stable_sort(edges.begin(), edges.end(), [](const Merge & a, const Merge & b) {
+    return a.distance < b.distance;
+  });
+  std::vector<int> parents(voxel_num_);
+  std::iota(parents.begin(), parents.end(), 0);
+  for (const auto & edge : edges) {
+    const int root_a = findRoot(parents, edge.voxel_a);
+    const int root_b = findRoot(parents, edge.voxel_b);
+    if (root_a == root_b) continue;
+    parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+    merges_.push_back(edge);
+    if (static_cast<int>(merges_.size()) == voxel_num_ - 1) break;
+  }
+}
+
+bool MultiScaleEuclideanCluster::cluster(
+  const float tolerance, std::vector<pcl::PointCloud<pcl::PointXYZ>> & clusters) const
+{
+  if (!pointcloud_ || max_tolerance_ < tolerance) {
+    return false;
+  }
+
+  std::vector<int> parents(voxel_num_);
+  std::iota(parents.begin(), parents.end(), 0);
+  for (const auto & merge : merges_) {
+    if (tolerance < merge.distance) break;
+    const int root_a = findRoot(parents, merge.voxel_a);
+    const int root_b = findRoot(parents, merge.voxel_b);
+    parents[std::max(root_a, root_b)] = std::min(root_a, root_b);
+  }
+
+  // clusters are ordered by their first point
+  std::vector<int> cluster_indices(voxel_num_, -1);
+  std::vector<pcl::PointCloud<pcl::PointXYZ>> temporary_clusters;  // no check about cluster size
+  for (size_t i = 0; i < pointcloud_->size(); ++i) {
+    const int root = findRoot(parents, point_voxels_[i]);
+    if (cluster_indices[root] < 0) {
+      cluster_indices[root] = static_cast<int>(temporary_clusters.size());
+      temporary_clusters.emplace_back();
+    }
+    temporary_clusters[cluster_indices[root]].points.push_back(pointcloud_->points[i]);
+  }
+
+  // build output and check cluster size
+  for (const auto & cluster : temporary_clusters) {
+    if (!(min_cluster_size_ <= static_cast<int>(cluster.points.size()) &&
+          static_cast<int>(cluster.points.size()) <= max_cluster_size_)) {
+      continue;
+    }
+    clusters.push_back(cluster);
+    clusters.back().width = cluster.points.size();
+    clusters.back().height = 1;
+    clusters.back().is_dense = false;
+  }
+
+  return true;
+}
+
+}  // namespace euclidean_cluster
@@ -16,22 +16,23 @@
 #define IMAGE_PROJECTION_BASED_FUSION__FUSION_NODE_HPP_
 
 #include <image_projection_based_fusion/debugger.hpp>
+#include <image_projection_based_fusion/utils/utils.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <tier4_autoware_utils/ros/debug_publisher.hpp>
 
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
 #include <sensor_msgs/msg/camera_info.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 #include <tier4_perception_msgs/msg/detected_objects_with_feature.hpp>
 
-#include <message_filters/pass_through.h>
-#include <message_filters/subscriber.h>
-#include <message_filters/sync_policies/approximate_time.h>
-#include <message_filters/synchronizer.h>
+#include <boost/circular_buffer.hpp>
+
 #include <tf2_ros/buffer.h>
 #include <tf2_ros/transform_listener.h>
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -53,19 +54,22 @@ protected:
     const sensor_msgs::msg::CameraInfo::ConstSharedPtr input_camera_info_msg,
     const std::size_t camera_id);
 
-  void fusionCallback(
-    typename Msg::ConstSharedPtr input_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi0_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi1_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi2_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi3_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi4_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi5_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi6_msg,
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi7_msg);
+  void subCallback(const typename Msg::ConstSharedPtr input_msg);
+
+  void roiCallback(
+    const DetectedObjectsWithFeature::ConstSharedPtr input_roi_msg, const std::size_t roi_i);
+
+  void timerCallback();
 
   virtual void preprocess(Msg & output_msg);
 
+  /**
+   * @brief matrix mapping a point of `source_frame_id` to homogeneous pixel coordinates of the
+   * camera (rows 0-2) and to its depth along the optical axis (row 3)
+   */
+  std::optional<Eigen::Matrix4f> getCameraProjection(
+    const std::size_t camera_id, const std::string & source_frame_id);
+
   virtual void fuseOnSingleImage(
     const Msg & input_msg, const std::size_t image_id,
     const DetectedObjectsWithFeature & input_roi_msg,
@@ -76,6 +80,14 @@ protected:
 
   void publish(const Msg & output_msg);
 
+  // fuse the rois of a camera into the frame in progress
+  void fuseRoi(
+    const std::size_t roi_i, const DetectedObjectsWithFeature & input_roi_msg,
+    const rclcpp::Time & arrival_time);
+
+  // publish the frame in progress, the cameras which have not arrived yet are skipped
+  void finishFusion();
+
   std::size_t rois_number_{1};
   tf2_ros::Buffer tf_buffer_;
   tf2_ros::TransformListener tf_listener_;
@@ -83,27 +95,41 @@ protected:
   // camera_info
   std::map<std::size_t, sensor_msgs::msg::CameraInfo> camera_info_map_;
   std::vector<rclcpp::Subscription<sensor_msgs::msg::CameraInfo>::SharedPtr> camera_info_subs_;
+  // combined extrinsic and intrinsic projection, dropped when the intrinsics or frames change
+  struct CameraProjection
+  {
+    std::string source_frame_id;
+    Eigen::Matrix4f matrix;
+  };
+  std::map<std::size_t, CameraProjection> camera_projection_map_;
 
   // fusion
-  typename message_filters::Subscriber<Msg> sub_;
-  message_filters::PassThrough<DetectedObjectsWithFeature> passthrough_;
-  std::vector<std::shared_ptr<message_filters::Subscriber<DetectedObjectsWithFeature>>> rois_subs_;
-  inline void dummyCallback(DetectedObjectsWithFeature::ConstSharedPtr input)
+  typename rclcpp::Subscription<Msg>::SharedPtr sub_;
+  std::vector<rclcpp::Subscription<DetectedObjectsWithFeature>::SharedPtr> rois_subs_;
+  double match_threshold_ms_;
+  double timeout_ms_;
+  rclcpp::TimerBase::SharedPtr timer_;
+
+  // rois which arrived before their input, a ring buffer per camera
+  struct CachedRoi
   {
-    passthrough_.add(input);
-  }
-  using SyncPolicy = message_filters::sync_policies::ApproximateTime<
-    Msg, DetectedObjectsWithFeature, DetectedObjectsWithFeature, DetectedObjectsWithFeature,
-    DetectedObjectsWithFeature, DetectedObjectsWithFeature, DetectedObjectsWithFeature,
-    DetectedObjectsWithFeature, DetectedObjectsWithFeature>;
-  using Sync = message_filters::Synchronizer<SyncPolicy>;
-  typename std::shared_ptr<Sync> sync_ptr_;
+    rclcpp::Time arrival_time;
+    DetectedObjectsWithFeature::ConstSharedPtr msg;
+  };
+  std::vector<boost::circular_buffer<CachedRoi>> cached_rois_;
+
+  // frame in progress, waiting for the rois until timeout_ms_ after the input arrived
+  typename Msg::ConstSharedPtr input_msg_;
+  rclcpp::Time input_arrival_time_;
+  Msg output_msg_;
+  std::vector<bool> is_fused_;
 
   // output
   typename rclcpp::Publisher<Msg>::SharedPtr pub_ptr_;
 
   // debugger
   std::shared_ptr<Debugger> debugger_;
+  std::unique_ptr<tier4_autoware_utils::DebugPublisher> debug_publisher_;
   virtual bool out_of_scope(const ObjType & obj) = 0;
   float filter_scope_minx_;
   float filter_scope_maxx_;
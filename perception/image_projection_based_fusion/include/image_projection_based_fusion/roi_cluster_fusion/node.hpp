@@ -17,7 +17,10 @@
 
 #include "image_projection_based_fusion/fusion_node.hpp"
 
+#include <image_projection_based_fusion/utils/geometry.hpp>
+
 #include <memory>
+#include <vector>
 
 namespace image_projection_based_fusion
 {
@@ -43,6 +46,9 @@ protected:
   bool use_cluster_semantic_type_{false};
   float iou_threshold_{0.0f};
 
+  RoiColumnIndex roi_index_;
+  std::vector<std::size_t> candidate_indices_;
+
   bool out_of_scope(const DetectedObjectWithFeature & obj);
 };
 
@@ -22,8 +22,10 @@
 
 #include <autoware_auto_perception_msgs/msg/shape.hpp>
 #include <geometry_msgs/msg/pose.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
 #include <sensor_msgs/msg/region_of_interest.hpp>
 
+#include <cstdint>
 #include <vector>
 
 namespace image_projection_based_fusion
@@ -60,6 +62,40 @@ void transformPoints(
   const std::vector<Eigen::Vector3d> & input_points, const Eigen::Affine3d & affine_transform,
   std::vector<Eigen::Vector3d> & output_points);
 
+/**
+ * @brief 2D bounding box of the points of `cluster` on the image. `projection` maps a point of
+ * the cluster frame to homogeneous pixel coordinates (rows 0-2) and to its depth along the
+ * optical axis (row 3). Points behind the camera or outside the image are skipped. The points
+ * are projected in batches of 8, with AVX or SSE2 when the compiler enables them.
+ * @return false if no point is on the image
+ */
+bool calcProjectedRoi(
+  const sensor_msgs::msg::PointCloud2 & cluster, const Eigen::Matrix4f & projection,
+  const int image_width, const int image_height, sensor_msgs::msg::RegionOfInterest & roi,
+  std::vector<Eigen::Vector2d> * projected_points = nullptr);
+
+/**
+ * @brief ROIs bucketed by image columns, to find the ROIs overlapping another one without
+ * scanning all of them.
+ */
+class RoiColumnIndex
+{
+public:
+  explicit RoiColumnIndex(const std::uint32_t column_width = 32) : column_width_(column_width) {}
+
+  void clear();
+  void insert(const std::size_t id, const sensor_msgs::msg::RegionOfInterest & roi);
+
+  /**
+   * @brief ids of the ROIs whose columns overlap those of `roi`, in ascending order
+   */
+  void query(const sensor_msgs::msg::RegionOfInterest & roi, std::vector<std::size_t> & ids) const;
+
+private:
+  std::uint32_t column_width_;
+  std::vector<std::vector<std::size_t>> columns_;
+};
+
 }  // namespace image_projection_based_fusion
 
 #endif  // IMAGE_PROJECTION_BASED_FUSION__UTILS__GEOMETRY_HPP_
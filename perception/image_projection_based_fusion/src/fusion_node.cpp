@@ -19,6 +19,7 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
+#include <tier4_debug_msgs/msg/float64_stamped.hpp>
 #include <tier4_perception_msgs/msg/detected_object_with_feature.hpp>
 
 #include <boost/optional.hpp>
@@ -32,6 +33,10 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <typeinfo>
 namespace image_projection_based_fusion
 {
@@ -47,14 +52,14 @@ FusionNode<Msg, ObjType>::FusionNode(
       this->get_logger(), "minimum rois_number is 1. current rois_number is %zu", rois_number_);
     rois_number_ = 1;
   }
-  if (rois_number_ > 8) {
-    RCLCPP_WARN(
-      this->get_logger(), "maximum rois_number is 8. current rois_number is %zu", rois_number_);
-    rois_number_ = 8;
-  }
+  match_threshold_ms_ = declare_parameter<double>("match_threshold_ms", 50.0);
+  timeout_ms_ = declare_parameter<double>("timeout_ms", 70.0);
+  const auto roi_buffer_size = static_cast<std::size_t>(declare_parameter("roi_buffer_size", 10));
 
   // subscribers
-  sub_.subscribe(this, "input", rclcpp::QoS(1).get_rmw_qos_profile());
+  std::function<void(const typename Msg::ConstSharedPtr msg)> sub_callback =
+    std::bind(&FusionNode::subCallback, this, std::placeholders::_1);
+  sub_ = this->create_subscription<Msg>("input", rclcpp::QoS(1), sub_callback);
 
   camera_info_subs_.resize(rois_number_);
   for (std::size_t roi_i = 0; roi_i < rois_number_; ++roi_i) {
@@ -66,63 +71,19 @@ FusionNode<Msg, ObjType>::FusionNode(
 
   rois_subs_.resize(rois_number_);
   for (std::size_t roi_i = 0; roi_i < rois_number_; ++roi_i) {
-    rois_subs_.at(roi_i) =
-      std::make_shared<message_filters::Subscriber<DetectedObjectsWithFeature>>(
-        this, "input/rois" + std::to_string(roi_i), rclcpp::QoS{1}.get_rmw_qos_profile());
-  }
-
-  // add dummy callback to enable passthrough filter
-  rois_subs_.at(0)->registerCallback(
-    std::bind(&FusionNode::dummyCallback, this, std::placeholders::_1));
-  switch (rois_number_) {
-    case 1:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), passthrough_, passthrough_, passthrough_,
-        passthrough_, passthrough_, passthrough_, passthrough_);
-      break;
-    case 2:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), passthrough_, passthrough_,
-        passthrough_, passthrough_, passthrough_, passthrough_);
-      break;
-    case 3:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2), passthrough_,
-        passthrough_, passthrough_, passthrough_, passthrough_);
-      break;
-    case 4:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2),
-        *rois_subs_.at(3), passthrough_, passthrough_, passthrough_, passthrough_);
-      break;
-    case 5:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2),
-        *rois_subs_.at(3), *rois_subs_.at(4), passthrough_, passthrough_, passthrough_);
-      break;
-    case 6:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2),
-        *rois_subs_.at(3), *rois_subs_.at(4), *rois_subs_.at(5), passthrough_, passthrough_);
-      break;
-    case 7:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2),
-        *rois_subs_.at(3), *rois_subs_.at(4), *rois_subs_.at(5), *rois_subs_.at(6), passthrough_);
-      break;
-    case 8:
-      sync_ptr_ = std::make_shared<Sync>(
-        SyncPolicy(10), sub_, *rois_subs_.at(0), *rois_subs_.at(1), *rois_subs_.at(2),
-        *rois_subs_.at(3), *rois_subs_.at(4), *rois_subs_.at(5), *rois_subs_.at(6),
-        *rois_subs_.at(7));
-    default:
-      return;
+    std::function<void(const DetectedObjectsWithFeature::ConstSharedPtr msg)> roi_callback =
+      std::bind(&FusionNode::roiCallback, this, std::placeholders::_1, roi_i);
+    rois_subs_.at(roi_i) = this->create_subscription<DetectedObjectsWithFeature>(
+      "input/rois" + std::to_string(roi_i), rclcpp::QoS{1}, roi_callback);
   }
+  cached_rois_.assign(rois_number_, boost::circular_buffer<CachedRoi>(roi_buffer_size));
+  is_fused_.assign(rois_number_, false);
 
-  sync_ptr_->registerCallback(std::bind(
-    &FusionNode::fusionCallback, this, std::placeholders::_1, std::placeholders::_2,
-    std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6,
-    std::placeholders::_7, std::placeholders::_8, std::placeholders::_9));
+  // fusion deadline, started when an input arrives
+  timer_ = this->create_wall_timer(
+    std::chrono::duration<double, std::milli>(timeout_ms_),
+    std::bind(&FusionNode::timerCallback, this));
+  timer_->cancel();
 
   // publisher
   pub_ptr_ = this->create_publisher<Msg>("output", rclcpp::QoS{1});
@@ -133,6 +94,7 @@ FusionNode<Msg, ObjType>::FusionNode(
       static_cast<std::size_t>(declare_parameter("image_buffer_size", 15));
     debugger_ = std::make_shared<Debugger>(this, rois_number_, image_buffer_size);
   }
+  debug_publisher_ = std::make_unique<tier4_autoware_utils::DebugPublisher>(this, get_name());
 
   filter_scope_minx_ = declare_parameter("filter_scope_minx", -100);
   filter_scope_maxx_ = declare_parameter("filter_scope_maxx", 100);
@@ -147,9 +109,48 @@ void FusionNode<Msg, Obj>::cameraInfoCallback(
   const sensor_msgs::msg::CameraInfo::ConstSharedPtr input_camera_info_msg,
   const std::size_t camera_id)
 {
+  const auto itr = camera_info_map_.find(camera_id);
+  if (
+    itr == camera_info_map_.end() || itr->second.p != input_camera_info_msg->p ||
+    itr->second.header.frame_id != input_camera_info_msg->header.frame_id) {
+    camera_projection_map_.erase(camera_id);
+  }
   camera_info_map_[camera_id] = *input_camera_info_msg;
 }
 
+template <class Msg, class Obj>
+std::optional<Eigen::Matrix4f> FusionNode<Msg, Obj>::getCameraProjection(
+  const std::size_t camera_id, const std::string & source_frame_id)
+{
+  const auto itr = camera_projection_map_.find(camera_id);
+  if (itr != camera_projection_map_.end() && itr->second.source_frame_id == source_frame_id) {
+    return itr->second.matrix;
+  }
+
+  // the extrinsics are assumed to be fixed, so TF is looked up only when the cache is dropped
+  const auto & camera_info = camera_info_map_.at(camera_id);
+  const auto transform_stamped_optional = getTransformStamped(
+    tf_buffer_, /*target*/ camera_info.header.frame_id,
+    /*source*/ source_frame_id, camera_info.header.stamp);
+  if (!transform_stamped_optional) {
+    return std::nullopt;
+  }
+  const Eigen::Matrix4d transform =
+    transformToEigen(transform_stamped_optional.value().transform).matrix();
+  Eigen::Matrix<double, 3, 4> intrinsic;
+  intrinsic << camera_info.p.at(0), camera_info.p.at(1), camera_info.p.at(2), camera_info.p.at(3),
+    camera_info.p.at(4), camera_info.p.at(5), camera_info.p.at(6), camera_info.p.at(7),
+    camera_info.p.at(8), camera_info.p.at(9), camera_info.p.at(10), camera_info.p.at(11);
+
+  Eigen::Matrix4d projection;
+  projection.topRows<3>() = intrinsic * transform;
+  projection.row(3) = transform.row(2);
+  auto & camera_projection = camera_projection_map_[camera_id];
+  camera_projection.source_frame_id = source_frame_id;
+  camera_projection.matrix = projection.cast<float>();
+  return camera_projection.matrix;
+}
+
 template <class Msg, class Obj>
 void FusionNode<Msg, Obj>::preprocess(Msg & ouput_msg __attribute__((unused)))
 {
@@ -157,67 +158,125 @@ void FusionNode<Msg, Obj>::preprocess(Msg & ouput_msg __attribute__((unused)))
 }
 
 template <class Msg, class Obj>
-void FusionNode<Msg, Obj>::fusionCallback(
-  typename Msg::ConstSharedPtr input_msg, DetectedObjectsWithFeature::ConstSharedPtr input_roi0_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi1_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi2_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi3_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi4_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi5_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi6_msg,
-  DetectedObjectsWithFeature::ConstSharedPtr input_roi7_msg)
+void FusionNode<Msg, Obj>::subCallback(const typename Msg::ConstSharedPtr input_msg)
 {
-  Msg output_msg = *input_msg;
-
-  preprocess(output_msg);
-
-  for (std::size_t image_id = 0; image_id < rois_subs_.size(); ++image_id) {
-    DetectedObjectsWithFeature::ConstSharedPtr input_roi_msg;
-    switch (image_id) {
-      case 0:
-        input_roi_msg = input_roi0_msg;
-        break;
-      case 1:
-        input_roi_msg = input_roi1_msg;
-        break;
-      case 2:
-        input_roi_msg = input_roi2_msg;
-        break;
-      case 3:
-        input_roi_msg = input_roi3_msg;
-        break;
-      case 4:
-        input_roi_msg = input_roi4_msg;
-        break;
-      case 5:
-        input_roi_msg = input_roi5_msg;
-        break;
-      case 6:
-        input_roi_msg = input_roi6_msg;
-        break;
-      case 7:
-        input_roi_msg = input_roi7_msg;
-        break;
-      default:
-        RCLCPP_ERROR(this->get_logger(), "invalid image id. id is %zu", image_id);
-        return;
-    }
+  // the previous frame is published as it is if it is still waiting for some cameras
+  if (input_msg_) {
+    finishFusion();
+  }
+
+  input_msg_ = input_msg;
+  input_arrival_time_ = this->now();
+  output_msg_ = *input_msg;
+  std::fill(is_fused_.begin(), is_fused_.end(), false);
 
-    if (camera_info_map_.find(image_id) == camera_info_map_.end()) {
-      RCLCPP_WARN(this->get_logger(), "no camera info. id is %zu", image_id);
+  preprocess(output_msg_);
+
+  const rclcpp::Time input_stamp(input_msg->header.stamp);
+  for (std::size_t roi_i = 0; roi_i < rois_number_; ++roi_i) {
+    // the closest rois within match_threshold_ms_, the older ones can never be matched again
+    auto & cached_rois = cached_rois_.at(roi_i);
+    auto matched_itr = cached_rois.end();
+    double min_interval_ms = match_threshold_ms_;
+    for (auto itr = cached_rois.begin(); itr != cached_rois.end(); ++itr) {
+      const double interval_ms =
+        std::abs((rclcpp::Time(itr->msg->header.stamp) - input_stamp).seconds()) * 1e3;
+      if (interval_ms <= min_interval_ms) {
+        matched_itr = itr;
+        min_interval_ms = interval_ms;
+      }
+    }
+    if (matched_itr == cached_rois.end()) {
       continue;
     }
-    if (debugger_) {
-      debugger_->clear();
+    const auto matched_roi = *matched_itr;
+    cached_rois.erase(cached_rois.begin(), matched_itr + 1);
+    fuseRoi(roi_i, *matched_roi.msg, matched_roi.arrival_time);
+  }
+
+  if (std::all_of(is_fused_.begin(), is_fused_.end(), [](const bool b) { return b; })) {
+    finishFusion();
+  } else {
+    timer_->reset();
+  }
+}
+
+template <class Msg, class Obj>
+void FusionNode<Msg, Obj>::roiCallback(
+  const DetectedObjectsWithFeature::ConstSharedPtr input_roi_msg, const std::size_t roi_i)
+{
+  const auto arrival_time = this->now();
+  if (input_msg_ && !is_fused_.at(roi_i)) {
+    const double interval_ms = std::abs(
+      (rclcpp::Time(input_roi_msg->header.stamp) - rclcpp::Time(input_msg_->header.stamp))
+        .seconds() *
+      1e3);
+    if (interval_ms <= match_threshold_ms_) {
+      fuseRoi(roi_i, *input_roi_msg, arrival_time);
+      if (std::all_of(is_fused_.begin(), is_fused_.end(), [](const bool b) { return b; })) {
+        finishFusion();
+      }
+      return;
     }
+  }
+
+  // the oldest rois are dropped when the buffer is full
+  cached_rois_.at(roi_i).push_back(CachedRoi{arrival_time, input_roi_msg});
+}
+
+template <class Msg, class Obj>
+void FusionNode<Msg, Obj>::timerCallback()
+{
+  timer_->cancel();
+  if (input_msg_) {
+    finishFusion();
+  }
+}
+
+template <class Msg, class Obj>
+void FusionNode<Msg, Obj>::fuseRoi(
+  const std::size_t roi_i, const DetectedObjectsWithFeature & input_roi_msg,
+  const rclcpp::Time & arrival_time)
+{
+  is_fused_.at(roi_i) = true;
+
+  // negative if the rois arrived before the input
+  const double arrival_latency_ms = (arrival_time - input_arrival_time_).seconds() * 1e3;
+  debug_publisher_->publish<tier4_debug_msgs::msg::Float64Stamped>(
+    "debug/arrival_latency_ms/camera" + std::to_string(roi_i), arrival_latency_ms);
+
+  if (camera_info_map_.find(roi_i) == camera_info_map_.end()) {
+    RCLCPP_WARN(this->get_logger(), "no camera info. id is %zu", roi_i);
+    return;
+  }
+  if (debugger_) {
+    debugger_->clear();
+  }
 
-    fuseOnSingleImage(
-      *input_msg, image_id, *input_roi_msg, camera_info_map_.at(image_id), output_msg);
+  fuseOnSingleImage(*input_msg_, roi_i, input_roi_msg, camera_info_map_.at(roi_i), output_msg_);
+}
+
+template <class Msg, class Obj>
+void FusionNode<Msg, Obj>::finishFusion()
+{
+  timer_->cancel();
+
+  const auto skipped_camera_num = static_cast<std::size_t>(
+    std::count(is_fused_.begin(), is_fused_.end(), false));
+  if (skipped_camera_num > 0) {
+    RCLCPP_WARN_THROTTLE(
+      this->get_logger(), *this->get_clock(), 5000,
+      "%zu cameras were skipped, their rois did not arrive within %.1f ms", skipped_camera_num,
+      timeout_ms_);
   }
+  debug_publisher_->publish<tier4_debug_msgs::msg::Float64Stamped>(
+    "debug/skipped_camera_num", static_cast<double>(skipped_camera_num));
+
+  postprocess(output_msg_);
 
-  postprocess(output_msg);
+  publish(output_msg_);
 
-  publish(output_msg);
+  input_msg_.reset();
 }
 
 template <class Msg, class Obj>
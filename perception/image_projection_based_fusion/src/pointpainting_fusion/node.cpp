@@ -69,7 +69,8 @@ PointpaintingFusionNode::PointpaintingFusionNode(const rclcpp::NodeOptions & opt
   centerpoint::NetworkParam encoder_param(encoder_onnx_path, encoder_engine_path, trt_precision);
   centerpoint::NetworkParam head_param(head_onnx_path, head_engine_path, trt_precision);
   centerpoint::DensificationParam densification_param(
-    densification_world_frame_id, densification_num_past_frames);
+    densification_world_frame_id, densification_num_past_frames,
+    /*feature_field_names*/ {"CAR", "PEDESTRIAN", "BICYCLE"});
   centerpoint::CenterPointConfig config(
     class_names_.size(), point_feature_size, max_voxel_size, pointcloud_range, voxel_size,
     downsample_factor, encoder_in_feature_size, score_threshold, circle_nms_dist_threshold,
@@ -80,7 +81,10 @@ PointpaintingFusionNode::PointpaintingFusionNode(const rclcpp::NodeOptions & opt
     encoder_param, head_param, densification_param, config);
 
   // sub and pub
-  sub_.subscribe(this, "~/input/pointcloud", rmw_qos_profile_sensor_data);
+  std::function<void(const sensor_msgs::msg::PointCloud2::ConstSharedPtr msg)> sub_callback =
+    std::bind(&PointpaintingFusionNode::subCallback, this, std::placeholders::_1);
+  sub_ = this->create_subscription<sensor_msgs::msg::PointCloud2>(
+    "~/input/pointcloud", rclcpp::SensorDataQoS(), sub_callback);
   obj_pub_ptr_ = this->create_publisher<DetectedObjects>("~/output/objects", rclcpp::QoS{1});
 }
 
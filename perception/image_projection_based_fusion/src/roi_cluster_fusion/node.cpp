@@ -20,13 +20,8 @@
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 
-#ifdef ROS_DISTRO_GALACTIC
-#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
-#include <tf2_sensor_msgs/tf2_sensor_msgs.h>
-#else
-#include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
-#include <tf2_sensor_msgs/tf2_sensor_msgs.hpp>
-#endif
+#include <map>
+#include <vector>
 
 namespace image_projection_based_fusion
 {
@@ -62,98 +57,74 @@ void RoiClusterFusionNode::fuseOnSingleImage(
   std::vector<sensor_msgs::msg::RegionOfInterest> debug_pointcloud_rois;
   std::vector<Eigen::Vector2d> debug_image_points;
 
-  Eigen::Matrix4d projection;
-  projection << camera_info.p.at(0), camera_info.p.at(1), camera_info.p.at(2), camera_info.p.at(3),
-    camera_info.p.at(4), camera_info.p.at(5), camera_info.p.at(6), camera_info.p.at(7),
-    camera_info.p.at(8), camera_info.p.at(9), camera_info.p.at(10), camera_info.p.at(11);
-
-  // get transform from cluster frame id to camera optical frame id
-  geometry_msgs::msg::TransformStamped transform_stamped;
-  {
-    const auto transform_stamped_optional = getTransformStamped(
-      tf_buffer_, /*target*/ camera_info.header.frame_id,
-      /*source*/ input_cluster_msg.header.frame_id, camera_info.header.stamp);
-    if (!transform_stamped_optional) {
-      return;
-    }
-    transform_stamped = transform_stamped_optional.value();
+  // projection from cluster frame id to camera image
+  const auto projection_optional =
+    getCameraProjection(image_id, input_cluster_msg.header.frame_id);
+  if (!projection_optional) {
+    return;
   }
-
-  std::map<std::size_t, RegionOfInterest> m_cluster_roi;
-  for (std::size_t i = 0; i < input_cluster_msg.feature_objects.size(); ++i) {
-    if (input_cluster_msg.feature_objects.at(i).feature.cluster.data.empty()) {
+  const Eigen::Matrix4f & projection = projection_optional.value();
+
+  // project the clusters in parallel, each one is only reduced to its bounding box on the image
+  const int cluster_num = static_cast<int>(input_cluster_msg.feature_objects.size());
+  std::vector<RegionOfInterest> cluster_rois(cluster_num);
+  std::vector<char> is_projected(cluster_num, false);
+  std::vector<std::vector<Eigen::Vector2d>> cluster_image_points(debugger_ ? cluster_num : 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = 0; i < cluster_num; ++i) {
+    const auto & feature_object = input_cluster_msg.feature_objects.at(i);
+    if (feature_object.feature.cluster.data.empty()) {
       continue;
     }
 
     // filter point out of scope
-    if (debugger_ && out_of_scope(input_cluster_msg.feature_objects.at(i))) {
+    if (debugger_ && out_of_scope(feature_object)) {
       continue;
     }
 
-    sensor_msgs::msg::PointCloud2 transformed_cluster;
-    tf2::doTransform(
-      input_cluster_msg.feature_objects.at(i).feature.cluster, transformed_cluster,
-      transform_stamped);
-
-    int min_x(camera_info.width), min_y(camera_info.height), max_x(0), max_y(0);
-    std::vector<Eigen::Vector2d> projected_points;
-    projected_points.reserve(transformed_cluster.data.size());
-    for (sensor_msgs::PointCloud2ConstIterator<float> iter_x(transformed_cluster, "x"),
-         iter_y(transformed_cluster, "y"), iter_z(transformed_cluster, "z");
-         iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_z) {
-      if (*iter_z <= 0.0) {
-        continue;
-      }
+    is_projected.at(i) = calcProjectedRoi(
+      feature_object.feature.cluster, projection, static_cast<int>(camera_info.width),
+      static_cast<int>(camera_info.height), cluster_rois.at(i),
+      debugger_ ? &cluster_image_points.at(i) : nullptr);
+  }
 
-      Eigen::Vector4d projected_point =
-        projection * Eigen::Vector4d(*iter_x, *iter_y, *iter_z, 1.0);
-      Eigen::Vector2d normalized_projected_point = Eigen::Vector2d(
-        projected_point.x() / projected_point.z(), projected_point.y() / projected_point.z());
-      if (
-        0 <= static_cast<int>(normalized_projected_point.x()) &&
-        static_cast<int>(normalized_projected_point.x()) <=
-          static_cast<int>(camera_info.width) - 1 &&
-        0 <= static_cast<int>(normalized_projected_point.y()) &&
-        static_cast<int>(normalized_projected_point.y()) <=
-          static_cast<int>(camera_info.height) - 1) {
-        min_x = std::min(static_cast<int>(normalized_projected_point.x()), min_x);
-        min_y = std::min(static_cast<int>(normalized_projected_point.y()), min_y);
-        max_x = std::max(static_cast<int>(normalized_projected_point.x()), max_x);
-        max_y = std::max(static_cast<int>(normalized_projected_point.y()), max_y);
-        projected_points.push_back(normalized_projected_point);
-        debug_image_points.push_back(normalized_projected_point);
-      }
+  std::map<std::size_t, RegionOfInterest> m_cluster_roi;
+  roi_index_.clear();
+  for (int i = 0; i < cluster_num; ++i) {
+    if (debugger_) {
+      debug_image_points.insert(
+        debug_image_points.end(), cluster_image_points.at(i).begin(),
+        cluster_image_points.at(i).end());
     }
-    if (projected_points.empty()) {
+    if (!is_projected.at(i)) {
       continue;
     }
-
-    sensor_msgs::msg::RegionOfInterest roi;
-    // roi.do_rectify = m_camera_info_.at(id).do_rectify;
-    roi.x_offset = min_x;
-    roi.y_offset = min_y;
-    roi.width = max_x - min_x;
-    roi.height = max_y - min_y;
-    m_cluster_roi.insert(std::make_pair(i, roi));
-    debug_pointcloud_rois.push_back(roi);
+    m_cluster_roi.insert(std::make_pair(i, cluster_rois.at(i)));
+    roi_index_.insert(i, cluster_rois.at(i));
+    debug_pointcloud_rois.push_back(cluster_rois.at(i));
   }
 
   for (const auto & feature_obj : input_roi_msg.feature_objects) {
     int index = 0;
     double max_iou = 0.0;
-    for (const auto & cluster_map : m_cluster_roi) {
+    // the IoUs are 0 unless the rois overlap, and candidates are in ascending order as in the map
+    roi_index_.query(feature_obj.feature.roi, candidate_indices_);
+    for (const auto candidate_index : candidate_indices_) {
+      const auto & cluster_roi = m_cluster_roi.at(candidate_index);
       double iou(0.0), iou_x(0.0), iou_y(0.0);
       if (use_iou_) {
-        iou = calcIoU(cluster_map.second, feature_obj.feature.roi);
+        iou = calcIoU(cluster_roi, feature_obj.feature.roi);
       }
       if (use_iou_x_) {
-        iou_x = calcIoUX(cluster_map.second, feature_obj.feature.roi);
+        iou_x = calcIoUX(cluster_roi, feature_obj.feature.roi);
       }
       if (use_iou_y_) {
-        iou_y = calcIoUY(cluster_map.second, feature_obj.feature.roi);
+        iou_y = calcIoUY(cluster_roi, feature_obj.feature.roi);
       }
       if (max_iou < iou + iou_x + iou_y) {
-        index = cluster_map.first;
+        index = candidate_index;
         max_iou = iou + iou_x + iou_y;
       }
     }
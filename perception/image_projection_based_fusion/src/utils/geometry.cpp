@@ -16,6 +16,32 @@
 
 #include <rclcpp/rclcpp.hpp>
 
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+constexpr std::size_t projection_batch_size = 8;
+
+bool findFloat32Field(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & name, std::uint32_t & offset)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == name && field.datatype == sensor_msgs::msg::PointField::FLOAT32) {
+      offset = field.offset;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
 namespace image_projection_based_fusion
 {
 
@@ -162,4 +188,209 @@ void transformPoints(
   }
 }
 
+bool calcProjectedRoi(
+  const sensor_msgs::msg::PointCloud2 & cluster, const Eigen::Matrix4f & projection,
+  const int image_width, const int image_height, sensor_msgs::msg::RegionOfInterest & roi,
+  std::vector<Eigen::Vector2d> * projected_points)
+{
+  std::uint32_t offset_x, offset_y, offset_z;
+  if (
+    !findFloat32Field(cluster, "x", offset_x) || !findFloat32Field(cluster, "y", offset_y) ||
+    !findFloat32Field(cluster, "z", offset_z)) {
+    return false;
+  }
+  const std::size_t point_num = static_cast<std::size_t>(cluster.width) * cluster.height;
+  if (point_num == 0 || cluster.data.size() < point_num * cluster.point_step) {
+    return false;
+  }
+
+  // 0 <= static_cast<int>(u) <= image_width - 1 is equivalent to -1 < u < image_width
+  const float width = static_cast<float>(image_width);
+  const float height = static_cast<float>(image_height);
+  const float max_value = std::numeric_limits<float>::max();
+  const float lowest_value = std::numeric_limits<float>::lowest();
+  alignas(32) float x[projection_batch_size], y[projection_batch_size], z[projection_batch_size];
+  alignas(32) float u[projection_batch_size], v[projection_batch_size];
+  alignas(32) float min_u[projection_batch_size], min_v[projection_batch_size];
+  alignas(32) float max_u[projection_batch_size], max_v[projection_batch_size];
+  std::fill(min_u, min_u + projection_batch_size, max_value);
+  std::fill(min_v, min_v + projection_batch_size, max_value);
+  std::fill(max_u, max_u + projection_batch_size, lowest_value);
+  std::fill(max_v, max_v + projection_batch_size, lowest_value);
+  const auto & m = projection;
+
+#if defined(__AVX__)
+  const auto row = [&m](const int r, const __m256 px, const __m256 py, const __m256 pz) {
+    return _mm256_add_ps(
+      _mm256_add_ps(
+        _mm256_mul_ps(_mm256_set1_ps(m(r, 0)), px), _mm256_mul_ps(_mm256_set1_ps(m(r, 1)), py)),
+      _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m(r, 2)), pz), _mm256_set1_ps(m(r, 3))));
+  };
+  __m256 min_u_v = _mm256_load_ps(min_u);
+  __m256 min_v_v = _mm256_load_ps(min_v);
+  __m256 max_u_v = _mm256_load_ps(max_u);
+  __m256 max_v_v = _mm256_load_ps(max_v);
+#elif defined(__SSE2__)
+  const auto row = [&m](const int r, const __m128 px, const __m128 py, const __m128 pz) {
+    return _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m(r, 0)), px), _mm_mul_ps(_mm_set1_ps(m(r, 1)), py)),
+      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m(r, 2)), pz), _mm_set1_ps(m(r, 3))));
+  };
+  // SSE2 has no blend
+  const auto select = [](const __m128 mask, const __m128 a, const __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  };
+#endif
+
+  for (std::size_t i = 0; i < point_num; i += projection_batch_size) {
+    // the last batch is padded with its last point, which doesn't change the bounding box
+    const std::size_t batch_point_num = std::min(projection_batch_size, point_num - i);
+    for (std::size_t k = 0; k < projection_batch_size; ++k) {
+      const auto * point =
+        &cluster.data[(i + std::min(k, batch_point_num - 1)) * cluster.point_step];
+      std::memcpy(&x[k], point + offset_x, sizeof(float));
+      std::memcpy(&y[k], point + offset_y, sizeof(float));
+      std::memcpy(&z[k], point + offset_z, sizeof(float));
+    }
+
+    int mask = 0;
+#if defined(__AVX__)
+    {
+      const __m256 px = _mm256_load_ps(x);
+      const __m256 py = _mm256_load_ps(y);
+      const __m256 pz = _mm256_load_ps(z);
+      const __m256 w = row(2, px, py, pz);
+      const __m256 pu = _mm256_div_ps(row(0, px, py, pz), w);
+      const __m256 pv = _mm256_div_ps(row(1, px, py, pz), w);
+      const __m256 minus_one = _mm256_set1_ps(-1.0f);
+      const __m256 valid = _mm256_and_ps(
+        _mm256_and_ps(
+          _mm256_cmp_ps(row(3, px, py, pz), _mm256_setzero_ps(), _CMP_GT_OQ),
+          _mm256_and_ps(
+            _mm256_cmp_ps(pu, minus_one, _CMP_GT_OQ),
+            _mm256_cmp_ps(pu, _mm256_set1_ps(width), _CMP_LT_OQ))),
+        _mm256_and_ps(
+          _mm256_cmp_ps(pv, minus_one, _CMP_GT_OQ),
+          _mm256_cmp_ps(pv, _mm256_set1_ps(height), _CMP_LT_OQ)));
+      mask = _mm256_movemask_ps(valid);
+      min_u_v = _mm256_min_ps(min_u_v, _mm256_blendv_ps(_mm256_set1_ps(max_value), pu, valid));
+      min_v_v = _mm256_min_ps(min_v_v, _mm256_blendv_ps(_mm256_set1_ps(max_value), pv, valid));
+      max_u_v = _mm256_max_ps(max_u_v, _mm256_blendv_ps(_mm256_set1_ps(lowest_value), pu, valid));
+      max_v_v = _mm256_max_ps(max_v_v, _mm256_blendv_ps(_mm256_set1_ps(lowest_value), pv, valid));
+      _mm256_store_ps(u, pu);
+      _mm256_store_ps(v, pv);
+    }
+#elif defined(__SSE2__)
+    for (std::size_t k = 0; k < projection_batch_size; k += 4) {
+      const __m128 px = _mm_load_ps(x + k);
+      const __m128 py = _mm_load_ps(y + k);
+      const __m128 pz = _mm_load_ps(z + k);
+      const __m128 w = row(2, px, py, pz);
+      const __m128 pu = _mm_div_ps(row(0, px, py, pz), w);
+      const __m128 pv = _mm_div_ps(row(1, px, py, pz), w);
+      const __m128 minus_one = _mm_set1_ps(-1.0f);
+      const __m128 valid = _mm_and_ps(
+        _mm_and_ps(
+          _mm_cmpgt_ps(row(3, px, py, pz), _mm_setzero_ps()),
+          _mm_and_ps(_mm_cmpgt_ps(pu, minus_one), _mm_cmplt_ps(pu, _mm_set1_ps(width)))),
+        _mm_and_ps(_mm_cmpgt_ps(pv, minus_one), _mm_cmplt_ps(pv, _mm_set1_ps(height))));
+      mask |= _mm_movemask_ps(valid) << k;
+      _mm_store_ps(
+        min_u + k,
+        _mm_min_ps(_mm_load_ps(min_u + k), select(valid, pu, _mm_set1_ps(max_value))));
+      _mm_store_ps(
+        min_v + k,
+        _mm_min_ps(_mm_load_ps(min_v + k), select(valid, pv, _mm_set1_ps(max_value))));
+      _mm_store_ps(
+        max_u + k,
+        _mm_max_ps(_mm_load_ps(max_u + k), select(valid, pu, _mm_set1_ps(lowest_value))));
+      _mm_store_ps(
+        max_v + k,
+        _mm_max_ps(_mm_load_ps(max_v + k), select(valid, pv, _mm_set1_ps(lowest_value))));
+      _mm_store_ps(u + k, pu);
+      _mm_store_ps(v + k, pv);
+    }
+#else
+    for (std::size_t k = 0; k < projection_batch_size; ++k) {
+      const Eigen::Vector4f p = m * Eigen::Vector4f(x[k], y[k], z[k], 1.0f);
+      u[k] = p.x() / p.z();
+      v[k] = p.y() / p.z();
+      if (
+        p.w() > 0.0f && -1.0f < u[k] && u[k] < width && -1.0f < v[k] && v[k] < height) {
+        mask |= 1 << k;
+        min_u[k] = std::min(min_u[k], u[k]);
+        min_v[k] = std::min(min_v[k], v[k]);
+        max_u[k] = std::max(max_u[k], u[k]);
+        max_v[k] = std::max(max_v[k], v[k]);
+      }
+    }
+#endif
+
+    if (projected_points) {
+      for (std::size_t k = 0; k < batch_point_num; ++k) {
+        if (mask & (1 << k)) {
+          projected_points->emplace_back(u[k], v[k]);
+        }
+      }
+    }
+  }
+
+#if defined(__AVX__)
+  _mm256_store_ps(min_u, min_u_v);
+  _mm256_store_ps(min_v, min_v_v);
+  _mm256_store_ps(max_u, max_u_v);
+  _mm256_store_ps(max_v, max_v_v);
+#endif
+  const float roi_min_u = *std::min_element(min_u, min_u + projection_batch_size);
+  const float roi_min_v = *std::min_element(min_v, min_v + projection_batch_size);
+  const float roi_max_u = *std::max_element(max_u, max_u + projection_batch_size);
+  const float roi_max_v = *std::max_element(max_v, max_v + projection_batch_size);
+  if (roi_max_u < roi_min_u) {
+    return false;
+  }
+
+  // truncation is monotonic, so the bounding box of the truncated pixels is the truncated one
+  roi.x_offset = static_cast<int>(roi_min_u);
+  roi.y_offset = static_cast<int>(roi_min_v);
+  roi.width = static_cast<int>(roi_max_u) - static_cast<int>(roi_min_u);
+  roi.height = static_cast<int>(roi_max_v) - static_cast<int>(roi_min_v);
+  return true;
+}
+
+void RoiColumnIndex::clear()
+{
+  for (auto & column : columns_) {
+    column.clear();
+  }
+}
+
+void RoiColumnIndex::insert(const std::size_t id, const sensor_msgs::msg::RegionOfInterest & roi)
+{
+  const std::size_t first = roi.x_offset / column_width_;
+  const std::size_t last = (static_cast<std::uint64_t>(roi.x_offset) + roi.width) / column_width_;
+  if (columns_.size() <= last) {
+    columns_.resize(last + 1);
+  }
+  for (std::size_t i = first; i <= last; ++i) {
+    columns_[i].push_back(id);
+  }
+}
+
+void RoiColumnIndex::query(
+  const sensor_msgs::msg::RegionOfInterest & roi, std::vector<std::size_t> & ids) const
+{
+  ids.clear();
+  const std::size_t first = roi.x_offset / column_width_;
+  if (columns_.size() <= first) {
+    return;
+  }
+  const std::size_t last = std::min<std::size_t>(
+    (static_cast<std::uint64_t>(roi.x_offset) + roi.width) / column_width_, columns_.size() - 1);
+  for (std::size_t i = first; i <= last; ++i) {
+    ids.insert(ids.end(), columns_[i].begin(), columns_[i].end());
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
 }  // namespace image_projection_based_fusion
@@ -46,7 +46,6 @@
 #ifndef LIDAR_APOLLO_INSTANCE_SEGMENTATION__CLUSTER2D_HPP_
 #define LIDAR_APOLLO_INSTANCE_SEGMENTATION__CLUSTER2D_HPP_
 
-#include "disjoint_set.hpp"
 #include "util.hpp"
 
 #include <std_msgs/msg/header.hpp>
@@ -57,6 +56,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -98,9 +98,6 @@ public:
     const pcl::PointCloud<pcl::PointXYZI>::Ptr & pc_ptr, const pcl::PointIndices & valid_indices,
     float objectness_thresh, bool use_all_grids_for_clustering);
 
-  void filter(const std::shared_ptr<float> & inferred_data);
-  void classify(const std::shared_ptr<float> & inferred_data);
-
   void getObjects(
     const float confidence_thresh, const float height_thresh, const int min_pts_num,
     tier4_perception_msgs::msg::DetectedObjectsWithFeature & objects,
@@ -124,29 +121,16 @@ private:
   pcl::PointCloud<pcl::PointXYZI>::Ptr pc_ptr_;
   const std::vector<int> * valid_indices_in_pc_ = nullptr;
 
-  struct Node
-  {
-    Node * center_node;
-    Node * parent;
-    char node_rank;
-    char traversed;
-    bool is_center;
-    bool is_object;
-    int point_num;
-    int obstacle_id;
-
-    Node()
-    {
-      center_node = nullptr;
-      parent = nullptr;
-      node_rank = 0;
-      traversed = 0;
-      is_center = false;
-      is_object = false;
-      point_num = 0;
-      obstacle_id = -1;
-    }
-  };
+  // state of every grid cell, indexed by RowCol2Grid() and kept across frames
+  std::vector<int> point_num_;
+  std::vector<int> center_grid_;
+  std::vector<int> parent_grid_;
+  std::vector<int> root_obstacle_id_;
+  std::vector<uint8_t> is_object_;
+  std::vector<uint8_t> is_center_;
+  // 0: not traversed, 1: traversed, 2: on the path being traversed
+  std::vector<uint8_t> traversed_;
+  std::vector<int> traverse_path_;
 
   inline bool IsValidRowCol(int row, int col) const { return IsValidRow(row) && IsValidCol(col); }
 
@@ -156,7 +140,9 @@ private:
 
   inline int RowCol2Grid(int row, int col) const { return row * cols_ + col; }
 
-  void traverse(Node * x);
+  void traverse(int grid);
+  int findRoot(int grid);
+  void unite(int grid1, int grid2);
 };
 
 #endif  // LIDAR_APOLLO_INSTANCE_SEGMENTATION__CLUSTER2D_HPP_
@@ -50,6 +50,8 @@ private:
   std::unique_ptr<Tn::trtNet> net_ptr_;
   std::shared_ptr<Cluster2D> cluster2d_;
   std::shared_ptr<FeatureGenerator> feature_generator_;
+  // network output, allocated once
+  std::shared_ptr<float> inferred_data_;
   float score_threshold_;
 
   tf2_ros::Buffer tf_buffer_;
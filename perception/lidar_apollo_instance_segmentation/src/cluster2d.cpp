@@ -56,6 +56,9 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 #endif
 
+#include <algorithm>
+#include <cmath>
+
 geometry_msgs::msg::Quaternion getQuaternionFromRPY(const double r, const double p, const double y)
 {
   tf2::Quaternion q;
@@ -76,28 +79,58 @@ Cluster2D::Cluster2D(const int rows, const int cols, const float range)
   id_img_.assign(siz_, -1);
   pc_ptr_.reset();
   valid_indices_in_pc_ = nullptr;
+
+  point_num_.assign(siz_, 0);
+  center_grid_.assign(siz_, 0);
+  parent_grid_.assign(siz_, 0);
+  root_obstacle_id_.assign(siz_, -1);
+  is_object_.assign(siz_, 0);
+  is_center_.assign(siz_, 0);
+  traversed_.assign(siz_, 0);
 }
 
-void Cluster2D::traverse(Node * x)
+void Cluster2D::traverse(int grid)
 {
-  std::vector<Node *> p;
-  p.clear();
+  traverse_path_.clear();
 
-  while (x->traversed == 0) {
-    p.push_back(x);
-    x->traversed = 2;
-    x = x->center_node;
+  while (traversed_[grid] == 0) {
+    traverse_path_.push_back(grid);
+    traversed_[grid] = 2;
+    grid = center_grid_[grid];
   }
-  if (x->traversed == 2) {
-    for (int i = static_cast<int>(p.size()) - 1; i >= 0 && p[i] != x; i--) {
-      p[i]->is_center = true;
+  if (traversed_[grid] == 2) {
+    // the path ends in a cycle, whose cells are the centers
+    for (int i = static_cast<int>(traverse_path_.size()) - 1;
+         i >= 0 && traverse_path_[i] != grid; i--) {
+      is_center_[traverse_path_[i]] = 1;
     }
-    x->is_center = true;
+    is_center_[grid] = 1;
+  }
+  const int root = parent_grid_[grid];
+  for (const int path_grid : traverse_path_) {
+    traversed_[path_grid] = 1;
+    parent_grid_[path_grid] = root;
+  }
+}
+
+int Cluster2D::findRoot(int grid)
+{
+  // path halving
+  while (parent_grid_[grid] != grid) {
+    parent_grid_[grid] = parent_grid_[parent_grid_[grid]];
+    grid = parent_grid_[grid];
   }
-  for (size_t i = 0; i < p.size(); i++) {
-    Node * y = p[i];
-    y->traversed = 1;
-    y->parent = x->parent;
+  return grid;
+}
+
+void Cluster2D::unite(int grid1, int grid2)
+{
+  const int root1 = findRoot(grid1);
+  const int root2 = findRoot(grid2);
+  if (root1 < root2) {
+    parent_grid_[root2] = root1;
+  } else if (root2 < root1) {
+    parent_grid_[root1] = root2;
   }
 }
 
@@ -109,13 +142,18 @@ void Cluster2D::cluster(
   const float * category_pt_data = inferred_data.get();
   const float * instance_pt_x_data = inferred_data.get() + siz_;
   const float * instance_pt_y_data = inferred_data.get() + siz_ * 2;
+  const float * confidence_pt_data = inferred_data.get() + siz_ * 3;
+  const float * classify_pt_data = inferred_data.get() + siz_ * 4;
+  const float * heading_pt_x_data = inferred_data.get() + siz_ * 9;
+  const float * heading_pt_y_data = inferred_data.get() + siz_ * 10;
+  const float * height_pt_data = inferred_data.get() + siz_ * 11;
+  constexpr int num_classes = 5;
 
   pc_ptr_ = pc_ptr;
 
-  std::vector<std::vector<Node>> nodes(rows_, std::vector<Node>(cols_, Node()));
-
   valid_indices_in_pc_ = &(valid_indices.indices);
   point2grid_.assign(valid_indices_in_pc_->size(), -1);
+  std::fill(point_num_.begin(), point_num_.end(), 0);
 
   for (size_t i = 0; i < valid_indices_in_pc_->size(); ++i) {
     int point_id = valid_indices_in_pc_->at(i);
@@ -127,123 +165,102 @@ void Cluster2D::cluster(
     int pos_y = F2I(point.x, range_, inv_res_y_);  // row
     if (IsValidRowCol(pos_y, pos_x)) {
       point2grid_[i] = RowCol2Grid(pos_y, pos_x);
-      nodes[pos_y][pos_x].point_num++;
+      point_num_[point2grid_[i]]++;
     }
   }
 
+  // objectness and center of every cell, the rows are independent
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
   for (int row = 0; row < rows_; ++row) {
     for (int col = 0; col < cols_; ++col) {
-      int grid = RowCol2Grid(row, col);
-      Node * node = &nodes[row][col];
-      DisjointSetMakeSet(node);
-      node->is_object = (use_all_grids_for_clustering || nodes[row][col].point_num > 0) &&
-                        (*(category_pt_data + grid) >= objectness_thresh);
+      const int grid = RowCol2Grid(row, col);
+      is_object_[grid] = (use_all_grids_for_clustering || point_num_[grid] > 0) &&
+                         (category_pt_data[grid] >= objectness_thresh);
       int center_row = std::round(row + instance_pt_x_data[grid] * scale_);
       int center_col = std::round(col + instance_pt_y_data[grid] * scale_);
       center_row = std::min(std::max(center_row, 0), rows_ - 1);
       center_col = std::min(std::max(center_col, 0), cols_ - 1);
-      node->center_node = &nodes[center_row][center_col];
+      center_grid_[grid] = RowCol2Grid(center_row, center_col);
+      parent_grid_[grid] = grid;
+      root_obstacle_id_[grid] = -1;
+      is_center_[grid] = 0;
+      traversed_[grid] = 0;
     }
   }
 
-  for (int row = 0; row < rows_; ++row) {
-    for (int col = 0; col < cols_; ++col) {
-      Node * node = &nodes[row][col];
-      if (node->is_object && node->traversed == 0) {
-        traverse(node);
-      }
+  for (int grid = 0; grid < siz_; ++grid) {
+    if (is_object_[grid] && traversed_[grid] == 0) {
+      traverse(grid);
     }
   }
 
+  // merge the centers with their right and lower neighbors, which also covers the left and upper
   for (int row = 0; row < rows_; ++row) {
     for (int col = 0; col < cols_; ++col) {
-      Node * node = &nodes[row][col];
-      if (!node->is_center) {
+      const int grid = RowCol2Grid(row, col);
+      if (!is_center_[grid]) {
         continue;
       }
-      for (int row2 = row - 1; row2 <= row + 1; ++row2) {
-        for (int col2 = col - 1; col2 <= col + 1; ++col2) {
-          if ((row2 == row || col2 == col) && IsValidRowCol(row2, col2)) {
-            Node * node2 = &nodes[row2][col2];
-            if (node2->is_center) {
-              DisjointSetUnion(node, node2);
-            }
-          }
-        }
+      if (col + 1 < cols_ && is_center_[grid + 1]) {
+        unite(grid, grid + 1);
+      }
+      if (row + 1 < rows_ && is_center_[grid + cols_]) {
+        unite(grid, grid + cols_);
       }
     }
   }
 
-  int count_obstacles = 0;
+  // assign the object cells to obstacles and accumulate their features in the same pass
+  std::vector<double> scores;
+  std::vector<double> heights;
+  std::vector<double> heading_xs;
+  std::vector<double> heading_ys;
   obstacles_.clear();
-  id_img_.assign(siz_, -1);
-  for (int row = 0; row < rows_; ++row) {
-    for (int col = 0; col < cols_; ++col) {
-      Node * node = &nodes[row][col];
-      if (!node->is_object) {
-        continue;
-      }
-      Node * root = DisjointSetFind(node);
-      if (root->obstacle_id < 0) {
-        root->obstacle_id = count_obstacles++;
-        obstacles_.push_back(Obstacle());
-      }
-      int grid = RowCol2Grid(row, col);
-      id_img_[grid] = root->obstacle_id;
-      obstacles_[root->obstacle_id].grids.push_back(grid);
+  for (int grid = 0; grid < siz_; ++grid) {
+    if (!is_object_[grid]) {
+      id_img_[grid] = -1;
+      continue;
+    }
+    const int root = findRoot(grid);
+    if (root_obstacle_id_[root] < 0) {
+      root_obstacle_id_[root] = static_cast<int>(obstacles_.size());
+      obstacles_.push_back(Obstacle());
+      scores.push_back(0.0);
+      heights.push_back(0.0);
+      heading_xs.push_back(0.0);
+      heading_ys.push_back(0.0);
+    }
+    const int obstacle_id = root_obstacle_id_[root];
+    id_img_[grid] = obstacle_id;
+
+    Obstacle & obs = obstacles_[obstacle_id];
+    obs.grids.push_back(grid);
+    scores[obstacle_id] += static_cast<double>(confidence_pt_data[grid]);
+    heights[obstacle_id] += static_cast<double>(height_pt_data[grid]);
+    heading_xs[obstacle_id] += heading_pt_x_data[grid];
+    heading_ys[obstacle_id] += heading_pt_y_data[grid];
+    for (int k = 0; k < num_classes; k++) {
+      obs.meta_type_probs[k] += classify_pt_data[k * siz_ + grid];
     }
   }
-  filter(inferred_data);
-  classify(inferred_data);
-}
-
-void Cluster2D::filter(const std::shared_ptr<float> & inferred_data)
-{
-  const float * confidence_pt_data = inferred_data.get() + siz_ * 3;
-  const float * heading_pt_x_data = inferred_data.get() + siz_ * 9;
-  const float * heading_pt_y_data = inferred_data.get() + siz_ * 10;
-  const float * height_pt_data = inferred_data.get() + siz_ * 11;
 
   for (size_t obstacle_id = 0; obstacle_id < obstacles_.size(); obstacle_id++) {
-    Obstacle * obs = &obstacles_[obstacle_id];
-    double score = 0.0;
-    double height = 0.0;
-    double vec_x = 0.0;
-    double vec_y = 0.0;
-    for (int grid : obs->grids) {
-      score += static_cast<double>(confidence_pt_data[grid]);
-      height += static_cast<double>(height_pt_data[grid]);
-      vec_x += heading_pt_x_data[grid];
-      vec_y += heading_pt_y_data[grid];
-    }
-    obs->score = score / static_cast<double>(obs->grids.size());
-    obs->height = height / static_cast<double>(obs->grids.size());
-    obs->heading = std::atan2(vec_y, vec_x) * 0.5;
-    obs->cloud_ptr.reset(new pcl::PointCloud<pcl::PointXYZI>);
-  }
-}
+    Obstacle & obs = obstacles_[obstacle_id];
+    const auto num_grids = static_cast<double>(obs.grids.size());
+    obs.score = scores[obstacle_id] / num_grids;
+    obs.height = heights[obstacle_id] / num_grids;
+    obs.heading = std::atan2(heading_ys[obstacle_id], heading_xs[obstacle_id]) * 0.5;
 
-void Cluster2D::classify(const std::shared_ptr<float> & inferred_data)
-{
-  const float * classify_pt_data = inferred_data.get() + siz_ * 4;
-  int num_classes = 5;
-  for (size_t obs_id = 0; obs_id < obstacles_.size(); obs_id++) {
-    Obstacle * obs = &obstacles_[obs_id];
-
-    for (size_t grid_id = 0; grid_id < obs->grids.size(); grid_id++) {
-      int grid = obs->grids[grid_id];
-      for (int k = 0; k < num_classes; k++) {
-        obs->meta_type_probs[k] += classify_pt_data[k * siz_ + grid];
-      }
-    }
     int meta_type_id = 0;
     for (int k = 0; k < num_classes; k++) {
-      obs->meta_type_probs[k] /= obs->grids.size();
-      if (obs->meta_type_probs[k] > obs->meta_type_probs[meta_type_id]) {
+      obs.meta_type_probs[k] /= obs.grids.size();
+      if (obs.meta_type_probs[k] > obs.meta_type_probs[meta_type_id]) {
         meta_type_id = k;
       }
     }
-    obs->meta_type = static_cast<MetaType>(meta_type_id);
+    obs.meta_type = static_cast<MetaType>(meta_type_id);
   }
 }
 
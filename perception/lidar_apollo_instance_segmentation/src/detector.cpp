@@ -88,6 +88,8 @@ LidarApolloInstanceSegmentation::LidarApolloInstanceSegmentation(rclcpp::Node *
     }
   }
   net_ptr_.reset(new Tn::trtNet(engine_file));
+  inferred_data_.reset(
+    new float[net_ptr_->getOutputSize() / sizeof(float)], std::default_delete<float[]>());
 
   // feature map generator: pre process
   feature_generator_ = std::make_shared<FeatureGenerator>(
@@ -152,8 +154,7 @@ bool LidarApolloInstanceSegmentation::detectDynamicObjects(
     feature_generator_->generate(pcl_pointcloud_raw_ptr);
 
   // inference
-  std::shared_ptr<float> inferred_data(new float[net_ptr_->getOutputSize() / sizeof(float)]);
-  net_ptr_->doInference(feature_map_ptr->map_data.data(), inferred_data.get());
+  net_ptr_->doInference(feature_map_ptr->map_data.data(), inferred_data_.get());
 
   // post process
   const float objectness_thresh = 0.5;
@@ -161,7 +162,7 @@ bool LidarApolloInstanceSegmentation::detectDynamicObjects(
   valid_idx.indices.resize(pcl_pointcloud_raw_ptr->size());
   std::iota(valid_idx.indices.begin(), valid_idx.indices.end(), 0);
   cluster2d_->cluster(
-    inferred_data, pcl_pointcloud_raw_ptr, valid_idx, objectness_thresh,
+    inferred_data_, pcl_pointcloud_raw_ptr, valid_idx, objectness_thresh,
     true /*use all grids for clustering*/);
   const float height_thresh = 0.5;
   const int min_pts_num = 3;
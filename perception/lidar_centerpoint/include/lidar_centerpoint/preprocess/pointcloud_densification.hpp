@@ -26,30 +26,40 @@
 #include <list>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace centerpoint
 {
 class DensificationParam
 {
 public:
-  DensificationParam(const std::string & world_frame_id, const unsigned int num_past_frames)
+  DensificationParam(
+    const std::string & world_frame_id, const unsigned int num_past_frames,
+    const std::vector<std::string> & feature_field_names = {})
   : world_frame_id_(std::move(world_frame_id)),
-    pointcloud_cache_size_(num_past_frames + /*current frame*/ 1)
+    pointcloud_cache_size_(num_past_frames + /*current frame*/ 1),
+    feature_field_names_(feature_field_names)
   {
   }
 
   std::string world_frame_id() const { return world_frame_id_; }
   unsigned int pointcloud_cache_size() const { return pointcloud_cache_size_; }
+  // float32 fields cached with x, y and z of every point
+  const std::vector<std::string> & feature_field_names() const { return feature_field_names_; }
 
 private:
   std::string world_frame_id_;
   unsigned int pointcloud_cache_size_{1};
+  std::vector<std::string> feature_field_names_;
 };
 
 struct PointCloudWithTransform
 {
-  sensor_msgs::msg::PointCloud2 pointcloud_msg;
+  // x, y, z and the feature fields of every point in the frame the pointcloud was measured in,
+  // see PointCloudDensification::getPointStep()
+  std::vector<float> points;
   Eigen::Affine3f affine_past2world;
+  double timestamp;
 };
 
 class PointCloudDensification
@@ -62,6 +72,7 @@ public:
 
   double getCurrentTimestamp() const { return current_timestamp_; }
   Eigen::Affine3f getAffineWorldToCurrent() const { return affine_world2current_; }
+  std::size_t getPointStep() const { return 3 + param_.feature_field_names().size(); }
   std::list<PointCloudWithTransform>::iterator getPointCloudCacheIter()
   {
     return pointcloud_cache_.begin();
@@ -72,8 +83,10 @@ public:
   }
 
 private:
-  void enqueue(const sensor_msgs::msg::PointCloud2 & msg, const Eigen::Affine3f & affine);
+  void enqueue(PointCloudWithTransform && pointcloud, const Eigen::Affine3f & affine);
   void dequeue();
+  bool toCompactPoints(
+    const sensor_msgs::msg::PointCloud2 & msg, std::vector<float> & points) const;
 
   DensificationParam param_;
   double current_timestamp_{0.0};
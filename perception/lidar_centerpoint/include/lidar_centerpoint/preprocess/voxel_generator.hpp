@@ -39,12 +39,28 @@ public:
     const sensor_msgs::msg::PointCloud2 & input_pointcloud_msg, const tf2_ros::Buffer & tf_buffer);
 
 protected:
+  /**
+   * @brief add a point of point_feature_size_ floats to its voxel, creating the voxel if needed
+   * @return false if the point is out of range or its voxel can not be created
+   */
+  bool addPointToVoxel(
+    const float * point, std::size_t & voxel_cnt, std::vector<float> & voxels,
+    std::vector<int> & coordinates, std::vector<float> & num_points_per_voxel);
+
+  // forget the voxels of the last pointsToVoxels() so that the grid can be reused
+  void resetVoxelIndices(const std::size_t voxel_cnt);
+
   std::unique_ptr<PointCloudDensification> pd_ptr_{nullptr};
 
   CenterPointConfig config_;
   std::array<float, 6> range_;
   std::array<int, 3> grid_size_;
   std::array<float, 3> recip_voxel_size_;
+
+  // kept across frames, only the cells which got a voxel are reset
+  std::vector<int> coord_to_voxel_idx_;
+  std::vector<int> voxel_to_coord_idx_;
+  std::vector<float> point_;
 };
 
 class VoxelGenerator : public VoxelGeneratorTemplate
@@ -19,6 +19,7 @@
 #include <lidar_centerpoint/preprocess/preprocess_kernel.hpp>
 #include <tier4_autoware_utils/math/constants.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -81,7 +82,7 @@ void CenterPointTRT::initPtr()
 
   // host
   voxels_.resize(voxels_size);
-  coordinates_.resize(coordinates_size);
+  coordinates_.resize(coordinates_size, -1);
   num_points_per_voxel_.resize(config_.max_voxel_size_);
 
   // device
@@ -103,9 +104,12 @@ bool CenterPointTRT::detect(
   const sensor_msgs::msg::PointCloud2 & input_pointcloud_msg, const tf2_ros::Buffer & tf_buffer,
   std::vector<Box3D> & det_boxes3d)
 {
-  std::fill(voxels_.begin(), voxels_.end(), 0);
-  std::fill(coordinates_.begin(), coordinates_.end(), -1);
-  std::fill(num_points_per_voxel_.begin(), num_points_per_voxel_.end(), 0);
+  // only the voxels of the last frame were written
+  std::fill_n(
+    voxels_.begin(), num_voxels_ * config_.max_point_in_voxel_size_ * config_.point_feature_size_,
+    0);
+  std::fill_n(coordinates_.begin(), num_voxels_ * config_.point_dim_size_, -1);
+  std::fill_n(num_points_per_voxel_.begin(), num_voxels_, 0);
   CHECK_CUDA_ERROR(cudaMemsetAsync(
     encoder_in_features_d_.get(), 0, encoder_in_feature_size_ * sizeof(float), stream_));
   CHECK_CUDA_ERROR(
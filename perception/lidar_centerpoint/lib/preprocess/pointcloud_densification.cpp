@@ -25,8 +25,11 @@
 #include <tf2_eigen/tf2_eigen.hpp>
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -72,19 +75,34 @@ bool PointCloudDensification::enqueuePointCloud(
   }
   auto affine_world2current = transformToEigen(transform_world2current.get());
 
-  enqueue(pointcloud_msg, affine_world2current);
+  // reuse the buffer of the oldest pointcloud which is dropped anyway
+  PointCloudWithTransform pointcloud;
+  const bool is_cache_full = pointcloud_cache_.size() >= param_.pointcloud_cache_size();
+  if (is_cache_full) {
+    pointcloud.points = std::move(pointcloud_cache_.back().points);
+  }
+  if (!toCompactPoints(pointcloud_msg, pointcloud.points)) {
+    if (is_cache_full) {
+      // the points are untouched on failure
+      pointcloud_cache_.back().points = std::move(pointcloud.points);
+    }
+    return false;
+  }
+  pointcloud.timestamp = rclcpp::Time(header.stamp).seconds();
+
+  enqueue(std::move(pointcloud), affine_world2current);
   dequeue();
 
   return true;
 }
 
 void PointCloudDensification::enqueue(
-  const sensor_msgs::msg::PointCloud2 & msg, const Eigen::Affine3f & affine_world2current)
+  PointCloudWithTransform && pointcloud, const Eigen::Affine3f & affine_world2current)
 {
   affine_world2current_ = affine_world2current;
-  current_timestamp_ = rclcpp::Time(msg.header.stamp).seconds();
-  PointCloudWithTransform pointcloud = {msg, affine_world2current.inverse()};
-  pointcloud_cache_.push_front(pointcloud);
+  current_timestamp_ = pointcloud.timestamp;
+  pointcloud.affine_past2world = affine_world2current.inverse();
+  pointcloud_cache_.push_front(std::move(pointcloud));
 }
 
 void PointCloudDensification::dequeue()
@@ -94,4 +112,37 @@ void PointCloudDensification::dequeue()
   }
 }
 
+bool PointCloudDensification::toCompactPoints(
+  const sensor_msgs::msg::PointCloud2 & msg, std::vector<float> & points) const
+{
+  std::vector<std::string> field_names = {"x", "y", "z"};
+  field_names.insert(
+    field_names.end(), param_.feature_field_names().begin(), param_.feature_field_names().end());
+
+  std::vector<std::size_t> offsets;
+  for (const auto & field_name : field_names) {
+    const auto field = std::find_if(
+      msg.fields.begin(), msg.fields.end(),
+      [&field_name](const auto & f) { return f.name == field_name; });
+    if (field == msg.fields.end() || field->datatype != sensor_msgs::msg::PointField::FLOAT32) {
+      RCLCPP_WARN_STREAM(
+        rclcpp::get_logger("lidar_centerpoint"), "float32 field " << field_name << " is missing");
+      return false;
+    }
+    offsets.push_back(field->offset);
+  }
+
+  const std::size_t num_points = static_cast<std::size_t>(msg.width) * msg.height;
+  const std::size_t point_step = offsets.size();
+  points.resize(num_points * point_step);
+  for (std::size_t i = 0; i < num_points; ++i) {
+    const uint8_t * src = msg.data.data() + i * msg.point_step;
+    float * dst = points.data() + i * point_step;
+    for (std::size_t fi = 0; fi < point_step; ++fi) {
+      std::memcpy(dst + fi, src + offsets[fi], sizeof(float));
+    }
+  }
+  return true;
+}
+
 }  // namespace centerpoint
@@ -14,7 +14,8 @@
 
 #include "lidar_centerpoint/preprocess/voxel_generator.hpp"
 
-#include <sensor_msgs/point_cloud2_iterator.hpp>
+#include <algorithm>
+#include <array>
 
 namespace centerpoint
 {
@@ -35,6 +36,11 @@ VoxelGeneratorTemplate::VoxelGeneratorTemplate(
   recip_voxel_size_[0] = 1 / config.voxel_size_x_;
   recip_voxel_size_[1] = 1 / config.voxel_size_y_;
   recip_voxel_size_[2] = 1 / config.voxel_size_z_;
+
+  coord_to_voxel_idx_.assign(
+    config.grid_size_z_ * config.grid_size_y_ * config.grid_size_x_, /*no voxel*/ -1);
+  voxel_to_coord_idx_.resize(config.max_voxel_size_);
+  point_.resize(config.point_feature_size_);
 }
 
 bool VoxelGeneratorTemplate::enqueuePointCloud(
@@ -43,6 +49,53 @@ bool VoxelGeneratorTemplate::enqueuePointCloud(
   return pd_ptr_->enqueuePointCloud(input_pointcloud_msg, tf_buffer);
 }
 
+bool VoxelGeneratorTemplate::addPointToVoxel(
+  const float * point, std::size_t & voxel_cnt, std::vector<float> & voxels,
+  std::vector<int> & coordinates, std::vector<float> & num_points_per_voxel)
+{
+  std::array<int, 3> coord_zyx;
+  for (std::size_t di = 0; di < config_.point_dim_size_; di++) {
+    const int c = static_cast<int>((point[di] - range_[di]) * recip_voxel_size_[di]);
+    if (c < 0 || c >= grid_size_[di]) {
+      return false;
+    }
+    coord_zyx[config_.point_dim_size_ - di - 1] = c;
+  }
+
+  const int coord_idx = coord_zyx[0] * config_.grid_size_y_ * config_.grid_size_x_ +
+                        coord_zyx[1] * config_.grid_size_x_ + coord_zyx[2];
+  int voxel_idx = coord_to_voxel_idx_[coord_idx];
+  if (voxel_idx == -1) {
+    if (voxel_cnt >= config_.max_voxel_size_) {
+      return false;
+    }
+    voxel_idx = static_cast<int>(voxel_cnt);
+    voxel_cnt++;
+    coord_to_voxel_idx_[coord_idx] = voxel_idx;
+    voxel_to_coord_idx_[voxel_idx] = coord_idx;
+    for (std::size_t di = 0; di < config_.point_dim_size_; di++) {
+      coordinates[voxel_idx * config_.point_dim_size_ + di] = coord_zyx[di];
+    }
+  }
+
+  const auto point_cnt = static_cast<std::size_t>(num_points_per_voxel[voxel_idx]);
+  if (point_cnt < config_.max_point_in_voxel_size_) {
+    std::copy(
+      point, point + config_.point_feature_size_,
+      voxels.begin() + voxel_idx * config_.max_point_in_voxel_size_ * config_.point_feature_size_ +
+        point_cnt * config_.point_feature_size_);
+    num_points_per_voxel[voxel_idx]++;
+  }
+  return true;
+}
+
+void VoxelGeneratorTemplate::resetVoxelIndices(const std::size_t voxel_cnt)
+{
+  for (std::size_t vi = 0; vi < voxel_cnt; vi++) {
+    coord_to_voxel_idx_[voxel_to_coord_idx_[vi]] = -1;
+  }
+}
+
 std::size_t VoxelGenerator::pointsToVoxels(
   std::vector<float> & voxels, std::vector<int> & coordinates,
   std::vector<float> & num_points_per_voxel)
@@ -51,79 +104,38 @@ std::size_t VoxelGenerator::pointsToVoxels(
   // coordinates (int): (max_voxel_size * point_dim_size)
   // num_points_per_voxel (float): (max_voxel_size)
 
-  const std::size_t grid_size = config_.grid_size_z_ * config_.grid_size_y_ * config_.grid_size_x_;
-  std::vector<int> coord_to_voxel_idx(grid_size, -1);
-
   std::size_t voxel_cnt = 0;  // @return
-  std::vector<float> point;
-  point.resize(config_.point_feature_size_);
-  std::vector<float> coord_zyx;
-  coord_zyx.resize(config_.point_dim_size_);
-  bool out_of_range;
-  std::size_t point_cnt;
-  int c, coord_idx, voxel_idx;
-  Eigen::Vector3f point_current, point_past;
+  const std::size_t point_step = pd_ptr_->getPointStep();
 
   for (auto pc_cache_iter = pd_ptr_->getPointCloudCacheIter(); !pd_ptr_->isCacheEnd(pc_cache_iter);
        pc_cache_iter++) {
-    auto pc_msg = pc_cache_iter->pointcloud_msg;
-    auto affine_past2current =
+    const auto & points = pc_cache_iter->points;
+    // the current pointcloud is already in the current frame
+    const bool is_current = pc_cache_iter == pd_ptr_->getPointCloudCacheIter();
+    const Eigen::Affine3f affine_past2current =
       pd_ptr_->getAffineWorldToCurrent() * pc_cache_iter->affine_past2world;
-    float timelag = static_cast<float>(
-      pd_ptr_->getCurrentTimestamp() - rclcpp::Time(pc_msg.header.stamp).seconds());
-
-    for (sensor_msgs::PointCloud2ConstIterator<float> x_iter(pc_msg, "x"), y_iter(pc_msg, "y"),
-         z_iter(pc_msg, "z");
-         x_iter != x_iter.end(); ++x_iter, ++y_iter, ++z_iter) {
-      point_past << *x_iter, *y_iter, *z_iter;
-      point_current = affine_past2current * point_past;
-
-      point[0] = point_current.x();
-      point[1] = point_current.y();
-      point[2] = point_current.z();
-      point[3] = timelag;
-
-      out_of_range = false;
-      for (std::size_t di = 0; di < config_.point_dim_size_; di++) {
-        c = static_cast<int>((point[di] - range_[di]) * recip_voxel_size_[di]);
-        if (c < 0 || c >= grid_size_[di]) {
-          out_of_range = true;
-          break;
-        }
-        coord_zyx[config_.point_dim_size_ - di - 1] = c;
-      }
-      if (out_of_range) {
-        continue;
+    const auto timelag =
+      static_cast<float>(pd_ptr_->getCurrentTimestamp() - pc_cache_iter->timestamp);
+
+    for (std::size_t i = 0; i < points.size(); i += point_step) {
+      if (is_current) {
+        point_[0] = points[i];
+        point_[1] = points[i + 1];
+        point_[2] = points[i + 2];
+      } else {
+        const Eigen::Vector3f point_current =
+          affine_past2current * Eigen::Vector3f(points[i], points[i + 1], points[i + 2]);
+        point_[0] = point_current.x();
+        point_[1] = point_current.y();
+        point_[2] = point_current.z();
       }
+      point_[3] = timelag;
 
-      coord_idx = coord_zyx[0] * config_.grid_size_y_ * config_.grid_size_x_ +
-                  coord_zyx[1] * config_.grid_size_x_ + coord_zyx[2];
-      voxel_idx = coord_to_voxel_idx[coord_idx];
-      if (voxel_idx == -1) {
-        voxel_idx = voxel_cnt;
-        if (voxel_cnt >= config_.max_voxel_size_) {
-          continue;
-        }
-
-        voxel_cnt++;
-        coord_to_voxel_idx[coord_idx] = voxel_idx;
-        for (std::size_t di = 0; di < config_.point_dim_size_; di++) {
-          coordinates[voxel_idx * config_.point_dim_size_ + di] = coord_zyx[di];
-        }
-      }
-
-      point_cnt = num_points_per_voxel[voxel_idx];
-      if (point_cnt < config_.max_point_in_voxel_size_) {
-        for (std::size_t fi = 0; fi < config_.point_feature_size_; fi++) {
-          voxels
-            [voxel_idx * config_.max_point_in_voxel_size_ * config_.point_feature_size_ +
-             point_cnt * config_.point_feature_size_ + fi] = point[fi];
-        }
-        num_points_per_voxel[voxel_idx]++;
-      }
+      addPointToVoxel(point_.data(), voxel_cnt, voxels, coordinates, num_points_per_voxel);
     }
   }
 
+  resetVoxelIndices(voxel_cnt);
   return voxel_cnt;
 }
 
@@ -29,6 +29,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <Eigen/SparseCore>
 
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
 
@@ -40,17 +41,24 @@ private:
   Eigen::MatrixXd max_rad_matrix_;
   Eigen::MatrixXd min_iou_matrix_;
   const double score_threshold_;
+  // no pair farther than this passes the dist gate
+  double max_dist_;
   std::unique_ptr<gnn_solver::GnnSolverInterface> gnn_solver_ptr_;
 
+  double calcScore(
+    const autoware_auto_perception_msgs::msg::DetectedObject & object0,
+    const autoware_auto_perception_msgs::msg::DetectedObject & object1) const;
+
 public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   DataAssociation(
     std::vector<int> can_assign_vector, std::vector<double> max_dist_vector,
     std::vector<double> max_rad_vector, std::vector<double> min_iou_vector);
   void assign(
-    const Eigen::MatrixXd & src, std::unordered_map<int, int> & direct_assignment,
+    const Eigen::SparseMatrix<double> & src, std::unordered_map<int, int> & direct_assignment,
     std::unordered_map<int, int> & reverse_assignment);
-  Eigen::MatrixXd calcScoreMatrix(
+  // only the pairs which pass the gates have an entry, the objects are bucketed by max_dist
+  Eigen::SparseMatrix<double> calcScoreMatrix(
     const autoware_auto_perception_msgs::msg::DetectedObjects & objects0,
     const autoware_auto_perception_msgs::msg::DetectedObjects & objects1);
   virtual ~DataAssociation() {}
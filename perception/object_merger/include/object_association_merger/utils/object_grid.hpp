@@ -0,0 +1,81 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBJECT_ASSOCIATION_MERGER__UTILS__OBJECT_GRID_HPP_
+#define OBJECT_ASSOCIATION_MERGER__UTILS__OBJECT_GRID_HPP_
+
+#include <autoware_auto_perception_msgs/msg/detected_object.hpp>
+#include <geometry_msgs/msg/point.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace utils
+{
+/**
+ * @brief 2D grid of object indices bucketed by their position.
+ * The objects within `cell_size` of a position are all in the 3x3 cells around it, so only those
+ * are visited by forEachNeighbor.
+ */
+class ObjectGrid
+{
+public:
+  ObjectGrid(
+    const std::vector<autoware_auto_perception_msgs::msg::DetectedObject> & objects,
+    const double cell_size)
+  : cell_size_(cell_size)
+  {
+    for (size_t i = 0; i < objects.size(); ++i) {
+      const auto & position = objects.at(i).kinematics.pose_with_covariance.pose.position;
+      cells_[toKey(toCell(position.x), toCell(position.y))].push_back(i);
+    }
+  }
+
+  // calls `function(index)` for the objects in the 3x3 cells around `position`
+  template <class Function>
+  void forEachNeighbor(const geometry_msgs::msg::Point & position, Function function) const
+  {
+    const int64_t cell_x = toCell(position.x);
+    const int64_t cell_y = toCell(position.y);
+    for (int64_t dx = -1; dx <= 1; ++dx) {
+      for (int64_t dy = -1; dy <= 1; ++dy) {
+        const auto itr = cells_.find(toKey(cell_x + dx, cell_y + dy));
+        if (itr == cells_.end()) continue;
+        for (const auto index : itr->second) {
+          function(index);
+        }
+      }
+    }
+  }
+
+private:
+  int64_t toCell(const double value) const
+  {
+    return static_cast<int64_t>(std::floor(value / cell_size_));
+  }
+
+  static uint64_t toKey(const int64_t cell_x, const int64_t cell_y)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) |
+           static_cast<uint32_t>(cell_y);
+  }
+
+  double cell_size_;
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+};
+}  // namespace utils
+
+#endif  // OBJECT_ASSOCIATION_MERGER__UTILS__OBJECT_GRID_HPP_
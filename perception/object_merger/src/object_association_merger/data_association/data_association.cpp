@@ -15,6 +15,7 @@
 #include "object_association_merger/data_association/data_association.hpp"
 
 #include "object_association_merger/data_association/solver/gnn_solver.hpp"
+#include "object_association_merger/utils/object_grid.hpp"
 #include "object_association_merger/utils/utils.hpp"
 #include "perception_utils/perception_utils.hpp"
 #include "tier4_autoware_utils/geometry/geometry.hpp"
@@ -76,26 +77,31 @@ DataAssociation::DataAssociation(
       min_iou_vector.data(), min_iou_label_num, min_iou_label_num);
     min_iou_matrix_ = min_iou_matrix_tmp.transpose();
   }
+  max_dist_ = max_dist_matrix_.size() == 0 ? 0.0 : max_dist_matrix_.maxCoeff();
 
   gnn_solver_ptr_ = std::make_unique<gnn_solver::MuSSP>();
 }
 
 void DataAssociation::assign(
-  const Eigen::MatrixXd & src, std::unordered_map<int, int> & direct_assignment,
+  const Eigen::SparseMatrix<double> & src, std::unordered_map<int, int> & direct_assignment,
   std::unordered_map<int, int> & reverse_assignment)
 {
-  std::vector<std::vector<double>> score(src.rows());
-  for (int row = 0; row < src.rows(); ++row) {
-    score.at(row).resize(src.cols());
-    for (int col = 0; col < src.cols(); ++col) {
-      score.at(row).at(col) = src(row, col);
+  // every assignment would be below the score threshold
+  if (src.nonZeros() == 0) {
+    return;
+  }
+
+  std::vector<std::vector<double>> score(src.rows(), std::vector<double>(src.cols(), 0.0));
+  for (int col = 0; col < src.outerSize(); ++col) {
+    for (Eigen::SparseMatrix<double>::InnerIterator itr(src, col); itr; ++itr) {
+      score.at(itr.row()).at(itr.col()) = itr.value();
     }
   }
   // Solve
   gnn_solver_ptr_->maximizeLinearAssignment(score, &direct_assignment, &reverse_assignment);
 
   for (auto itr = direct_assignment.begin(); itr != direct_assignment.end();) {
-    if (src(itr->first, itr->second) < score_threshold_) {
+    if (src.coeff(itr->first, itr->second) < score_threshold_) {
       itr = direct_assignment.erase(itr);
       continue;
     } else {
@@ -103,7 +109,7 @@ void DataAssociation::assign(
     }
   }
   for (auto itr = reverse_assignment.begin(); itr != reverse_assignment.end();) {
-    if (src(itr->second, itr->first) < score_threshold_) {
+    if (src.coeff(itr->second, itr->first) < score_threshold_) {
       itr = reverse_assignment.erase(itr);
       continue;
     } else {
@@ -112,61 +118,71 @@ void DataAssociation::assign(
   }
 }
 
-Eigen::MatrixXd DataAssociation::calcScoreMatrix(
+Eigen::SparseMatrix<double> DataAssociation::calcScoreMatrix(
   const autoware_auto_perception_msgs::msg::DetectedObjects & objects0,
   const autoware_auto_perception_msgs::msg::DetectedObjects & objects1)
 {
-  Eigen::MatrixXd score_matrix =
-    Eigen::MatrixXd::Zero(objects1.objects.size(), objects0.objects.size());
+  // the objects0 within max_dist of an object1 are in the 3x3 cells around it
+  constexpr double min_cell_size = 0.1;
+  const utils::ObjectGrid objects0_grid(objects0.objects, std::max(max_dist_, min_cell_size));
+
+  std::vector<Eigen::Triplet<double>> scores;
   for (size_t objects1_idx = 0; objects1_idx < objects1.objects.size(); ++objects1_idx) {
     const autoware_auto_perception_msgs::msg::DetectedObject & object1 =
       objects1.objects.at(objects1_idx);
-    const std::uint8_t object1_label =
-      perception_utils::getHighestProbLabel(object1.classification);
-
-    for (size_t objects0_idx = 0; objects0_idx < objects0.objects.size(); ++objects0_idx) {
-      const autoware_auto_perception_msgs::msg::DetectedObject & object0 =
-        objects0.objects.at(objects0_idx);
-      const std::uint8_t object0_label =
-        perception_utils::getHighestProbLabel(object0.classification);
-
-      double score = 0.0;
-      if (can_assign_matrix_(object1_label, object0_label)) {
-        const double max_dist = max_dist_matrix_(object1_label, object0_label);
-        const double dist = tier4_autoware_utils::calcDistance2d(
-          object0.kinematics.pose_with_covariance.pose.position,
-          object1.kinematics.pose_with_covariance.pose.position);
-
-        bool passed_gate = true;
-        // dist gate
-        if (passed_gate) {
-          if (max_dist < dist) passed_gate = false;
-        }
-        // angle gate
-        if (passed_gate) {
-          const double max_rad = max_rad_matrix_(object1_label, object0_label);
-          const double angle = getFormedYawAngle(
-            object0.kinematics.pose_with_covariance.pose.orientation,
-            object1.kinematics.pose_with_covariance.pose.orientation, false);
-          if (std::fabs(max_rad) < M_PI && std::fabs(max_rad) < std::fabs(angle))
-            passed_gate = false;
-        }
-        // 2d iou gate
-        if (passed_gate) {
-          const double min_iou = min_iou_matrix_(object1_label, object0_label);
-          const double iou = perception_utils::get2dIoU(object0, object1);
-          if (iou < min_iou) passed_gate = false;
+    objects0_grid.forEachNeighbor(
+      object1.kinematics.pose_with_covariance.pose.position, [&](const size_t objects0_idx) {
+        const double score = calcScore(objects0.objects.at(objects0_idx), object1);
+        if (score != 0.0) {
+          scores.emplace_back(objects1_idx, objects0_idx, score);
         }
-
-        // all gate is passed
-        if (passed_gate) {
-          score = (max_dist - std::min(dist, max_dist)) / max_dist;
-          if (score < score_threshold_) score = 0.0;
-        }
-      }
-      score_matrix(objects1_idx, objects0_idx) = score;
-    }
+      });
   }
 
+  Eigen::SparseMatrix<double> score_matrix(objects1.objects.size(), objects0.objects.size());
+  score_matrix.setFromTriplets(scores.begin(), scores.end());
   return score_matrix;
 }
+
+double DataAssociation::calcScore(
+  const autoware_auto_perception_msgs::msg::DetectedObject & object0,
+  const autoware_auto_perception_msgs::msg::DetectedObject & object1) const
+{
+  const std::uint8_t object1_label = perception_utils::getHighestProbLabel(object1.classification);
+  const std::uint8_t object0_label = perception_utils::getHighestProbLabel(object0.classification);
+
+  double score = 0.0;
+  if (can_assign_matrix_(object1_label, object0_label)) {
+    const double max_dist = max_dist_matrix_(object1_label, object0_label);
+    const double dist = tier4_autoware_utils::calcDistance2d(
+      object0.kinematics.pose_with_covariance.pose.position,
+      object1.kinematics.pose_with_covariance.pose.position);
+
+    bool passed_gate = true;
+    // dist gate
+    if (passed_gate) {
+      if (max_dist < dist) passed_gate = false;
+    }
+    // angle gate
+    if (passed_gate) {
+      const double max_rad = max_rad_matrix_(object1_label, object0_label);
+      const double angle = getFormedYawAngle(
+        object0.kinematics.pose_with_covariance.pose.orientation,
+        object1.kinematics.pose_with_covariance.pose.orientation, false);
+      if (std::fabs(max_rad) < M_PI && std::fabs(max_rad) < std::fabs(angle)) passed_gate = false;
+    }
+    // 2d iou gate
+    if (passed_gate) {
+      const double min_iou = min_iou_matrix_(object1_label, object0_label);
+      const double iou = perception_utils::get2dIoU(object0, object1);
+      if (iou < min_iou) passed_gate = false;
+    }
+
+    // all gate is passed
+    if (passed_gate) {
+      score = (max_dist - std::min(dist, max_dist)) / max_dist;
+      if (score < score_threshold_) score = 0.0;
+    }
+  }
+  return score;
+}
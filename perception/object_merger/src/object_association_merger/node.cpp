@@ -14,6 +14,7 @@
 
 #include "object_association_merger/node.hpp"
 
+#include "object_association_merger/utils/object_grid.hpp"
 #include "object_association_merger/utils/utils.hpp"
 #include "perception_utils/perception_utils.hpp"
 #include "tier4_autoware_utils/tier4_autoware_utils.hpp"
@@ -31,12 +32,14 @@ using Label = autoware_auto_perception_msgs::msg::ObjectClassification;
 
 namespace
 {
+constexpr double overlap_distance_threshold = 5.0;
+
 bool isUnknownObjectOverlapped(
   const autoware_auto_perception_msgs::msg::DetectedObject & unknown_object,
   const autoware_auto_perception_msgs::msg::DetectedObject & known_object,
   const double precision_threshold, const double recall_threshold)
 {
-  constexpr double sq_distance_threshold = std::pow(5.0, 2.0);
+  constexpr double sq_distance_threshold = std::pow(overlap_distance_threshold, 2.0);
   const double sq_distance = tier4_autoware_utils::calcSquaredDistance2d(
     unknown_object.kinematics.pose_with_covariance.pose,
     known_object.kinematics.pose_with_covariance.pose);
@@ -109,7 +112,7 @@ void ObjectAssociationMergerNode::objectsCallback(
   std::unordered_map<int, int> direct_assignment, reverse_assignment;
   const auto & objects0 = transformed_objects0.objects;
   const auto & objects1 = transformed_objects1.objects;
-  Eigen::MatrixXd score_matrix =
+  const Eigen::SparseMatrix<double> score_matrix =
     data_association_->calcScoreMatrix(transformed_objects1, transformed_objects0);
   data_association_->assign(score_matrix, direct_assignment, reverse_assignment);
 
@@ -147,16 +150,18 @@ void ObjectAssociationMergerNode::objectsCallback(
     }
     output_msg.objects.clear();
     output_msg.objects = known_objects;
+    // only the known objects within the distance threshold can overlap an unknown object
+    const utils::ObjectGrid known_object_grid(known_objects, overlap_distance_threshold);
     for (const auto & unknown_object : unknown_objects) {
       bool is_overlapped = false;
-      for (const auto & known_object : known_objects) {
-        if (isUnknownObjectOverlapped(
-              unknown_object, known_object, overlapped_judge_param_.precision_threshold,
-              overlapped_judge_param_.recall_threshold)) {
-          is_overlapped = true;
-          break;
-        }
-      }
+      known_object_grid.forEachNeighbor(
+        unknown_object.kinematics.pose_with_covariance.pose.position, [&](const size_t index) {
+          is_overlapped = is_overlapped ||
+                          isUnknownObjectOverlapped(
+                            unknown_object, known_objects.at(index),
+                            overlapped_judge_param_.precision_threshold,
+                            overlapped_judge_param_.recall_threshold);
+        });
       if (!is_overlapped) {
         output_msg.objects.push_back(unknown_object);
       }
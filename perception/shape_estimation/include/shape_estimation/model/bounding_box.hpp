@@ -27,7 +27,6 @@ private:
     const pcl::PointCloud<pcl::PointXYZ> & cluster, const float min_angle, const float max_angle,
     autoware_auto_perception_msgs::msg::Shape & shape_output,
     geometry_msgs::msg::Pose & pose_output);
-  float calcClosenessCriterion(const std::vector<float> & C_1, const std::vector<float> & C_2);
   float optimize(
     const pcl::PointCloud<pcl::PointXYZ> & cluster, const float min_angle, const float max_angle);
   float boostOptimize(
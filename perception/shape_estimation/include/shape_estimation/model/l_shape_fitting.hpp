@@ -0,0 +1,56 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAPE_ESTIMATION__MODEL__L_SHAPE_FITTING_HPP_
+#define SHAPE_ESTIMATION__MODEL__L_SHAPE_FITTING_HPP_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Closeness criterion (Algo.4 of the L-shape fitting paper) evaluated for many angles at
+ * once. The rectangle extents of an angle are taken from the convex hull of the cluster, the
+ * criterion is then accumulated over all points for a block of 8 angles, with AVX or SSE2 when
+ * the compiler enables them. The buffers are kept between clusters.
+ */
+class LShapeFitting
+{
+public:
+  static constexpr size_t block_size = 8;
+
+  void setInputCloud(const pcl::PointCloud<pcl::PointXYZ> & cluster);
+
+  /**
+   * @brief closeness criterion of every angle in `thetas`
+   */
+  void calcClosenessCriteria(const std::vector<float> & thetas, std::vector<float> & criteria);
+
+private:
+  void calcConvexHull();
+  void calcBlock(const float * cos_theta, const float * sin_theta, float * criteria) const;
+
+  // structure of arrays of the cluster points
+  std::vector<float> x_;
+  std::vector<float> y_;
+  // vertices of the convex hull, which bound the projections of all points
+  std::vector<float> hull_x_;
+  std::vector<float> hull_y_;
+  std::vector<int> order_;
+  std::vector<int> hull_indices_;
+};
+
+#endif  // SHAPE_ESTIMATION__MODEL__L_SHAPE_FITTING_HPP_
@@ -14,6 +14,8 @@
 
 #include "shape_estimation/model/bounding_box.hpp"
 
+#include "shape_estimation/model/l_shape_fitting.hpp"
+
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -44,6 +46,16 @@
 
 constexpr float epsilon = 0.001;
 
+namespace
+{
+// The buffers of the fitting are reused by every cluster estimated on this thread.
+LShapeFitting & getLShapeFitting()
+{
+  thread_local LShapeFitting l_shape_fitting;
+  return l_shape_fitting;
+}
+}  // namespace
+
 BoundingBoxShapeModel::BoundingBoxShapeModel()
 : ref_yaw_info_(boost::none), use_boost_bbox_optimizer_(false)
 {
@@ -162,65 +174,26 @@ bool BoundingBoxShapeModel::fitLShape(
   return true;
 }
 
-float BoundingBoxShapeModel::calcClosenessCriterion(
-  const std::vector<float> & C_1, const std::vector<float> & C_2)
-{
-  // Paper : Algo.4 Closeness Criterion
-  const float min_c_1 = *std::min_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const float max_c_1 = *std::max_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const float min_c_2 = *std::min_element(C_2.begin(), C_2.end());  // col.3, Algo.4
-  const float max_c_2 = *std::max_element(C_2.begin(), C_2.end());  // col.3, Algo.4
-
-  std::vector<float> D_1;  // col.4, Algo.4
-  for (const auto & c_1_element : C_1) {
-    const float v = std::min(max_c_1 - c_1_element, c_1_element - min_c_1);
-    D_1.push_back(v * v);
-  }
-
-  std::vector<float> D_2;  // col.5, Algo.4
-  for (const auto & c_2_element : C_2) {
-    const float v = std::min(max_c_2 - c_2_element, c_2_element - min_c_2);
-    D_2.push_back(v * v);
-  }
-  constexpr float d_min = 0.1 * 0.1;
-  constexpr float d_max = 0.4 * 0.4;
-  float beta = 0;  // col.6, Algo.4
-  for (size_t i = 0; i < D_1.size(); ++i) {
-    if (d_max < std::min(D_1.at(i), D_2.at(i))) {
-      continue;
-    }
-    const float d = std::max(std::min(D_1.at(i), D_2.at(i)), d_min);
-    beta += 1.0 / d;
-  }
-  return beta;
-}
-
 float BoundingBoxShapeModel::optimize(
   const pcl::PointCloud<pcl::PointXYZ> & cluster, const float min_angle, const float max_angle)
 {
-  std::vector<std::pair<float /*theta*/, float /*q*/>> Q;
+  auto & l_shape_fitting = getLShapeFitting();
+  l_shape_fitting.setInputCloud(cluster);
+
+  std::vector<float> thetas;
   constexpr float angle_resolution = M_PI / 180.0;
   for (float theta = min_angle; theta <= max_angle + epsilon; theta += angle_resolution) {
-    Eigen::Vector2f e_1;
-    e_1 << std::cos(theta), std::sin(theta);  // col.3, Algo.2
-    Eigen::Vector2f e_2;
-    e_2 << -std::sin(theta), std::cos(theta);  // col.4, Algo.2
-    std::vector<float> C_1;                    // col.5, Algo.2
-    std::vector<float> C_2;                    // col.6, Algo.2
-    for (const auto & point : cluster) {
-      C_1.push_back(point.x * e_1.x() + point.y * e_1.y());
-      C_2.push_back(point.x * e_2.x() + point.y * e_2.y());
-    }
-    float q = calcClosenessCriterion(C_1, C_2);  // col.7, Algo.2
-    Q.push_back(std::make_pair(theta, q));       // col.8, Algo.2
+    thetas.push_back(theta);
   }
+  std::vector<float> Q;  // col.3-8, Algo.2
+  l_shape_fitting.calcClosenessCriteria(thetas, Q);
 
   float theta_star{0.0};  // col.10, Algo.2
   float max_q = 0.0;
   for (size_t i = 0; i < Q.size(); ++i) {
-    if (max_q < Q.at(i).second || i == 0) {
-      max_q = Q.at(i).second;
-      theta_star = Q.at(i).first;
+    if (max_q < Q.at(i) || i == 0) {
+      max_q = Q.at(i);
+      theta_star = thetas.at(i);
     }
   }
 
@@ -230,19 +203,15 @@ float BoundingBoxShapeModel::optimize(
 float BoundingBoxShapeModel::boostOptimize(
   const pcl::PointCloud<pcl::PointXYZ> & cluster, const float min_angle, const float max_angle)
 {
-  auto closeness_func = [&](float theta) {
-    Eigen::Vector2f e_1;
-    e_1 << std::cos(theta), std::sin(theta);  // col.3, Algo.2
-    Eigen::Vector2f e_2;
-    e_2 << -std::sin(theta), std::cos(theta);  // col.4, Algo.2
-    std::vector<float> C_1;                    // col.5, Algo.2
-    std::vector<float> C_2;                    // col.6, Algo.2
-    for (const auto & point : cluster) {
-      C_1.push_back(point.x * e_1.x() + point.y * e_1.y());
-      C_2.push_back(point.x * e_2.x() + point.y * e_2.y());
-    }
-    float q = calcClosenessCriterion(C_1, C_2);
-    return -q;
+  auto & l_shape_fitting = getLShapeFitting();
+  l_shape_fitting.setInputCloud(cluster);
+
+  std::vector<float> theta(1);
+  std::vector<float> q;
+  auto closeness_func = [&](float theta_candidate) {
+    theta.front() = theta_candidate;
+    l_shape_fitting.calcClosenessCriteria(theta, q);
+    return -q.front();
   };
 
   int bits = 6;
@@ -0,0 +1,213 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shape_estimation/model/l_shape_fitting.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+// col.6, Algo.4
+constexpr float d_min = 0.1 * 0.1;
+constexpr float d_max = 0.4 * 0.4;
+}  // namespace
+
+void LShapeFitting::setInputCloud(const pcl::PointCloud<pcl::PointXYZ> & cluster)
+{
+  x_.resize(cluster.size());
+  y_.resize(cluster.size());
+  for (size_t i = 0; i < cluster.size(); ++i) {
+    x_[i] = cluster.points[i].x;
+    y_[i] = cluster.points[i].y;
+  }
+  calcConvexHull();
+}
+
+void LShapeFitting::calcConvexHull()
+{
+  // Andrew's monotone chain. Collinear points are dropped, they never give a unique extent.
+  hull_x_.clear();
+  hull_y_.clear();
+  if (x_.empty()) return;
+  order_.resize(x_.size());
+  for (size_t i = 0; i < order_.size(); ++i) {
+    order_[i] = static_cast<int>(i);
+  }
+  std::sort(order_.begin(), order_.end(), [this](const int a, const int b) {
+    return x_[a] < x_[b] || (x_[a] == x_[b] && y_[a] < y_[b]);
+  });
+  const auto cross = [this](const int o, const int a, const int b) {
+    return (x_[a] - x_[o]) * (y_[b] - y_[o]) - (y_[a] - y_[o]) * (x_[b] - x_[o]);
+  };
+
+  hull_indices_.resize(2 * order_.size());
+  size_t k = 0;
+  for (size_t i = 0; i < order_.size(); ++i) {
+    while (k >= 2 && cross(hull_indices_[k - 2], hull_indices_[k - 1], order_[i]) <= 0.0f) --k;
+    hull_indices_[k++] = order_[i];
+  }
+  const size_t lower_size = k + 1;
+  for (size_t i = order_.size() - 1; i-- > 0;) {
+    while (k >= lower_size &&
+           cross(hull_indices_[k - 2], hull_indices_[k - 1], order_[i]) <= 0.0f) {
+      --k;
+    }
+    hull_indices_[k++] = order_[i];
+  }
+  // the first point is repeated at the end
+  const size_t hull_size = order_.size() < 3 ? order_.size() : k - 1;
+
+  hull_x_.resize(hull_size);
+  hull_y_.resize(hull_size);
+  for (size_t i = 0; i < hull_size; ++i) {
+    const int index = order_.size() < 3 ? static_cast<int>(i) : hull_indices_[i];
+    hull_x_[i] = x_[index];
+    hull_y_[i] = y_[index];
+  }
+}
+
+void LShapeFitting::calcClosenessCriteria(
+  const std::vector<float> & thetas, std::vector<float> & criteria)
+{
+  criteria.assign(thetas.size(), 0.0f);
+  if (x_.empty()) return;
+
+  alignas(32) float cos_theta[block_size];
+  alignas(32) float sin_theta[block_size];
+  alignas(32) float block_criteria[block_size];
+  for (size_t i = 0; i < thetas.size(); i += block_size) {
+    // the last block is padded with its last angle
+    for (size_t k = 0; k < block_size; ++k) {
+      const float theta = thetas[std::min(i + k, thetas.size() - 1)];
+      cos_theta[k] = std::cos(theta);
+      sin_theta[k] = std::sin(theta);
+    }
+    calcBlock(cos_theta, sin_theta, block_criteria);
+    for (size_t k = 0; k < block_size && i + k < thetas.size(); ++k) {
+      criteria[i + k] = block_criteria[k];
+    }
+  }
+}
+
+void LShapeFitting::calcBlock(
+  const float * cos_theta, const float * sin_theta, float * criteria) const
+{
+  const size_t hull_size = hull_x_.size();
+  const size_t size = x_.size();
+#if defined(__AVX__)
+  const __m256 c = _mm256_load_ps(cos_theta);
+  const __m256 s = _mm256_load_ps(sin_theta);
+  // col.2-3, Algo.4
+  __m256 min_c_1 = _mm256_set1_ps(std::numeric_limits<float>::max());
+  __m256 max_c_1 = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+  __m256 min_c_2 = min_c_1;
+  __m256 max_c_2 = max_c_1;
+  for (size_t i = 0; i < hull_size; ++i) {
+    const __m256 x = _mm256_set1_ps(hull_x_[i]);
+    const __m256 y = _mm256_set1_ps(hull_y_[i]);
+    const __m256 c_1 = _mm256_add_ps(_mm256_mul_ps(x, c), _mm256_mul_ps(y, s));
+    const __m256 c_2 = _mm256_sub_ps(_mm256_mul_ps(y, c), _mm256_mul_ps(x, s));
+    min_c_1 = _mm256_min_ps(min_c_1, c_1);
+    max_c_1 = _mm256_max_ps(max_c_1, c_1);
+    min_c_2 = _mm256_min_ps(min_c_2, c_2);
+    max_c_2 = _mm256_max_ps(max_c_2, c_2);
+  }
+  // col.4-6, Algo.4
+  const __m256 d_min_v = _mm256_set1_ps(d_min);
+  const __m256 d_max_v = _mm256_set1_ps(d_max);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  __m256 beta = _mm256_setzero_ps();
+  for (size_t i = 0; i < size; ++i) {
+    const __m256 x = _mm256_set1_ps(x_[i]);
+    const __m256 y = _mm256_set1_ps(y_[i]);
+    const __m256 c_1 = _mm256_add_ps(_mm256_mul_ps(x, c), _mm256_mul_ps(y, s));
+    const __m256 c_2 = _mm256_sub_ps(_mm256_mul_ps(y, c), _mm256_mul_ps(x, s));
+    const __m256 v_1 = _mm256_min_ps(_mm256_sub_ps(max_c_1, c_1), _mm256_sub_ps(c_1, min_c_1));
+    const __m256 v_2 = _mm256_min_ps(_mm256_sub_ps(max_c_2, c_2), _mm256_sub_ps(c_2, min_c_2));
+    const __m256 d = _mm256_min_ps(_mm256_mul_ps(v_1, v_1), _mm256_mul_ps(v_2, v_2));
+    const __m256 q = _mm256_div_ps(one, _mm256_max_ps(d, d_min_v));
+    beta = _mm256_add_ps(beta, _mm256_and_ps(_mm256_cmp_ps(d, d_max_v, _CMP_LE_OQ), q));
+  }
+  _mm256_storeu_ps(criteria, beta);
+#elif defined(__SSE2__)
+  for (size_t k = 0; k < block_size; k += 4) {
+    const __m128 c = _mm_load_ps(cos_theta + k);
+    const __m128 s = _mm_load_ps(sin_theta + k);
+    // col.2-3, Algo.4
+    __m128 min_c_1 = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128 max_c_1 = _mm_set1_ps(std::numeric_limits<float>::lowest());
+    __m128 min_c_2 = min_c_1;
+    __m128 max_c_2 = max_c_1;
+    for (size_t i = 0; i < hull_size; ++i) {
+      const __m128 x = _mm_set1_ps(hull_x_[i]);
+      const __m128 y = _mm_set1_ps(hull_y_[i]);
+      const __m128 c_1 = _mm_add_ps(_mm_mul_ps(x, c), _mm_mul_ps(y, s));
+      const __m128 c_2 = _mm_sub_ps(_mm_mul_ps(y, c), _mm_mul_ps(x, s));
+      min_c_1 = _mm_min_ps(min_c_1, c_1);
+      max_c_1 = _mm_max_ps(max_c_1, c_1);
+      min_c_2 = _mm_min_ps(min_c_2, c_2);
+      max_c_2 = _mm_max_ps(max_c_2, c_2);
+    }
+    // col.4-6, Algo.4
+    const __m128 d_min_v = _mm_set1_ps(d_min);
+    const __m128 d_max_v = _mm_set1_ps(d_max);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 beta = _mm_setzero_ps();
+    for (size_t i = 0; i < size; ++i) {
+      const __m128 x = _mm_set1_ps(x_[i]);
+      const __m128 y = _mm_set1_ps(y_[i]);
+      const __m128 c_1 = _mm_add_ps(_mm_mul_ps(x, c), _mm_mul_ps(y, s));
+      const __m128 c_2 = _mm_sub_ps(_mm_mul_ps(y, c), _mm_mul_ps(x, s));
+      const __m128 v_1 = _mm_min_ps(_mm_sub_ps(max_c_1, c_1), _mm_sub_ps(c_1, min_c_1));
+      const __m128 v_2 = _mm_min_ps(_mm_sub_ps(max_c_2, c_2), _mm_sub_ps(c_2, min_c_2));
+      const __m128 d = _mm_min_ps(_mm_mul_ps(v_1, v_1), _mm_mul_ps(v_2, v_2));
+      const __m128 q = _mm_div_ps(one, _mm_max_ps(d, d_min_v));
+      beta = _mm_add_ps(beta, _mm_and_ps(_mm_cmple_ps(d, d_max_v), q));
+    }
+    _mm_storeu_ps(criteria + k, beta);
+  }
+#else
+  for (size_t k = 0; k < block_size; ++k) {
+    float min_c_1, max_c_1, min_c_2, max_c_2;
+    min_c_1 = min_c_2 = std::numeric_limits<float>::max();
+    max_c_1 = max_c_2 = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < hull_size; ++i) {
+      const float c_1 = hull_x_[i] * cos_theta[k] + hull_y_[i] * sin_theta[k];
+      const float c_2 = hull_y_[i] * cos_theta[k] - hull_x_[i] * sin_theta[k];
+      min_c_1 = std::min(min_c_1, c_1);
+      max_c_1 = std::max(max_c_1, c_1);
+      min_c_2 = std::min(min_c_2, c_2);
+      max_c_2 = std::max(max_c_2, c_2);
+    }
+    float beta = 0.0f;
+    for (size_t i = 0; i < size; ++i) {
+      const float c_1 = x_[i] * cos_theta[k] + y_[i] * sin_theta[k];
+      const float c_2 = y_[i] * cos_theta[k] - x_[i] * sin_theta[k];
+      const float v_1 = std::min(max_c_1 - c_1, c_1 - min_c_1);
+      const float v_2 = std::min(max_c_2 - c_2, c_2 - min_c_2);
+      const float d = std::min(v_1 * v_1, v_2 * v_2);
+      if (d_max < d) continue;
+      beta += 1.0f / std::max(d, d_min);
+    }
+    criteria[k] = beta;
+  }
+#endif
+}
@@ -29,11 +29,59 @@
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <vector>
 
 using Label = autoware_auto_perception_msgs::msg::ObjectClassification;
 
+namespace
+{
+int getFloat32FieldOffset(const sensor_msgs::msg::PointCloud2 & msg, const std::string & name)
+{
+  for (const auto & field : msg.fields) {
+    if (field.name == name && field.datatype == sensor_msgs::msg::PointField::FLOAT32) {
+      return static_cast<int>(field.offset);
+    }
+  }
+  return -1;
+}
+
+// Decode x, y and z straight from the message bytes, without allocating once `cluster` has grown.
+void toPointCloud(
+  const sensor_msgs::msg::PointCloud2 & msg, pcl::PointCloud<pcl::PointXYZ> & cluster)
+{
+  const int x_offset = getFloat32FieldOffset(msg, "x");
+  const int y_offset = getFloat32FieldOffset(msg, "y");
+  const int z_offset = getFloat32FieldOffset(msg, "z");
+  if (x_offset < 0 || y_offset < 0 || z_offset < 0 || msg.is_bigendian) {
+    pcl::fromROSMsg(msg, cluster);
+    return;
+  }
+
+  cluster.resize(static_cast<size_t>(msg.width) * msg.height);
+  size_t i = 0;
+  for (size_t row = 0; row < msg.height; ++row) {
+    const uint8_t * point = msg.data.data() + row * msg.row_step;
+    for (size_t col = 0; col < msg.width; ++col, point += msg.point_step) {
+      auto & cluster_point = cluster.points[i++];
+      std::memcpy(&cluster_point.x, point + x_offset, sizeof(float));
+      std::memcpy(&cluster_point.y, point + y_offset, sizeof(float));
+      std::memcpy(&cluster_point.z, point + z_offset, sizeof(float));
+    }
+  }
+  cluster.width = msg.width;
+  cluster.height = msg.height;
+  cluster.is_dense = msg.is_dense;
+}
+}  // namespace
+
 ShapeEstimationNode::ShapeEstimationNode(const rclcpp::NodeOptions & node_options)
 : Node("shape_estimation", node_options)
 {
@@ -49,6 +97,11 @@ ShapeEstimationNode::ShapeEstimationNode(const rclcpp::NodeOptions & node_option
   RCLCPP_INFO(this->get_logger(), "using boost shape estimation : %d", use_boost_bbox_optimizer);
   estimator_ =
     std::make_unique<ShapeEstimator>(use_corrector, use_filter, use_boost_bbox_optimizer);
+  num_threads_ = std::max(static_cast<int>(declare_parameter("num_threads", 1)), 1);
+#ifndef _OPENMP
+  num_threads_ = 1;
+#endif
+  cluster_buffers_.resize(num_threads_);
 }
 
 void ShapeEstimationNode::callback(const DetectedObjectsWithFeature::ConstSharedPtr input_msg)
@@ -62,43 +115,53 @@ void ShapeEstimationNode::callback(const DetectedObjectsWithFeature::ConstShared
   DetectedObjectsWithFeature output_msg;
   output_msg.header = input_msg->header;
 
-  // Estimate shape for each object and pack msg
-  for (const auto & feature_object : input_msg->feature_objects) {
-    const auto & object = feature_object.object;
+  // Estimate shape for each object, the clusters are independent of each other
+  const auto & feature_objects = input_msg->feature_objects;
+  std::vector<char> estimated_success(feature_objects.size(), false);
+  std::vector<autoware_auto_perception_msgs::msg::Shape> shapes(feature_objects.size());
+  std::vector<geometry_msgs::msg::Pose> poses(feature_objects.size());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(num_threads_) schedule(dynamic)
+#endif
+  for (int i = 0; i < static_cast<int>(feature_objects.size()); ++i) {
+    const auto & object = feature_objects.at(i).object;
     const auto & label = object.classification.front().label;
-    const auto & feature = feature_object.feature;
+    const auto & feature = feature_objects.at(i).feature;
     const bool is_vehicle = Label::CAR == label || Label::TRUCK == label || Label::BUS == label ||
                             Label::TRAILER == label;
 
     // convert ros to pcl
-    pcl::PointCloud<pcl::PointXYZ>::Ptr cluster(new pcl::PointCloud<pcl::PointXYZ>);
-    pcl::fromROSMsg(feature.cluster, *cluster);
+#ifdef _OPENMP
+    auto & cluster = cluster_buffers_.at(omp_get_thread_num());
+#else
+    auto & cluster = cluster_buffers_.front();
+#endif
+    toPointCloud(feature.cluster, cluster);
 
     // check cluster data
-    if (cluster->empty()) {
+    if (cluster.empty()) {
       continue;
     }
 
     // estimate shape and pose
-    autoware_auto_perception_msgs::msg::Shape shape;
-    geometry_msgs::msg::Pose pose;
     boost::optional<ReferenceYawInfo> ref_yaw_info = boost::none;
     if (use_vehicle_reference_yaw_ && is_vehicle) {
       ref_yaw_info = ReferenceYawInfo{
         static_cast<float>(tf2::getYaw(object.kinematics.pose_with_covariance.pose.orientation)),
         tier4_autoware_utils::deg2rad(10)};
     }
-    const bool estimated_success =
-      estimator_->estimateShapeAndPose(label, *cluster, ref_yaw_info, shape, pose);
+    estimated_success.at(i) = estimator_->estimateShapeAndPose(
+      label, cluster, ref_yaw_info, shapes.at(i), poses.at(i));
+  }
 
-    // If the shape estimation fails, ignore it.
-    if (!estimated_success) {
+  // Pack msg in the input order. If the shape estimation fails, ignore it.
+  for (size_t i = 0; i < feature_objects.size(); ++i) {
+    if (!estimated_success.at(i)) {
       continue;
     }
-
-    output_msg.feature_objects.push_back(feature_object);
-    output_msg.feature_objects.back().object.shape = shape;
-    output_msg.feature_objects.back().object.kinematics.pose_with_covariance.pose = pose;
+    output_msg.feature_objects.push_back(feature_objects.at(i));
+    output_msg.feature_objects.back().object.shape = shapes.at(i);
+    output_msg.feature_objects.back().object.kinematics.pose_with_covariance.pose = poses.at(i);
   }
 
   // Publish
@@ -23,6 +23,7 @@
 #include <tier4_perception_msgs/msg/detected_objects_with_feature.hpp>
 
 #include <memory>
+#include <vector>
 
 using autoware_auto_perception_msgs::msg::DetectedObjects;
 using tier4_perception_msgs::msg::DetectedObjectsWithFeature;
@@ -37,6 +38,9 @@ private:
 
   std::unique_ptr<ShapeEstimator> estimator_;
   bool use_vehicle_reference_yaw_;
+  int num_threads_;
+  // cluster decoding buffer of each worker thread
+  std::vector<pcl::PointCloud<pcl::PointXYZ>> cluster_buffers_;
 
 public:
   explicit ShapeEstimationNode(const rclcpp::NodeOptions & node_options);
@@ -36,6 +36,7 @@
 #include <lanelet2_extension/regulatory_elements/autoware_traffic_light.hpp>
 #include <lanelet2_extension/utility/query.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <tier4_autoware_utils/geometry/boost_geometry.hpp>
 
 #include <autoware_auto_mapping_msgs/msg/had_map_bin.hpp>
 #include <autoware_auto_perception_msgs/msg/traffic_light_roi_array.hpp>
@@ -44,6 +45,8 @@
 #include <sensor_msgs/msg/camera_info.hpp>
 #include <visualization_msgs/msg/marker_array.hpp>
 
+#include <boost/geometry/index/rtree.hpp>
+
 #include <image_geometry/pinhole_camera_model.h>
 #include <lanelet2_core/LaneletMap.h>
 #include <lanelet2_routing/RoutingGraph.h>
@@ -53,6 +56,7 @@
 
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace traffic_light
@@ -94,8 +98,23 @@ private:
 
   using TrafficLightSet = std::set<lanelet::ConstLineString3d, IdLessThan>;
 
-  std::shared_ptr<TrafficLightSet> all_traffic_lights_ptr_;
-  std::shared_ptr<TrafficLightSet> route_traffic_lights_ptr_;
+  // the geometry of a traffic light which doesn't depend on the camera
+  struct TrafficLightInfo
+  {
+    lanelet::ConstLineString3d traffic_light;
+    geometry_msgs::msg::Point central_point;
+    double yaw;
+  };
+  using TrafficLightPoint = std::pair<tier4_autoware_utils::Point2d, size_t>;
+  // traffic lights in the order of their ids and an R-tree of their central points
+  struct TrafficLightIndex
+  {
+    std::vector<TrafficLightInfo> traffic_lights;
+    boost::geometry::index::rtree<TrafficLightPoint, boost::geometry::index::rstar<16>> rtree;
+  };
+
+  std::shared_ptr<TrafficLightIndex> all_traffic_lights_ptr_;
+  std::shared_ptr<TrafficLightIndex> route_traffic_lights_ptr_;
 
   lanelet::LaneletMapPtr lanelet_map_ptr_;
   lanelet::traffic_rules::TrafficRulesPtr traffic_rules_ptr_;
@@ -105,8 +124,10 @@ private:
   void mapCallback(const autoware_auto_mapping_msgs::msg::HADMapBin::ConstSharedPtr input_msg);
   void cameraInfoCallback(const sensor_msgs::msg::CameraInfo::ConstSharedPtr input_msg);
   void routeCallback(const autoware_auto_planning_msgs::msg::HADMapRoute::ConstSharedPtr input_msg);
+  std::shared_ptr<TrafficLightIndex> createTrafficLightIndex(
+    const TrafficLightSet & traffic_lights) const;
   void getVisibleTrafficLights(
-    const TrafficLightSet & all_traffic_lights, const geometry_msgs::msg::Pose & camera_pose,
+    const TrafficLightIndex & traffic_light_index, const geometry_msgs::msg::Pose & camera_pose,
     const image_geometry::PinholeCameraModel & pinhole_camera_model,
     std::vector<lanelet::ConstLineString3d> & visible_traffic_lights);
   bool isInDistanceRange(
@@ -50,6 +50,7 @@
 #include <tf2/LinearMath/Transform.h>
 
 #include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -274,7 +275,7 @@ void MapBasedDetector::mapCallback(
   lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(lanelet_map_ptr_);
   std::vector<lanelet::AutowareTrafficLightConstPtr> all_lanelet_traffic_lights =
     lanelet::utils::query::autowareTrafficLights(all_lanelets);
-  all_traffic_lights_ptr_ = std::make_shared<MapBasedDetector::TrafficLightSet>();
+  MapBasedDetector::TrafficLightSet all_traffic_lights;
   for (auto tl_itr = all_lanelet_traffic_lights.begin(); tl_itr != all_lanelet_traffic_lights.end();
        ++tl_itr) {
     lanelet::AutowareTrafficLightConstPtr tl = *tl_itr;
@@ -284,9 +285,10 @@ void MapBasedDetector::mapCallback(
       if (!lsp.isLineString()) {  // traffic lights must be linestrings
         continue;
       }
-      all_traffic_lights_ptr_->insert(static_cast<lanelet::ConstLineString3d>(lsp));
+      all_traffic_lights.insert(static_cast<lanelet::ConstLineString3d>(lsp));
     }
   }
+  all_traffic_lights_ptr_ = createTrafficLightIndex(all_traffic_lights);
 }
 
 void MapBasedDetector::routeCallback(
@@ -309,7 +311,7 @@ void MapBasedDetector::routeCallback(
   }
   std::vector<lanelet::AutowareTrafficLightConstPtr> route_lanelet_traffic_lights =
     lanelet::utils::query::autowareTrafficLights(route_lanelets);
-  route_traffic_lights_ptr_ = std::make_shared<MapBasedDetector::TrafficLightSet>();
+  MapBasedDetector::TrafficLightSet route_traffic_lights;
   for (auto tl_itr = route_lanelet_traffic_lights.begin();
        tl_itr != route_lanelet_traffic_lights.end(); ++tl_itr) {
     lanelet::AutowareTrafficLightConstPtr tl = *tl_itr;
@@ -319,63 +321,104 @@ void MapBasedDetector::routeCallback(
       if (!lsp.isLineString()) {  // traffic lights must be linestrings
         continue;
       }
-      route_traffic_lights_ptr_->insert(static_cast<lanelet::ConstLineString3d>(lsp));
+      route_traffic_lights.insert(static_cast<lanelet::ConstLineString3d>(lsp));
     }
   }
+  route_traffic_lights_ptr_ = createTrafficLightIndex(route_traffic_lights);
 }
 
-void MapBasedDetector::getVisibleTrafficLights(
-  const MapBasedDetector::TrafficLightSet & all_traffic_lights,
-  const geometry_msgs::msg::Pose & camera_pose,
-  const image_geometry::PinholeCameraModel & pinhole_camera_model,
-  std::vector<lanelet::ConstLineString3d> & visible_traffic_lights)
+std::shared_ptr<MapBasedDetector::TrafficLightIndex> MapBasedDetector::createTrafficLightIndex(
+  const MapBasedDetector::TrafficLightSet & traffic_lights) const
 {
-  for (const auto & traffic_light : all_traffic_lights) {
+  auto traffic_light_index = std::make_shared<MapBasedDetector::TrafficLightIndex>();
+  traffic_light_index->traffic_lights.reserve(traffic_lights.size());
+  std::vector<TrafficLightPoint> points;
+  points.reserve(traffic_lights.size());
+  for (const auto & traffic_light : traffic_lights) {
     const auto & tl_left_down_point = traffic_light.front();
     const auto & tl_right_down_point = traffic_light.back();
     const double tl_height = traffic_light.attributeOr("height", 0.0);
 
-    // check distance range
-    geometry_msgs::msg::Point tl_central_point;
-    tl_central_point.x = (tl_right_down_point.x() + tl_left_down_point.x()) / 2.0;
-    tl_central_point.y = (tl_right_down_point.y() + tl_left_down_point.y()) / 2.0;
-    tl_central_point.z = (tl_right_down_point.z() + tl_left_down_point.z() + tl_height) / 2.0;
-    constexpr double max_distance_range = 200.0;
-    if (!isInDistanceRange(tl_central_point, camera_pose.position, max_distance_range)) {
-      continue;
-    }
-
-    // check angle range
-    const double tl_yaw = tier4_autoware_utils::normalizeRadian(
+    TrafficLightInfo info;
+    info.traffic_light = traffic_light;
+    info.central_point.x = (tl_right_down_point.x() + tl_left_down_point.x()) / 2.0;
+    info.central_point.y = (tl_right_down_point.y() + tl_left_down_point.y()) / 2.0;
+    info.central_point.z = (tl_right_down_point.z() + tl_left_down_point.z() + tl_height) / 2.0;
+    info.yaw = tier4_autoware_utils::normalizeRadian(
       std::atan2(
         tl_right_down_point.y() - tl_left_down_point.y(),
         tl_right_down_point.x() - tl_left_down_point.x()) +
       M_PI_2);
-    constexpr double max_angle_range = tier4_autoware_utils::deg2rad(40.0);
 
-    // get direction of z axis
-    tf2::Vector3 camera_z_dir(0, 0, 1);
-    tf2::Matrix3x3 camera_rotation_matrix(tf2::Quaternion(
+    points.emplace_back(
+      tier4_autoware_utils::Point2d(info.central_point.x, info.central_point.y),
+      traffic_light_index->traffic_lights.size());
+    traffic_light_index->traffic_lights.push_back(info);
+  }
+  // packing constructor
+  traffic_light_index->rtree =
+    decltype(traffic_light_index->rtree)(points.begin(), points.end());
+  return traffic_light_index;
+}
+
+void MapBasedDetector::getVisibleTrafficLights(
+  const MapBasedDetector::TrafficLightIndex & traffic_light_index,
+  const geometry_msgs::msg::Pose & camera_pose,
+  const image_geometry::PinholeCameraModel & pinhole_camera_model,
+  std::vector<lanelet::ConstLineString3d> & visible_traffic_lights)
+{
+  constexpr double max_distance_range = 200.0;
+  constexpr double max_angle_range = tier4_autoware_utils::deg2rad(40.0);
+
+  // get direction of z axis
+  tf2::Vector3 camera_z_dir(0, 0, 1);
+  tf2::Matrix3x3 camera_rotation_matrix(tf2::Quaternion(
+    camera_pose.orientation.x, camera_pose.orientation.y, camera_pose.orientation.z,
+    camera_pose.orientation.w));
+  camera_z_dir = camera_rotation_matrix * camera_z_dir;
+  double camera_yaw = std::atan2(camera_z_dir.y(), camera_z_dir.x());
+  camera_yaw = tier4_autoware_utils::normalizeRadian(camera_yaw);
+
+  tf2::Transform tf_map2camera(
+    tf2::Quaternion(
       camera_pose.orientation.x, camera_pose.orientation.y, camera_pose.orientation.z,
-      camera_pose.orientation.w));
-    camera_z_dir = camera_rotation_matrix * camera_z_dir;
-    double camera_yaw = std::atan2(camera_z_dir.y(), camera_z_dir.x());
-    camera_yaw = tier4_autoware_utils::normalizeRadian(camera_yaw);
-    if (!isInAngleRange(tl_yaw, camera_yaw, max_angle_range)) {
+      camera_pose.orientation.w),
+    tf2::Vector3(camera_pose.position.x, camera_pose.position.y, camera_pose.position.z));
+  const tf2::Transform tf_camera2map = tf_map2camera.inverse();
+
+  // only the traffic lights in the square around the distance range are checked
+  const tier4_autoware_utils::Box2d search_box(
+    tier4_autoware_utils::Point2d(
+      camera_pose.position.x - max_distance_range, camera_pose.position.y - max_distance_range),
+    tier4_autoware_utils::Point2d(
+      camera_pose.position.x + max_distance_range, camera_pose.position.y + max_distance_range));
+  std::vector<TrafficLightPoint> hits;
+  traffic_light_index.rtree.query(
+    boost::geometry::index::intersects(search_box), std::back_inserter(hits));
+  // keep the order of the ids
+  std::sort(hits.begin(), hits.end(), [](const TrafficLightPoint & a, const TrafficLightPoint & b) {
+    return a.second < b.second;
+  });
+
+  for (const auto & hit : hits) {
+    const auto & info = traffic_light_index.traffic_lights.at(hit.second);
+
+    // check distance range
+    if (!isInDistanceRange(info.central_point, camera_pose.position, max_distance_range)) {
+      continue;
+    }
+
+    // check angle range
+    if (!isInAngleRange(info.yaw, camera_yaw, max_angle_range)) {
       continue;
     }
 
     // check within image frame
-    tf2::Transform tf_map2camera(
-      tf2::Quaternion(
-        camera_pose.orientation.x, camera_pose.orientation.y, camera_pose.orientation.z,
-        camera_pose.orientation.w),
-      tf2::Vector3(camera_pose.position.x, camera_pose.position.y, camera_pose.position.z));
     tf2::Transform tf_map2tl(
       tf2::Quaternion(0, 0, 0, 1),
-      tf2::Vector3(tl_central_point.x, tl_central_point.y, tl_central_point.z));
+      tf2::Vector3(info.central_point.x, info.central_point.y, info.central_point.z));
     tf2::Transform tf_camera2tl;
-    tf_camera2tl = tf_map2camera.inverse() * tf_map2tl;
+    tf_camera2tl = tf_camera2map * tf_map2tl;
 
     geometry_msgs::msg::Point camera2tl_point;
     camera2tl_point.x = tf_camera2tl.getOrigin().x();
@@ -384,7 +427,7 @@ void MapBasedDetector::getVisibleTrafficLights(
     if (!isInImageFrame(pinhole_camera_model, camera2tl_point)) {
       continue;
     }
-    visible_traffic_lights.push_back(traffic_light);
+    visible_traffic_lights.push_back(info.traffic_light);
   }
 }
 
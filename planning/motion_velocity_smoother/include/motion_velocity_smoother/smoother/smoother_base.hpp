@@ -18,6 +18,7 @@
 #include "motion_utils/trajectory/trajectory.hpp"
 #include "motion_velocity_smoother/resample.hpp"
 #include "motion_velocity_smoother/trajectory_utils.hpp"
+#include "osqp_interface/osqp_interface.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "tier4_autoware_utils/geometry/geometry.hpp"
 #include "vehicle_info_util/vehicle_info_util.hpp"
@@ -57,6 +58,8 @@ public:
     double curvature_calculation_distance;  // threshold steering degree limit to trigger
                                             // steeringRateLimit [degree]
     resampling::ResampleParam resample_param;
+    bool enable_warm_start;               // seed the optimization with the previous result
+    double warm_start_max_lateral_offset;  // max lateral offset to reuse the previous result [m]
   };
 
   explicit SmootherBase(rclcpp::Node & node);
@@ -84,8 +87,35 @@ public:
   void setParam(const BaseParam & param);
   BaseParam getBaseParam() const;
 
+  // number of iterations taken by the latest optimization (0 if no optimization is done)
+  int64_t getLatestIterationNum() const;
+  void resetWarmStart();
+
 protected:
   BaseParam base_param_;
+
+  // buffers of the optimization reused between the cycles
+  std::vector<double> primal_solution_;
+  std::vector<double> lagrange_multiplier_;
+  int64_t latest_iteration_num_{0};
+
+  /**
+   * @brief seed the solver with the previous optimized profile mapped on the trajectory
+   * @param idx_b0 index of the first squared velocity in the optimization variables
+   * @param idx_a0 index of the first acceleration in the optimization variables
+   */
+  void setWarmStart(
+    autoware::common::osqp::OSQPInterface & qp_solver, const TrajectoryPoints & trajectory,
+    const size_t N, const size_t idx_b0, const size_t idx_a0, const size_t l_variables,
+    const size_t l_constraints);
+  void updateWarmStartTrajectory(const TrajectoryPoints & optimized_trajectory);
+
+private:
+  TrajectoryPoints prev_optimized_trajectory_;
+  std::vector<double> warm_start_velocity_;
+  std::vector<double> warm_start_acceleration_;
+  Eigen::VectorXd warm_start_primal_;
+  Eigen::VectorXd warm_start_dual_;
 };
 }  // namespace motion_velocity_smoother
 
@@ -83,6 +83,15 @@ std::vector<double> calcVelocityProfileWithConstantJerkAndAccelerationLimit(
   const TrajectoryPoints & trajectory, const double v0, const double a0, const double jerk,
   const double acc_max, const double acc_min);
 
+/**
+ * @brief map velocity and acceleration of base_trajectory on target_trajectory by arc length
+ * @return false if target_trajectory is not on base_trajectory within max_lateral_offset
+ */
+bool mapVelocityProfileByArcLength(
+  const TrajectoryPoints & base_trajectory, const TrajectoryPoints & target_trajectory,
+  const double max_lateral_offset, std::vector<double> & velocity,
+  std::vector<double> & acceleration);
+
 }  // namespace trajectory_utils
 }  // namespace motion_velocity_smoother
 
@@ -107,6 +107,8 @@ MotionVelocitySmootherNode::MotionVelocitySmootherNode(const rclcpp::NodeOptions
   debug_closest_jerk_ = create_publisher<Float32Stamped>("~/closest_jerk", 1);
   debug_closest_max_velocity_ = create_publisher<Float32Stamped>("~/closest_max_velocity", 1);
   debug_calculation_time_ = create_publisher<Float32Stamped>("~/calculation_time", 1);
+  debug_optimization_iteration_ =
+    create_publisher<Int32Stamped>("~/debug/optimization_iteration", 1);
   pub_trajectory_raw_ = create_publisher<Trajectory>("~/debug/trajectory_raw", 1);
   pub_trajectory_vel_lim_ =
     create_publisher<Trajectory>("~/debug/trajectory_external_velocity_limited", 1);
@@ -184,6 +186,7 @@ rcl_interfaces::msg::SetParametersResult MotionVelocitySmootherNode::onParameter
     update_param("curvature_threshold", p.curvature_threshold);
     update_param("max_steering_angle_rate", p.max_steering_angle_rate);
     update_param("curvature_calculation_distance", p.curvature_calculation_distance);
+    update_param("warm_start_max_lateral_offset", p.warm_start_max_lateral_offset);
     smoother_->setParam(p);
   }
 
@@ -544,6 +547,14 @@ bool MotionVelocitySmootherNode::smoothVelocity(
     RCLCPP_WARN(get_logger(), "Fail to solve optimization.");
   }
 
+  // Publish the number of iterations to check the convergence of the optimization
+  {
+    Int32Stamped iteration_msg{};
+    iteration_msg.stamp = this->now();
+    iteration_msg.data = static_cast<int32_t>(smoother_->getLatestIterationNum());
+    debug_optimization_iteration_->publish(iteration_msg);
+  }
+
   // Set 0 velocity after input-stop-point
   overwriteStopPoint(clipped, traj_smoothed);
 
@@ -54,6 +54,7 @@ bool JerkFilteredSmoother::apply(
   std::vector<TrajectoryPoints> & debug_trajectories)
 {
   output = input;
+  latest_iteration_num_ = 0;
 
   if (input.empty()) {
     RCLCPP_WARN(logger_, "Input TrajectoryPoints to the jerk filtered optimization is empty.");
@@ -285,8 +286,15 @@ bool JerkFilteredSmoother::apply(
   }
 
   // execute optimization
-  const auto result = qp_solver_.optimize(P, A, q, lower_bound, upper_bound);
-  const std::vector<double> optval = std::get<0>(result);
+  // the workspace is kept and only its values are updated when the sparsity pattern is unchanged
+  qp_solver_.updateOrInitializeProblem(
+    autoware::common::osqp::calCSCMatrixTrapezoidal(P), autoware::common::osqp::calCSCMatrix(A),
+    q, lower_bound, upper_bound);
+  setWarmStart(
+    qp_solver_, *opt_resampled_trajectory, N, IDX_B0, IDX_A0, l_variables, l_constraints);
+  const int status_val = qp_solver_.optimize(primal_solution_, lagrange_multiplier_);
+  latest_iteration_num_ = qp_solver_.getTakenIter();
+  const std::vector<double> & optval = primal_solution_;
 
   const auto tf1 = std::chrono::system_clock::now();
   const double dt_ms1 =
@@ -304,9 +312,11 @@ bool JerkFilteredSmoother::apply(
     output.at(i).acceleration_mps2 = a_stop_decel;
   }
 
-  const int status_val = std::get<3>(result);
   if (status_val != 1) {
     RCLCPP_ERROR(logger_, "optimization failed : %s", qp_solver_.getStatusMessage().c_str());
+    resetWarmStart();
+  } else {
+    updateWarmStartTrajectory(output);
   }
 
   if (TMP_SHOW_DEBUG_INFO) {
@@ -54,6 +54,7 @@ bool L2PseudoJerkSmoother::apply(
   const auto ts = std::chrono::system_clock::now();
 
   output = input;
+  latest_iteration_num_ = 0;
 
   if (std::fabs(input.front().longitudinal_velocity_mps) < 0.1) {
     RCLCPP_DEBUG(logger_, "closest v_max < 0.1. assume vehicle stopped. return.");
@@ -181,11 +182,17 @@ bool L2PseudoJerkSmoother::apply(
 
   // execute optimization
   const auto ts2 = std::chrono::system_clock::now();
-  const auto result = qp_solver_.optimize(P, A, q, lower_bound, upper_bound);
+  // the workspace is kept and only its values are updated when the sparsity pattern is unchanged
+  qp_solver_.updateOrInitializeProblem(
+    autoware::common::osqp::calCSCMatrixTrapezoidal(P), autoware::common::osqp::calCSCMatrix(A),
+    q, lower_bound, upper_bound);
+  setWarmStart(qp_solver_, input, N, 0, N, l_variables, l_constraints);
+  const int status_val = qp_solver_.optimize(primal_solution_, lagrange_multiplier_);
+  latest_iteration_num_ = qp_solver_.getTakenIter();
 
   // [b0, b1, ..., bN, |  a0, a1, ..., aN, |
   //  delta0, delta1, ..., deltaN, | sigma0, sigma1, ..., sigmaN]
-  const std::vector<double> optval = std::get<0>(result);
+  const std::vector<double> & optval = primal_solution_;
 
   for (unsigned int i = 0; i < N; ++i) {
     double v = optval.at(i);
@@ -208,9 +215,11 @@ bool L2PseudoJerkSmoother::apply(
   //     v_max[i], optval.at(i + N), optval.at(i), optval.at(i + 2 * N), optval.at(i + 3 * N));
   // }
 
-  const int status_val = std::get<3>(result);
   if (status_val != 1) {
     RCLCPP_WARN(logger_, "optimization failed : %s", qp_solver_.getStatusMessage().c_str());
+    resetWarmStart();
+  } else {
+    updateWarmStartTrajectory(output);
   }
 
   const auto tf2 = std::chrono::system_clock::now();
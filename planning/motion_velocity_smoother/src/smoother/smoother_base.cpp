@@ -54,6 +54,8 @@ SmootherBase::SmootherBase(rclcpp::Node & node)
   p.resample_param.sparse_resample_dt = node.declare_parameter("sparse_resample_dt", 0.5);
   p.resample_param.sparse_min_interval_distance =
     node.declare_parameter("sparse_min_interval_distance", 4.0);
+  p.enable_warm_start = node.declare_parameter("enable_warm_start", true);
+  p.warm_start_max_lateral_offset = node.declare_parameter("warm_start_max_lateral_offset", 1.0);
 }
 
 void SmootherBase::setParam(const BaseParam & param) { base_param_ = param; }
@@ -68,6 +70,40 @@ double SmootherBase::getMaxJerk() const { return base_param_.max_jerk; }
 
 double SmootherBase::getMinJerk() const { return base_param_.min_jerk; }
 
+int64_t SmootherBase::getLatestIterationNum() const { return latest_iteration_num_; }
+
+void SmootherBase::resetWarmStart() { prev_optimized_trajectory_.clear(); }
+
+void SmootherBase::setWarmStart(
+  autoware::common::osqp::OSQPInterface & qp_solver, const TrajectoryPoints & trajectory,
+  const size_t N, const size_t idx_b0, const size_t idx_a0, const size_t l_variables,
+  const size_t l_constraints)
+{
+  qp_solver.updateWarmStart(base_param_.enable_warm_start);
+  if (!base_param_.enable_warm_start) {
+    return;
+  }
+
+  // The workspace keeps the solution of the previous cycle, but its indices do not correspond to
+  // the new trajectory. Set the initial guess explicitly, and cold start if it is not available.
+  warm_start_primal_.setZero(l_variables);
+  warm_start_dual_.setZero(l_constraints);
+  if (trajectory_utils::mapVelocityProfileByArcLength(
+        prev_optimized_trajectory_, trajectory, base_param_.warm_start_max_lateral_offset,
+        warm_start_velocity_, warm_start_acceleration_)) {
+    for (size_t i = 0; i < N; ++i) {
+      warm_start_primal_(idx_b0 + i) = warm_start_velocity_.at(i) * warm_start_velocity_.at(i);
+      warm_start_primal_(idx_a0 + i) = warm_start_acceleration_.at(i);
+    }
+  }
+  qp_solver.setWarmStart(warm_start_primal_, warm_start_dual_);
+}
+
+void SmootherBase::updateWarmStartTrajectory(const TrajectoryPoints & optimized_trajectory)
+{
+  prev_optimized_trajectory_ = optimized_trajectory;
+}
+
 boost::optional<TrajectoryPoints> SmootherBase::applyLateralAccelerationFilter(
   const TrajectoryPoints & input, [[maybe_unused]] const double v0,
   [[maybe_unused]] const double a0, [[maybe_unused]] const bool enable_smooth_limit) const
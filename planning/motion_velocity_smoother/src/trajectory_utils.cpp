@@ -18,6 +18,7 @@
 #include "interpolation/spline_interpolation.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <map>
 #include <tuple>
@@ -591,5 +592,53 @@ std::vector<double> calcVelocityProfileWithConstantJerkAndAccelerationLimit(
   return velocities;
 }
 
+bool mapVelocityProfileByArcLength(
+  const TrajectoryPoints & base_trajectory, const TrajectoryPoints & target_trajectory,
+  const double max_lateral_offset, std::vector<double> & velocity,
+  std::vector<double> & acceleration)
+{
+  if (base_trajectory.size() < 2 || target_trajectory.empty()) {
+    return false;
+  }
+
+  const auto & target_front = target_trajectory.front().pose.position;
+  const double lateral_offset = motion_utils::calcLateralOffset(base_trajectory, target_front);
+  if (!std::isfinite(lateral_offset) || std::fabs(lateral_offset) > max_lateral_offset) {
+    return false;
+  }
+
+  // arc length of the front point of the target trajectory on the base trajectory
+  const double front_offset = motion_utils::calcSignedArcLength(base_trajectory, 0, target_front);
+  const std::vector<double> base_arclength = calcArclengthArray(base_trajectory);
+
+  velocity.resize(target_trajectory.size());
+  acceleration.resize(target_trajectory.size());
+
+  // both trajectories are monotonic in arc length, so the base segment is searched only forward
+  size_t base_idx = 0;
+  double target_s = front_offset;
+  for (size_t i = 0; i < target_trajectory.size(); ++i) {
+    if (i > 0) {
+      target_s += tier4_autoware_utils::calcDistance2d(
+        target_trajectory.at(i - 1), target_trajectory.at(i));
+    }
+    const double s = std::clamp(target_s, 0.0, base_arclength.back());
+    while (base_idx + 2 < base_trajectory.size() && base_arclength.at(base_idx + 1) < s) {
+      ++base_idx;
+    }
+
+    const double seg_length = base_arclength.at(base_idx + 1) - base_arclength.at(base_idx);
+    const double ratio =
+      seg_length < 1e-6 ? 0.0 : std::clamp((s - base_arclength.at(base_idx)) / seg_length, 0.0, 1.0);
+    const auto & p0 = base_trajectory.at(base_idx);
+    const auto & p1 = base_trajectory.at(base_idx + 1);
+    velocity.at(i) =
+      interpolation::lerp(p0.longitudinal_velocity_mps, p1.longitudinal_velocity_mps, ratio);
+    acceleration.at(i) = interpolation::lerp(p0.acceleration_mps2, p1.acceleration_mps2, ratio);
+  }
+
+  return true;
+}
+
 }  // namespace trajectory_utils
 }  // namespace motion_velocity_smoother
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <vector>
 
 using autoware_auto_planning_msgs::msg::TrajectoryPoint;
@@ -61,3 +62,44 @@ TEST(TestTrajectoryUtils, CalcTrajectoryCurvatureFrom3Points)
     }
   }
 }
+
+TEST(TestTrajectoryUtils, MapVelocityProfileByArcLength)
+{
+  using motion_velocity_smoother::trajectory_utils::mapVelocityProfileByArcLength;
+
+  auto base = genStraightTrajectory(10);
+  for (size_t i = 0; i < base.size(); ++i) {
+    base.at(i).longitudinal_velocity_mps = static_cast<double>(i);
+    base.at(i).acceleration_mps2 = 0.5 * static_cast<double>(i);
+  }
+
+  // the target trajectory starts 2.5 m ahead of the base one with a denser interval
+  TrajectoryPoints target;
+  for (size_t i = 0; i < 20; ++i) {
+    TrajectoryPoint p;
+    p.pose.position.x = 2.5 + 0.5 * static_cast<double>(i);
+    p.pose.orientation.w = 1.0;
+    target.push_back(p);
+  }
+
+  std::vector<double> velocity;
+  std::vector<double> acceleration;
+  ASSERT_TRUE(mapVelocityProfileByArcLength(base, target, 1.0, velocity, acceleration));
+  ASSERT_EQ(velocity.size(), target.size());
+  ASSERT_EQ(acceleration.size(), target.size());
+  for (size_t i = 0; i < target.size(); ++i) {
+    const double expected_v = std::min(target.at(i).pose.position.x, 9.0);
+    EXPECT_NEAR(velocity.at(i), expected_v, 1e-6) << "i = " << i;
+    EXPECT_NEAR(acceleration.at(i), 0.5 * expected_v, 1e-6) << "i = " << i;
+  }
+
+  // the target trajectory is too far from the base one
+  for (auto & p : target) {
+    p.pose.position.y = 2.0;
+  }
+  EXPECT_FALSE(mapVelocityProfileByArcLength(base, target, 1.0, velocity, acceleration));
+
+  // the base trajectory is not enough to map the profile
+  EXPECT_FALSE(mapVelocityProfileByArcLength(
+    genStraightTrajectory(1), genStraightTrajectory(3), 1.0, velocity, acceleration));
+}
@@ -24,17 +24,80 @@
 #include "geometry_msgs/msg/pose.hpp"
 
 #include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #include <boost/optional.hpp>
 
 #include <limits>
+#include <utility>
 #include <vector>
 
 namespace polygon_utils
 {
 namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+using tier4_autoware_utils::Box2d;
 using tier4_autoware_utils::Point2d;
 using tier4_autoware_utils::Polygon2d;
 
+/**
+ * @brief collision checker between the ego trajectory footprints and the obstacles
+ * @details The one step polygons of the trajectory are indexed by an R-tree of their bounding boxes
+ * once per cycle. The obstacle polygons are rejected by their bounding boxes before the exact
+ * polygon intersection, so that the results are the same as the brute force functions below.
+ * The const member functions are thread-safe, so obstacles can be checked in parallel.
+ * The trajectory and its polygons are referenced, and have to outlive the checker.
+ */
+class CollisionChecker
+{
+public:
+  CollisionChecker(
+    const autoware_auto_planning_msgs::msg::Trajectory & traj,
+    const std::vector<Polygon2d> & traj_polygons);
+
+  boost::optional<size_t> getCollisionIndex(
+    const geometry_msgs::msg::PoseStamped & obj_pose,
+    const autoware_auto_perception_msgs::msg::Shape & shape,
+    std::vector<geometry_msgs::msg::PointStamped> & collision_points,
+    const double max_dist = std::numeric_limits<double>::max()) const;
+
+  std::vector<geometry_msgs::msg::PointStamped> getCollisionPoints(
+    const std_msgs::msg::Header & obj_header,
+    const autoware_auto_perception_msgs::msg::PredictedPath & predicted_path,
+    const autoware_auto_perception_msgs::msg::Shape & shape, const rclcpp::Time & current_time,
+    const double vehicle_max_longitudinal_offset, const bool is_driving_forward,
+    std::vector<size_t> & collision_index,
+    const double max_dist = std::numeric_limits<double>::max(),
+    const double max_prediction_time_for_collision_check = std::numeric_limits<double>::max()) const;
+
+  std::vector<geometry_msgs::msg::PointStamped> willCollideWithSurroundObstacle(
+    const std_msgs::msg::Header & obj_header,
+    const autoware_auto_perception_msgs::msg::PredictedPath & predicted_path,
+    const autoware_auto_perception_msgs::msg::Shape & shape, const rclcpp::Time & current_time,
+    const double max_dist, const double ego_obstacle_overlap_time_threshold,
+    const double max_prediction_time_for_collision_check, std::vector<size_t> & collision_index,
+    const double vehicle_max_longitudinal_offset, const bool is_driving_forward) const;
+
+private:
+  using BoxIndex = std::pair<Box2d, size_t>;
+
+  // polygon of the obstacle at a time step of the predicted path
+  struct ObstacleStep
+  {
+    geometry_msgs::msg::PoseStamped pose;
+    Polygon2d polygon;
+    Box2d box;
+  };
+
+  boost::optional<size_t> getCollisionIndex(
+    const ObstacleStep & obj_step, std::vector<geometry_msgs::msg::PointStamped> & collision_points,
+    const double max_dist) const;
+
+  const autoware_auto_planning_msgs::msg::Trajectory & traj_;
+  const std::vector<Polygon2d> & traj_polygons_;
+  Box2d traj_box_;
+  bgi::rtree<BoxIndex, bgi::rstar<16>> rtree_;
+};
+
 boost::optional<size_t> getCollisionIndex(
   const autoware_auto_planning_msgs::msg::Trajectory & traj,
   const std::vector<Polygon2d> & traj_polygons, const geometry_msgs::msg::PoseStamped & obj_pose,
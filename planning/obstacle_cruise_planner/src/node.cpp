@@ -26,6 +26,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <string>
+#include <vector>
 
 namespace
 {
@@ -692,7 +694,20 @@ std::vector<TargetObstacle> ObstacleCruisePlannerNode::filterObstacles(
     extended_traj, vehicle_info_, obstacle_filtering_param_.detection_area_expand_width);
   debug_data.detection_polygons = extended_traj_polygons;
 
-  std::vector<TargetObstacle> target_obstacles;
+  // build the collision checker of the trajectory polygons once per cycle
+  const polygon_utils::CollisionChecker collision_checker(extended_traj, extended_traj_polygons);
+  const auto traj_points = motion_utils::convertToTrajectoryPointArray(traj);
+
+  // rough detection area filtering without polygons
+  struct ObstacleCandidate
+  {
+    const PredictedObject * object;
+    std::string object_id;
+    geometry_msgs::msg::PoseStamped current_pose;
+    double dist_to_traj;
+    double max_length;
+  };
+  std::vector<ObstacleCandidate> candidates;
   for (const auto & predicted_object : predicted_objects.objects) {
     const auto object_id = toHexString(predicted_object.object_id).substr(0, 4);
 
@@ -708,12 +723,9 @@ std::vector<TargetObstacle> ObstacleCruisePlannerNode::filterObstacles(
 
     const auto current_object_pose = obstacle_cruise_utils::getCurrentObjectPose(
       predicted_object, predicted_objects.header, current_time, true);
-    const auto & object_velocity =
-      predicted_object.kinematics.initial_twist_with_covariance.twist.linear.x;
 
-    const bool is_front_obstacle = isFrontObstacle(
-      motion_utils::convertToTrajectoryPointArray(traj), ego_idx,
-      current_object_pose.pose.position);
+    const bool is_front_obstacle =
+      isFrontObstacle(traj_points, ego_idx, current_object_pose.pose.position);
     if (!is_front_obstacle) {
       RCLCPP_INFO_EXPRESSION(
         get_logger(), is_showing_debug_info_,
@@ -721,11 +733,8 @@ std::vector<TargetObstacle> ObstacleCruisePlannerNode::filterObstacles(
       continue;
     }
 
-    // rough detection area filtering without polygons
-    const double dist_from_obstacle_to_traj = [&]() {
-      return motion_utils::calcLateralOffset(
-        extended_traj.points, current_object_pose.pose.position);
-    }();
+    const double dist_from_obstacle_to_traj =
+      motion_utils::calcLateralOffset(extended_traj.points, current_object_pose.pose.position);
     const double obstacle_max_length = calcObjectMaxLength(predicted_object.shape);
     if (
       std::fabs(dist_from_obstacle_to_traj) >
@@ -737,30 +746,96 @@ std::vector<TargetObstacle> ObstacleCruisePlannerNode::filterObstacles(
       continue;
     }
 
+    candidates.push_back(ObstacleCandidate{
+      &predicted_object, object_id, current_object_pose, dist_from_obstacle_to_traj,
+      obstacle_max_length});
+  }
+
+  // reason to ignore the obstacle outside the trajectory before checking its predicted path
+  const auto getOutsideObstacleIgnoredReason =
+    [&](const ObstacleCandidate & candidate) -> boost::optional<std::string> {
+    const auto & predicted_object = *candidate.object;
+    const auto & types = obstacle_filtering_param_.ignored_outside_obstacle_types;
+    if (
+      std::find(types.begin(), types.end(), predicted_object.classification.front().label) !=
+      types.end()) {
+      return std::string("its type is not designated");
+    }
+
+    if (
+      std::fabs(candidate.dist_to_traj) >
+      vehicle_info_.vehicle_width_m + candidate.max_length +
+        obstacle_filtering_param_.outside_rough_detection_area_expand_width) {
+      return std::string("it is far from the trajectory");
+    }
+
+    const double object_vel =
+      predicted_object.kinematics.initial_twist_with_covariance.twist.linear.x;
+    if (std::fabs(object_vel) < obstacle_filtering_param_.outside_obstacle_min_velocity_threshold) {
+      return std::string("the obstacle velocity is low");
+    }
+    return {};
+  };
+
+  // precise detection area filtering with polygons
+  // NOTE: The obstacles are independent of each other, so they are checked in parallel.
+  struct CollisionResult
+  {
+    boost::optional<size_t> first_within_idx;
+    std::vector<geometry_msgs::msg::PointStamped> collision_points;
+    std::vector<size_t> collision_index;
+  };
+  std::vector<CollisionResult> collision_results(candidates.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const auto & candidate = candidates.at(i);
+    const auto & predicted_object = *candidate.object;
+    auto & result = collision_results.at(i);
+
+    // calculate current collision points
+    std::vector<geometry_msgs::msg::PointStamped> closest_collision_points;
+    result.first_within_idx = collision_checker.getCollisionIndex(
+      candidate.current_pose, predicted_object.shape, closest_collision_points);
+    if (!result.first_within_idx && getOutsideObstacleIgnoredReason(candidate)) {
+      continue;
+    }
+
     // Get highest confidence predicted path
     const auto predicted_path = getHighestConfidencePredictedPath(predicted_object);
     const auto resampled_predicted_path = perception_utils::resamplePredictedPath(
       predicted_path, obstacle_filtering_param_.prediction_resampling_time_interval,
       obstacle_filtering_param_.prediction_resampling_time_horizon);
 
-    // calculate current collision points
-    std::vector<geometry_msgs::msg::PointStamped> closest_collision_points;
-    const auto first_within_idx = polygon_utils::getCollisionIndex(
-      extended_traj, extended_traj_polygons, current_object_pose, predicted_object.shape,
-      closest_collision_points);
-
-    // precise detection area filtering with polygons
-    std::vector<geometry_msgs::msg::PointStamped> collision_points;
-    std::vector<size_t> collision_index;
-    if (first_within_idx) {  // obstacles inside the trajectory
+    if (result.first_within_idx) {  // obstacles inside the trajectory
       // calculate nearest collision point
-      collision_points = polygon_utils::getCollisionPoints(
-        extended_traj, extended_traj_polygons, predicted_objects.header, resampled_predicted_path,
-        predicted_object.shape, current_time, vehicle_info_.max_longitudinal_offset_m,
-        is_driving_forward, collision_index);
+      result.collision_points = collision_checker.getCollisionPoints(
+        predicted_objects.header, resampled_predicted_path, predicted_object.shape, current_time,
+        vehicle_info_.max_longitudinal_offset_m, is_driving_forward, result.collision_index);
+    } else {  // obstacles outside the trajectory
+      result.collision_points = collision_checker.willCollideWithSurroundObstacle(
+        predicted_objects.header, resampled_predicted_path, predicted_object.shape, current_time,
+        vehicle_info_.vehicle_width_m + obstacle_filtering_param_.rough_detection_area_expand_width,
+        obstacle_filtering_param_.ego_obstacle_overlap_time_threshold,
+        obstacle_filtering_param_.max_prediction_time_for_collision_check, result.collision_index,
+        vehicle_info_.max_longitudinal_offset_m, is_driving_forward);
+    }
+  }
 
+  std::vector<TargetObstacle> target_obstacles;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    const auto & candidate = candidates.at(i);
+    const auto & predicted_object = *candidate.object;
+    const auto & object_id = candidate.object_id;
+    const auto & collision_points = collision_results.at(i).collision_points;
+    const auto & collision_index = collision_results.at(i).collision_index;
+
+    if (collision_results.at(i).first_within_idx) {  // obstacles inside the trajectory
+      const auto & object_velocity =
+        predicted_object.kinematics.initial_twist_with_covariance.twist.linear.x;
       const bool is_angle_aligned = isAngleAlignedWithTrajectory(
-        extended_traj, current_object_pose.pose,
+        extended_traj, candidate.current_pose.pose,
         obstacle_filtering_param_.crossing_obstacle_traj_angle_threshold);
       const double has_high_speed =
         std::abs(object_velocity) > obstacle_filtering_param_.crossing_obstacle_velocity_threshold;
@@ -782,45 +857,14 @@ std::vector<TargetObstacle> ObstacleCruisePlannerNode::filterObstacles(
         }
       }
     } else {  // obstacles outside the trajectory
-      const auto & types = obstacle_filtering_param_.ignored_outside_obstacle_types;
-      if (
-        std::find(types.begin(), types.end(), predicted_object.classification.front().label) !=
-        types.end()) {
+      const auto ignored_reason = getOutsideObstacleIgnoredReason(candidate);
+      if (ignored_reason) {
         RCLCPP_INFO_EXPRESSION(
-          get_logger(), is_showing_debug_info_,
-          "Ignore outside obstacle (%s) since its type is not designated.", object_id.c_str());
+          get_logger(), is_showing_debug_info_, "Ignore outside obstacle (%s) since %s.",
+          object_id.c_str(), ignored_reason->c_str());
         continue;
       }
 
-      if (
-        std::fabs(dist_from_obstacle_to_traj) >
-        vehicle_info_.vehicle_width_m + obstacle_max_length +
-          obstacle_filtering_param_.outside_rough_detection_area_expand_width) {
-        RCLCPP_INFO_EXPRESSION(
-          get_logger(), is_showing_debug_info_,
-          "Ignore outside obstacle (%s) since it is far from the trajectory.", object_id.c_str());
-        continue;
-      }
-
-      const double object_vel =
-        predicted_object.kinematics.initial_twist_with_covariance.twist.linear.x;
-      if (
-        std::fabs(object_vel) < obstacle_filtering_param_.outside_obstacle_min_velocity_threshold) {
-        RCLCPP_INFO_EXPRESSION(
-          get_logger(), is_showing_debug_info_,
-          "Ignore outside obstacle (%s) since the obstacle velocity is low.", object_id.c_str());
-        continue;
-      }
-
-      std::vector<size_t> collision_index;
-      collision_points = polygon_utils::willCollideWithSurroundObstacle(
-        extended_traj, extended_traj_polygons, predicted_objects.header, resampled_predicted_path,
-        predicted_object.shape, current_time,
-        vehicle_info_.vehicle_width_m + obstacle_filtering_param_.rough_detection_area_expand_width,
-        obstacle_filtering_param_.ego_obstacle_overlap_time_threshold,
-        obstacle_filtering_param_.max_prediction_time_for_collision_check, collision_index,
-        vehicle_info_.max_longitudinal_offset_m, is_driving_forward);
-
       if (collision_points.empty()) {
         // Ignore vehicle obstacles outside the trajectory, whose predicted path
         // overlaps the ego trajectory in a certain time.
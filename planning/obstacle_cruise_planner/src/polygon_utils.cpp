@@ -17,6 +17,8 @@
 #include "motion_utils/trajectory/trajectory.hpp"
 #include "tier4_autoware_utils/geometry/boost_polygon_utils.hpp"
 
+#include <algorithm>
+
 namespace
 {
 namespace bg = boost::geometry;
@@ -199,6 +201,170 @@ std::vector<geometry_msgs::msg::PointStamped> willCollideWithSurroundObstacle(
   return collision_points;
 }
 
+CollisionChecker::CollisionChecker(
+  const autoware_auto_planning_msgs::msg::Trajectory & traj,
+  const std::vector<Polygon2d> & traj_polygons)
+: traj_(traj), traj_polygons_(traj_polygons)
+{
+  bg::assign_inverse(traj_box_);
+
+  std::vector<BoxIndex> boxes;
+  boxes.reserve(traj_polygons.size());
+  for (size_t i = 0; i < traj_polygons.size(); ++i) {
+    const auto box = bg::return_envelope<Box2d>(traj_polygons.at(i));
+    bg::expand(traj_box_, box);
+    boxes.emplace_back(box, i);
+  }
+
+  // packing algorithm is used when the rtree is constructed from a range
+  rtree_ = bgi::rtree<BoxIndex, bgi::rstar<16>>(boxes.begin(), boxes.end());
+}
+
+boost::optional<size_t> CollisionChecker::getCollisionIndex(
+  const geometry_msgs::msg::PoseStamped & obj_pose,
+  const autoware_auto_perception_msgs::msg::Shape & shape,
+  std::vector<geometry_msgs::msg::PointStamped> & collision_points, const double max_dist) const
+{
+  ObstacleStep obj_step;
+  obj_step.pose = obj_pose;
+  obj_step.polygon = tier4_autoware_utils::toPolygon2d(obj_pose.pose, shape);
+  obj_step.box = bg::return_envelope<Box2d>(obj_step.polygon);
+  return getCollisionIndex(obj_step, collision_points, max_dist);
+}
+
+boost::optional<size_t> CollisionChecker::getCollisionIndex(
+  const ObstacleStep & obj_step, std::vector<geometry_msgs::msg::PointStamped> & collision_points,
+  const double max_dist) const
+{
+  // broad phase: the trajectory polygons whose bounding boxes overlap with the obstacle
+  std::vector<BoxIndex> candidates;
+  rtree_.query(bgi::intersects(obj_step.box), std::back_inserter(candidates));
+  if (candidates.empty()) {
+    return {};
+  }
+
+  // narrow phase: check the candidates from the front of the trajectory as the brute force way
+  std::sort(candidates.begin(), candidates.end(), [](const BoxIndex & a, const BoxIndex & b) {
+    return a.second < b.second;
+  });
+  for (const auto & candidate : candidates) {
+    const size_t i = candidate.second;
+    const double approximated_dist =
+      tier4_autoware_utils::calcDistance2d(traj_.points.at(i).pose, obj_step.pose.pose);
+    if (approximated_dist > max_dist) {
+      continue;
+    }
+
+    std::vector<Polygon2d> collision_polygons;
+    bg::intersection(traj_polygons_.at(i), obj_step.polygon, collision_polygons);
+
+    bool has_collision = false;
+    for (const auto & collision_polygon : collision_polygons) {
+      if (bg::area(collision_polygon) > 0.0) {
+        has_collision = true;
+
+        for (const auto & collision_point : collision_polygon.outer()) {
+          geometry_msgs::msg::PointStamped collision_geom_point;
+          collision_geom_point.header = obj_step.pose.header;
+          collision_geom_point.point.x = collision_point.x();
+          collision_geom_point.point.y = collision_point.y();
+          collision_points.push_back(collision_geom_point);
+        }
+      }
+    }
+
+    if (has_collision) {
+      return i;
+    }
+  }
+
+  return {};
+}
+
+std::vector<geometry_msgs::msg::PointStamped> CollisionChecker::getCollisionPoints(
+  const std_msgs::msg::Header & obj_header,
+  const autoware_auto_perception_msgs::msg::PredictedPath & predicted_path,
+  const autoware_auto_perception_msgs::msg::Shape & shape, const rclcpp::Time & current_time,
+  const double vehicle_max_longitudinal_offset, const bool is_driving_forward,
+  std::vector<size_t> & collision_index, const double max_dist,
+  const double max_prediction_time_for_collision_check) const
+{
+  // rasterize the predicted path into the time-indexed obstacle polygons
+  std::vector<ObstacleStep> obj_steps;
+  obj_steps.reserve(predicted_path.path.size());
+  Box2d swept_box;
+  bg::assign_inverse(swept_box);
+  for (size_t i = 0; i < predicted_path.path.size(); ++i) {
+    if (
+      max_prediction_time_for_collision_check <
+      rclcpp::Duration(predicted_path.time_step).seconds() * static_cast<double>(i)) {
+      break;
+    }
+
+    const auto object_time =
+      rclcpp::Time(obj_header.stamp) + rclcpp::Duration(predicted_path.time_step) * i;
+    // Ignore past position
+    if ((object_time - current_time).seconds() < 0.0) {
+      continue;
+    }
+
+    ObstacleStep obj_step;
+    obj_step.pose.header.frame_id = obj_header.frame_id;
+    obj_step.pose.header.stamp = object_time;
+    obj_step.pose.pose = predicted_path.path.at(i);
+    obj_step.polygon = tier4_autoware_utils::toPolygon2d(obj_step.pose.pose, shape);
+    obj_step.box = bg::return_envelope<Box2d>(obj_step.polygon);
+    bg::expand(swept_box, obj_step.box);
+    obj_steps.push_back(obj_step);
+  }
+
+  // reject the whole swept volume of the obstacle at once
+  if (obj_steps.empty() || !bg::intersects(swept_box, traj_box_)) {
+    return {};
+  }
+
+  std::vector<geometry_msgs::msg::PointStamped> collision_points;
+  for (const auto & obj_step : obj_steps) {
+    std::vector<geometry_msgs::msg::PointStamped> current_collision_points;
+    const auto collision_idx = getCollisionIndex(obj_step, current_collision_points, max_dist);
+    if (collision_idx) {
+      const auto nearest_collision_point = calcNearestCollisionPoint(
+        *collision_idx, current_collision_points, traj_, vehicle_max_longitudinal_offset,
+        is_driving_forward);
+      collision_points.push_back(nearest_collision_point);
+      collision_index.push_back(*collision_idx);
+    }
+  }
+
+  return collision_points;
+}
+
+std::vector<geometry_msgs::msg::PointStamped> CollisionChecker::willCollideWithSurroundObstacle(
+  const std_msgs::msg::Header & obj_header,
+  const autoware_auto_perception_msgs::msg::PredictedPath & predicted_path,
+  const autoware_auto_perception_msgs::msg::Shape & shape, const rclcpp::Time & current_time,
+  const double max_dist, const double ego_obstacle_overlap_time_threshold,
+  const double max_prediction_time_for_collision_check, std::vector<size_t> & collision_index,
+  const double vehicle_max_longitudinal_offset, const bool is_driving_forward) const
+{
+  const auto collision_points = getCollisionPoints(
+    obj_header, predicted_path, shape, current_time, vehicle_max_longitudinal_offset,
+    is_driving_forward, collision_index, max_dist, max_prediction_time_for_collision_check);
+
+  if (collision_points.empty()) {
+    return {};
+  }
+
+  const double overlap_time = (rclcpp::Time(collision_points.back().header.stamp) -
+                               rclcpp::Time(collision_points.front().header.stamp))
+                                .seconds();
+  if (overlap_time < ego_obstacle_overlap_time_threshold) {
+    return {};
+  }
+
+  return collision_points;
+}
+
 std::vector<Polygon2d> createOneStepPolygons(
   const autoware_auto_planning_msgs::msg::Trajectory & traj,
   const vehicle_info_util::VehicleInfo & vehicle_info, const double expand_width)
@@ -31,8 +31,10 @@
 
 #include <boost/optional.hpp>
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -56,6 +58,35 @@ using vehicle_info_util::VehicleInfo;
 using TrajectoryPoints = std::vector<TrajectoryPoint>;
 using PointCloud = pcl::PointCloud<pcl::PointXYZ>;
 
+/**
+ * @brief uniform 2d grid that buckets point indices by their xy cell. it is built once per frame
+ *        so that each trajectory step only visits the points around its own search area.
+ */
+class GridIndex2d
+{
+public:
+  explicit GridIndex2d(const double cell_size);
+
+  void insert(const double x, const double y, const size_t index);
+
+  /**
+   * @brief append indices of the points stored in the cells overlapping the given box
+   * @detail the result is a superset of the points in the box and is not sorted
+   */
+  void query(
+    const double min_x, const double min_y, const double max_x, const double max_y,
+    std::vector<size_t> & indices) const;
+
+  bool empty() const { return cells_.empty(); }
+
+private:
+  int64_t toCellIndex(const double v) const;
+  static int64_t toKey(const int64_t ix, const int64_t iy);
+
+  double cell_size_;
+  std::unordered_map<int64_t, std::vector<size_t>> cells_;
+};
+
 bool validCheckDecelPlan(
   const double v_end, const double a_end, const double v_target, const double a_target,
   const double v_margin, const double a_margin);
@@ -131,6 +162,16 @@ bool withinPolygon(
   const Point2d & next_point, PointCloud::Ptr candidate_points_ptr,
   PointCloud::Ptr within_points_ptr);
 
+/**
+ * @brief same as withinPolygon() but only tests the given candidate indices
+ * @param (candidate_indices) indices into candidate_points, in ascending order
+ * @param (within_indices) indices of the points inside the polygon are appended in the same order
+ */
+bool withinPolygon(
+  const std::vector<cv::Point2d> & cv_polygon, const double radius, const Point2d & prev_point,
+  const Point2d & next_point, const PointCloud & candidate_points,
+  const std::vector<size_t> & candidate_indices, std::vector<size_t> & within_indices);
+
 bool convexHull(
   const std::vector<cv::Point2d> & pointcloud, std::vector<cv::Point2d> & polygon_points);
 
@@ -324,7 +324,6 @@ void ObstacleStopPlannerNode::searchObstacle(
   const StopParam & stop_param, const PointCloud2::SharedPtr obstacle_ros_pointcloud_ptr)
 {
   // search candidate obstacle pointcloud
-  PointCloud::Ptr slow_down_pointcloud_ptr(new PointCloud);
   PointCloud::Ptr obstacle_candidate_pointcloud_ptr(new PointCloud);
   if (!searchPointcloudNearTrajectory(
         decimate_trajectory, obstacle_ros_pointcloud_ptr, obstacle_candidate_pointcloud_ptr,
@@ -332,6 +331,44 @@ void ObstacleStopPlannerNode::searchObstacle(
     return;
   }
 
+  // bucket the candidate points once per frame so that each step only visits the cells which its
+  // one step polygon overlaps instead of the whole candidate pointcloud
+  const auto & candidate_points = *obstacle_candidate_pointcloud_ptr;
+  GridIndex2d candidate_index(stop_param.step_length);
+  for (size_t j = 0; j < candidate_points.size(); ++j) {
+    candidate_index.insert(candidate_points.at(j).x, candidate_points.at(j).y, j);
+  }
+
+  // points found in the slow-down range of the current or previous steps. only these points are
+  // checked against the vehicle polygon when slow-down is enabled.
+  std::vector<bool> is_slow_down_point(candidate_points.size(), !node_param_.enable_slow_down);
+
+  std::vector<size_t> step_indices;
+  std::vector<size_t> within_indices;
+  const auto queryCandidateIndices = [&](const std::vector<cv::Point2d> & polygon) {
+    step_indices.clear();
+    within_indices.clear();
+    double min_x = std::numeric_limits<double>::max();
+    double min_y = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    for (const auto & p : polygon) {
+      min_x = std::min(min_x, p.x);
+      min_y = std::min(min_y, p.y);
+      max_x = std::max(max_x, p.x);
+      max_y = std::max(max_y, p.y);
+    }
+    candidate_index.query(min_x, min_y, max_x, max_y, step_indices);
+    // keep the original order of the pointcloud
+    std::sort(step_indices.begin(), step_indices.end());
+  };
+  const auto extractPoints = [&](const std::vector<size_t> & indices, PointCloud & output) {
+    output.reserve(indices.size());
+    for (const auto j : indices) {
+      output.push_back(candidate_points.at(j));
+    }
+  };
+
   for (size_t i = 0; i < decimate_trajectory.size() - 1; ++i) {
     // create one step circle center for vehicle
     const auto & p_front = decimate_trajectory.at(i).pose;
@@ -350,23 +387,29 @@ void ObstacleStopPlannerNode::searchObstacle(
       debug_ptr_->pushPolygon(
         one_step_move_slow_down_range_polygon, p_front.position.z, PolygonType::SlowDownRange);
 
+      queryCandidateIndices(one_step_move_slow_down_range_polygon);
       planner_data.found_slow_down_points = withinPolygon(
         one_step_move_slow_down_range_polygon, slow_down_param_.slow_down_search_radius,
-        prev_center_point, next_center_point, obstacle_candidate_pointcloud_ptr,
-        slow_down_pointcloud_ptr);
+        prev_center_point, next_center_point, candidate_points, step_indices, within_indices);
+      for (const auto j : within_indices) {
+        is_slow_down_point.at(j) = true;
+      }
 
       const auto found_first_slow_down_points =
         planner_data.found_slow_down_points && !planner_data.slow_down_require;
 
       if (found_first_slow_down_points) {
+        PointCloud slow_down_pointcloud;
+        extractPoints(within_indices, slow_down_pointcloud);
+
         // found nearest slow down obstacle
         planner_data.decimate_trajectory_slow_down_index = i;
         planner_data.slow_down_require = true;
         getNearestPoint(
-          *slow_down_pointcloud_ptr, p_front, &planner_data.nearest_slow_down_point,
+          slow_down_pointcloud, p_front, &planner_data.nearest_slow_down_point,
           &planner_data.nearest_collision_point_time);
         getLateralNearestPoint(
-          *slow_down_pointcloud_ptr, p_front, &planner_data.lateral_nearest_slow_down_point,
+          slow_down_pointcloud, p_front, &planner_data.lateral_nearest_slow_down_point,
           &planner_data.lateral_deviation);
 
         debug_ptr_->pushObstaclePoint(planner_data.nearest_slow_down_point, PointType::SlowDown);
@@ -375,9 +418,6 @@ void ObstacleStopPlannerNode::searchObstacle(
 
         last_detect_time_slowdown_point_ = trajectory_header.stamp;
       }
-
-    } else {
-      slow_down_pointcloud_ptr = obstacle_candidate_pointcloud_ptr;
     }
 
     {
@@ -389,17 +429,26 @@ void ObstacleStopPlannerNode::searchObstacle(
         one_step_move_vehicle_polygon, decimate_trajectory.at(i).pose.position.z,
         PolygonType::Vehicle);
 
-      PointCloud::Ptr collision_pointcloud_ptr(new PointCloud);
-      collision_pointcloud_ptr->header = obstacle_candidate_pointcloud_ptr->header;
-
+      queryCandidateIndices(one_step_move_vehicle_polygon);
+      step_indices.erase(
+        std::remove_if(
+          step_indices.begin(), step_indices.end(),
+          [&](const size_t j) { return !is_slow_down_point.at(j); }),
+        step_indices.end());
       planner_data.found_collision_points = withinPolygon(
         one_step_move_vehicle_polygon, stop_param.stop_search_radius, prev_center_point,
-        next_center_point, slow_down_pointcloud_ptr, collision_pointcloud_ptr);
+        next_center_point, candidate_points, step_indices, within_indices);
 
+      // trajectory steps are visited in arc length order, so the first step with collision points
+      // is the nearest collision and the search can stop here
       if (planner_data.found_collision_points) {
+        PointCloud collision_pointcloud;
+        collision_pointcloud.header = candidate_points.header;
+        extractPoints(within_indices, collision_pointcloud);
+
         planner_data.decimate_trajectory_collision_index = i;
         getNearestPoint(
-          *collision_pointcloud_ptr, p_front, &planner_data.nearest_collision_point,
+          collision_pointcloud, p_front, &planner_data.nearest_collision_point,
           &planner_data.nearest_collision_point_time);
 
         debug_ptr_->pushObstaclePoint(planner_data.nearest_collision_point, PointType::Stop);
@@ -887,12 +936,22 @@ bool ObstacleStopPlannerNode::searchPointcloudNearTrajectory(
   const double squared_radius = search_radius * search_radius;
   std::vector<geometry_msgs::msg::Point> center_points;
   center_points.reserve(trajectory.size());
-  for (const auto & trajectory_point : trajectory)
+  // bucket the center points by search radius so that each point only has to check the centers in
+  // its neighboring cells
+  GridIndex2d center_index(search_radius);
+  for (const auto & trajectory_point : trajectory) {
     center_points.push_back(getVehicleCenterFromBase(trajectory_point.pose, vehicle_info).position);
+    center_index.insert(center_points.back().x, center_points.back().y, center_points.size() - 1);
+  }
+  std::vector<size_t> center_indices;
   for (const auto & point : transformed_points_ptr->points) {
-    for (const auto & center_point : center_points) {
-      const double x = center_point.x - point.x;
-      const double y = center_point.y - point.y;
+    center_indices.clear();
+    center_index.query(
+      point.x - search_radius, point.y - search_radius, point.x + search_radius,
+      point.y + search_radius, center_indices);
+    for (const auto j : center_indices) {
+      const double x = center_points.at(j).x - point.x;
+      const double y = center_points.at(j).y - point.y;
       const double squared_distance = x * x + y * y;
       if (squared_distance < squared_radius) {
         output_points_ptr->points.push_back(point);
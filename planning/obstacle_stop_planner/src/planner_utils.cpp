@@ -23,6 +23,8 @@
 
 #include <pcl_conversions/pcl_conversions.h>
 
+#include <cmath>
+
 namespace motion_planning
 {
 
@@ -449,6 +451,70 @@ bool withinPolygon(
   return find_within_points;
 }
 
+bool withinPolygon(
+  const std::vector<cv::Point2d> & cv_polygon, const double radius, const Point2d & prev_point,
+  const Point2d & next_point, const PointCloud & candidate_points,
+  const std::vector<size_t> & candidate_indices, std::vector<size_t> & within_indices)
+{
+  Polygon2d boost_polygon;
+  bool find_within_points = false;
+  for (const auto & point : cv_polygon) {
+    boost_polygon.outer().push_back(bg::make<Point2d>(point.x, point.y));
+  }
+  boost_polygon.outer().push_back(bg::make<Point2d>(cv_polygon.front().x, cv_polygon.front().y));
+
+  for (const auto j : candidate_indices) {
+    Point2d point(candidate_points.at(j).x, candidate_points.at(j).y);
+    if (bg::distance(prev_point, point) < radius || bg::distance(next_point, point) < radius) {
+      if (bg::within(point, boost_polygon)) {
+        within_indices.push_back(j);
+        find_within_points = true;
+      }
+    }
+  }
+  return find_within_points;
+}
+
+GridIndex2d::GridIndex2d(const double cell_size) : cell_size_(cell_size) {}
+
+void GridIndex2d::insert(const double x, const double y, const size_t index)
+{
+  cells_[toKey(toCellIndex(x), toCellIndex(y))].push_back(index);
+}
+
+void GridIndex2d::query(
+  const double min_x, const double min_y, const double max_x, const double max_y,
+  std::vector<size_t> & indices) const
+{
+  if (cells_.empty()) {
+    return;
+  }
+
+  const auto min_ix = toCellIndex(min_x);
+  const auto min_iy = toCellIndex(min_y);
+  const auto max_ix = toCellIndex(max_x);
+  const auto max_iy = toCellIndex(max_y);
+  for (int64_t ix = min_ix; ix <= max_ix; ++ix) {
+    for (int64_t iy = min_iy; iy <= max_iy; ++iy) {
+      const auto itr = cells_.find(toKey(ix, iy));
+      if (itr != cells_.end()) {
+        indices.insert(indices.end(), itr->second.begin(), itr->second.end());
+      }
+    }
+  }
+}
+
+int64_t GridIndex2d::toCellIndex(const double v) const
+{
+  return static_cast<int64_t>(std::floor(v / cell_size_));
+}
+
+int64_t GridIndex2d::toKey(const int64_t ix, const int64_t iy)
+{
+  return static_cast<int64_t>(
+    (static_cast<uint64_t>(ix) << 32) ^ (static_cast<uint64_t>(iy) & 0xffffffffULL));
+}
+
 bool convexHull(
   const std::vector<cv::Point2d> & pointcloud, std::vector<cv::Point2d> & polygon_points)
 {
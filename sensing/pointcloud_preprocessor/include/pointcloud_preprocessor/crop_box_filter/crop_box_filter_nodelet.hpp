@@ -54,6 +54,7 @@
 #define POINTCLOUD_PREPROCESSOR__CROP_BOX_FILTER__CROP_BOX_FILTER_NODELET_HPP_
 
 #include "pointcloud_preprocessor/filter.hpp"
+#include "pointcloud_preprocessor/utility/crop_regions.hpp"
 
 #include <geometry_msgs/msg/polygon_stamped.hpp>
 
@@ -81,8 +82,15 @@ private:
     float min_z;
     float max_z;
     bool negative{false};
+    // min_x, max_x, min_y, max_y, min_z, max_z of each box cropped together with the main box
+    std::vector<double> additional_boxes;
   } param_;
 
+  /** \brief The main box and the additional boxes, tested in one pass */
+  utils::CropRegions crop_regions_;
+
+  void updateCropRegions();
+
   rclcpp::Publisher<geometry_msgs::msg::PolygonStamped>::SharedPtr crop_box_polygon_pub_;
 
   /** \brief Parameter service callback result : needed to be hold */
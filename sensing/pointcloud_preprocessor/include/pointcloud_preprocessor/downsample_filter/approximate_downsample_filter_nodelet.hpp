@@ -53,7 +53,7 @@
 
 #include "pointcloud_preprocessor/filter.hpp"
 
-#include <tier4_pcl_extensions/voxel_grid_nearest_centroid.hpp>
+#include <tier4_pcl_extensions/fast_voxel_grid_nearest_centroid.hpp>
 
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/search/pcl_search.h>
@@ -76,6 +76,9 @@ private:
   double voxel_size_y_;
   double voxel_size_z_;
 
+  /** \brief Kept between frames so that its work buffers are reused */
+  pcl::FastVoxelGridNearestCentroid<pcl::PointXYZ> voxel_filter_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
   explicit ApproximateDownsampleFilterComponent(const rclcpp::NodeOptions & options);
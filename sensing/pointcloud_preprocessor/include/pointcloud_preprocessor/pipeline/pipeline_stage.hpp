@@ -0,0 +1,151 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef POINTCLOUD_PREPROCESSOR__PIPELINE__PIPELINE_STAGE_HPP_
+#define POINTCLOUD_PREPROCESSOR__PIPELINE__PIPELINE_STAGE_HPP_
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pointcloud_preprocessor
+{
+using sensor_msgs::msg::PointCloud2;
+
+/** \brief A filter stage of PointCloudPipelineComponent. All stages work on the same buffer and
+ * remove points by clearing their entry in the keep mask; the buffer is compacted only once after
+ * the last stage.
+ */
+class PipelineStage
+{
+public:
+  explicit PipelineStage(const std::string & name) : name_(name) {}
+  virtual ~PipelineStage() = default;
+
+  const std::string & getName() const { return name_; }
+
+  /** \brief Point-wise stages decide from a single point. Consecutive point-wise stages are fused
+   * into one pass over the buffer. */
+  virtual bool isPointwise() const = 0;
+
+  /** \brief Resolve field offsets of the cloud. Called once per message before any point is
+   * visited. Return false when the point layout is not supported. */
+  virtual bool configure(const PointCloud2 & cloud) = 0;
+
+  /** \brief Point-wise stages: return whether the point starting at `point` is kept. */
+  virtual bool keep([[maybe_unused]] const uint8_t * point) const { return true; }
+
+  /** \brief Batch stages: clear the mask of the points to remove. Points whose mask is already
+   * cleared must be ignored. */
+  virtual void apply(
+    [[maybe_unused]] const PointCloud2 & cloud, [[maybe_unused]] std::vector<uint8_t> & mask)
+  {
+  }
+
+  /** \brief Apply updated parameters, named `<stage name>.<parameter>`. */
+  virtual void updateParameters(const std::vector<rclcpp::Parameter> & p) = 0;
+
+protected:
+  std::string name_;
+};
+
+/** \brief Remove points inside (or outside when `negative` is set) of an axis aligned box. */
+class CropBoxStage : public PipelineStage
+{
+public:
+  CropBoxStage(rclcpp::Node & node, const std::string & name);
+
+  bool isPointwise() const override { return true; }
+  bool configure(const PointCloud2 & cloud) override;
+  bool keep(const uint8_t * point) const override;
+  void updateParameters(const std::vector<rclcpp::Parameter> & p) override;
+
+private:
+  float min_x_, min_y_, min_z_;
+  float max_x_, max_y_, max_z_;
+  bool negative_;
+  uint32_t x_offset_{0}, y_offset_{0}, z_offset_{0};
+};
+
+/** \brief Keep points whose float32 field is within [min, max] (outside when `negative`). */
+class PassThroughStage : public PipelineStage
+{
+public:
+  PassThroughStage(rclcpp::Node & node, const std::string & name);
+
+  bool isPointwise() const override { return true; }
+  bool configure(const PointCloud2 & cloud) override;
+  bool keep(const uint8_t * point) const override;
+  void updateParameters(const std::vector<rclcpp::Parameter> & p) override;
+
+private:
+  std::string field_name_;
+  float min_value_;
+  float max_value_;
+  bool negative_;
+  uint32_t field_offset_{0};
+};
+
+/** \brief Same algorithm as RingOutlierFilterComponent, requires ring, azimuth and distance. */
+class RingOutlierStage : public PipelineStage
+{
+public:
+  RingOutlierStage(rclcpp::Node & node, const std::string & name);
+
+  bool isPointwise() const override { return false; }
+  bool configure(const PointCloud2 & cloud) override;
+  void apply(const PointCloud2 & cloud, std::vector<uint8_t> & mask) override;
+  void updateParameters(const std::vector<rclcpp::Parameter> & p) override;
+
+private:
+  bool isCluster(const PointCloud2 & cloud, const std::vector<size_t> & point_indices) const;
+
+  double distance_ratio_;
+  double object_length_threshold_;
+  int num_points_threshold_;
+  uint32_t x_offset_{0}, y_offset_{0}, z_offset_{0};
+  uint32_t ring_offset_{0}, azimuth_offset_{0}, distance_offset_{0};
+};
+
+/** \brief Keep the input point nearest to the centroid of each voxel. Unlike
+ * VoxelGridDownsampleFilterComponent no new point is synthesized, so the point layout is kept. */
+class VoxelGridDownsampleStage : public PipelineStage
+{
+public:
+  VoxelGridDownsampleStage(rclcpp::Node & node, const std::string & name);
+
+  bool isPointwise() const override { return false; }
+  bool configure(const PointCloud2 & cloud) override;
+  void apply(const PointCloud2 & cloud, std::vector<uint8_t> & mask) override;
+  void updateParameters(const std::vector<rclcpp::Parameter> & p) override;
+
+private:
+  float voxel_size_x_;
+  float voxel_size_y_;
+  float voxel_size_z_;
+  uint32_t x_offset_{0}, y_offset_{0}, z_offset_{0};
+};
+
+/** \brief Create the stage registered as `type`, or nullptr if there is none. */
+std::unique_ptr<PipelineStage> createPipelineStage(
+  const std::string & type, rclcpp::Node & node, const std::string & name);
+
+}  // namespace pointcloud_preprocessor
+
+#endif  // POINTCLOUD_PREPROCESSOR__PIPELINE__PIPELINE_STAGE_HPP_
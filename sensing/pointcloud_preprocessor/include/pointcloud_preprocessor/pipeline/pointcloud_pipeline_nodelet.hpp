@@ -0,0 +1,63 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef POINTCLOUD_PREPROCESSOR__PIPELINE__POINTCLOUD_PIPELINE_NODELET_HPP_
+#define POINTCLOUD_PREPROCESSOR__PIPELINE__POINTCLOUD_PIPELINE_NODELET_HPP_
+
+#include "pointcloud_preprocessor/filter.hpp"
+#include "pointcloud_preprocessor/pipeline/pipeline_stage.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pointcloud_preprocessor
+{
+class PointCloudPipelineComponent : public pointcloud_preprocessor::Filter
+{
+protected:
+  virtual void filter(
+    const PointCloud2ConstPtr & input, const IndicesPtr & indices, PointCloud2 & output);
+
+private:
+  /** \brief Consecutive point-wise stages run in one pass, a batch stage runs alone. */
+  struct StageGroup
+  {
+    std::vector<PipelineStage *> stages;
+    bool is_pointwise;
+  };
+
+  std::vector<std::unique_ptr<PipelineStage>> stages_;
+  std::vector<StageGroup> stage_groups_;
+
+  /** \brief Keep flag of each point in the buffer, reused between messages */
+  std::vector<uint8_t> keep_mask_;
+
+  /** \brief Parameter service callback result : needed to be hold */
+  OnSetParametersCallbackHandle::SharedPtr set_param_res_;
+
+  /** \brief Parameter service callback */
+  rcl_interfaces::msg::SetParametersResult paramCallback(const std::vector<rclcpp::Parameter> & p);
+
+  void runPointwiseStages(const std::vector<PipelineStage *> & stages, const PointCloud2 & cloud);
+  void compact(PointCloud2 & cloud) const;
+
+public:
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+  explicit PointCloudPipelineComponent(const rclcpp::NodeOptions & options);
+};
+
+}  // namespace pointcloud_preprocessor
+
+#endif  // POINTCLOUD_PREPROCESSOR__PIPELINE__POINTCLOUD_PIPELINE_NODELET_HPP_
@@ -0,0 +1,74 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef POINTCLOUD_PREPROCESSOR__UTILITY__CROP_REGIONS_HPP_
+#define POINTCLOUD_PREPROCESSOR__UTILITY__CROP_REGIONS_HPP_
+
+#include <sensor_msgs/msg/point_cloud2.hpp>
+
+#include <vector>
+
+namespace pointcloud_preprocessor::utils
+{
+struct CropBox
+{
+  float min_x;
+  float max_x;
+  float min_y;
+  float max_y;
+  float min_z;
+  float max_z;
+};
+
+/** \brief A set of boxes and 2D polygons (unbounded in z) tested against every point in one pass.
+ * Points are tested in batches of 64 with SSE or AVX when the compiler enables them, and the
+ * survivors are compacted from a per-batch bit mask.
+ */
+class CropRegions
+{
+public:
+  void addBox(const CropBox & box);
+
+  /** \brief Add a polygon given by its vertices. It is closed automatically. */
+  void addPolygon(const std::vector<float> & xs, const std::vector<float> & ys);
+
+  void clear();
+  bool empty() const { return boxes_.empty() && polygons_.empty(); }
+
+  /** \brief Copy the points inside (`negative` is false) or outside (`negative` is true) of the
+   * regions to `output`, keeping the point layout of `input`.
+   * Inside means strictly inside of at least one box or inside of at least one polygon. Outside
+   * means strictly outside of every box and outside of every polygon. Points with a NaN coordinate
+   * are never inside nor outside of a box.
+   */
+  void filter(
+    const sensor_msgs::msg::PointCloud2 & input, const bool negative,
+    sensor_msgs::msg::PointCloud2 & output) const;
+
+private:
+  struct Polygon
+  {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    // dx / dy of each edge, 0 for horizontal edges
+    std::vector<float> inverse_slopes;
+    float min_x, max_x, min_y, max_y;
+  };
+
+  std::vector<CropBox> boxes_;
+  std::vector<Polygon> polygons_;
+};
+}  // namespace pointcloud_preprocessor::utils
+
+#endif  // POINTCLOUD_PREPROCESSOR__UTILITY__CROP_REGIONS_HPP_
@@ -80,6 +80,13 @@ CropBoxFilterComponent::CropBoxFilterComponent(const rclcpp::NodeOptions & optio
     p.max_y = static_cast<float>(declare_parameter("max_y", 1.0));
     p.max_z = static_cast<float>(declare_parameter("max_z", 1.0));
     p.negative = static_cast<float>(declare_parameter("negative", false));
+    p.additional_boxes =
+      declare_parameter<std::vector<double>>("additional_boxes", std::vector<double>{});
+    if (p.additional_boxes.size() % 6 != 0) {
+      throw std::length_error(
+        "additional_boxes must have a list of min_x, max_x, min_y, max_y, min_z, max_z.");
+    }
+    updateCropRegions();
   }
 
   // set additional publishers
@@ -102,44 +109,7 @@ void CropBoxFilterComponent::filter(
 {
   std::scoped_lock lock(mutex_);
   stop_watch_ptr_->toc("processing_time", true);
-  output.data.resize(input->data.size());
-  Eigen::Vector3f pt(Eigen::Vector3f::Zero());
-  size_t j = 0;
-  const auto data_size = input->data.size();
-  const auto point_step = input->point_step;
-  // If inside the cropbox
-  if (!param_.negative) {
-    for (size_t i = 0; i + point_step < data_size; i += point_step) {
-      memcpy(pt.data(), &input->data[i], sizeof(float) * 3);
-      if (
-        param_.min_z < pt.z() && pt.z() < param_.max_z && param_.min_y < pt.y() &&
-        pt.y() < param_.max_y && param_.min_x < pt.x() && pt.x() < param_.max_x) {
-        memcpy(&output.data[j], &input->data[i], point_step);
-        j += point_step;
-      }
-    }
-    // If outside the cropbox
-  } else {
-    for (size_t i = 0; i + point_step < data_size; i += point_step) {
-      memcpy(pt.data(), &input->data[i], sizeof(float) * 3);
-      if (
-        param_.min_z > pt.z() || pt.z() > param_.max_z || param_.min_y > pt.y() ||
-        pt.y() > param_.max_y || param_.min_x > pt.x() || pt.x() > param_.max_x) {
-        memcpy(&output.data[j], &input->data[i], point_step);
-        j += point_step;
-      }
-    }
-  }
-
-  output.data.resize(j);
-  output.header.frame_id = input->header.frame_id;
-  output.height = 1;
-  output.fields = input->fields;
-  output.is_bigendian = input->is_bigendian;
-  output.point_step = input->point_step;
-  output.is_dense = input->is_dense;
-  output.width = static_cast<uint32_t>(output.data.size() / output.height / output.point_step);
-  output.row_step = static_cast<uint32_t>(output.data.size() / output.height);
+  crop_regions_.filter(*input, param_.negative, output);
 
   publishCropBoxPolygon();
   // add processing time for debug
@@ -153,6 +123,20 @@ void CropBoxFilterComponent::filter(
   }
 }
 
+void CropBoxFilterComponent::updateCropRegions()
+{
+  crop_regions_.clear();
+  crop_regions_.addBox(
+    {param_.min_x, param_.max_x, param_.min_y, param_.max_y, param_.min_z, param_.max_z});
+  const auto & boxes = param_.additional_boxes;
+  for (size_t i = 0; i + 5 < boxes.size(); i += 6) {
+    crop_regions_.addBox(
+      {static_cast<float>(boxes[i]), static_cast<float>(boxes[i + 1]),
+       static_cast<float>(boxes[i + 2]), static_cast<float>(boxes[i + 3]),
+       static_cast<float>(boxes[i + 4]), static_cast<float>(boxes[i + 5])});
+  }
+}
+
 void CropBoxFilterComponent::publishCropBoxPolygon()
 {
   auto generatePoint = [](double x, double y, double z) {
@@ -230,8 +214,22 @@ rcl_interfaces::msg::SetParametersResult CropBoxFilterComponent::paramCallback(
       RCLCPP_DEBUG(
         get_logger(), "[%s::paramCallback] Setting the filter negative flag to: %s.", get_name(),
         new_param.negative ? "true" : "false");
+      new_param.additional_boxes = param_.additional_boxes;
       param_ = new_param;
+      updateCropRegions();
+    }
+  }
+
+  std::vector<double> additional_boxes;
+  if (get_param(p, "additional_boxes", additional_boxes)) {
+    if (additional_boxes.size() % 6 != 0) {
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = false;
+      result.reason = "additional_boxes must have a multiple of 6 elements";
+      return result;
     }
+    param_.additional_boxes = additional_boxes;
+    updateCropRegions();
   }
 
   rcl_interfaces::msg::SetParametersResult result;
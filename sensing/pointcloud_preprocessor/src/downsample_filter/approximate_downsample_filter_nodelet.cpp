@@ -82,10 +82,9 @@ void ApproximateDownsampleFilterComponent::filter(
   pcl::PointCloud<pcl::PointXYZ>::Ptr pcl_output(new pcl::PointCloud<pcl::PointXYZ>);
   pcl::fromROSMsg(*input, *pcl_input);
   pcl_output->points.reserve(pcl_input->points.size());
-  pcl::VoxelGridNearestCentroid<pcl::PointXYZ> filter;
-  filter.setInputCloud(pcl_input);
-  filter.setLeafSize(voxel_size_x_, voxel_size_y_, voxel_size_z_);
-  filter.filter(*pcl_output);
+  voxel_filter_.setInputCloud(pcl_input);
+  voxel_filter_.setLeafSize(voxel_size_x_, voxel_size_y_, voxel_size_z_);
+  voxel_filter_.filter(*pcl_output);
 
   pcl::toROSMsg(*pcl_output, output);
   output.header = input->header;
@@ -0,0 +1,347 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pointcloud_preprocessor/pipeline/pipeline_stage.hpp"
+
+#include "pointcloud_preprocessor/filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+using sensor_msgs::msg::PointField;
+
+bool getFieldOffset(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & name, const uint8_t datatype,
+  uint32_t & offset)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == name) {
+      if (field.datatype != datatype) {
+        return false;
+      }
+      offset = field.offset;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool getXYZOffsets(
+  const sensor_msgs::msg::PointCloud2 & cloud, uint32_t & x_offset, uint32_t & y_offset,
+  uint32_t & z_offset)
+{
+  return getFieldOffset(cloud, "x", PointField::FLOAT32, x_offset) &&
+         getFieldOffset(cloud, "y", PointField::FLOAT32, y_offset) &&
+         getFieldOffset(cloud, "z", PointField::FLOAT32, z_offset);
+}
+
+template <typename T>
+T readField(const uint8_t * point, const uint32_t offset)
+{
+  T value;
+  std::memcpy(&value, point + offset, sizeof(T));
+  return value;
+}
+}  // namespace
+
+namespace pointcloud_preprocessor
+{
+CropBoxStage::CropBoxStage(rclcpp::Node & node, const std::string & name) : PipelineStage(name)
+{
+  min_x_ = static_cast<float>(node.declare_parameter(name + ".min_x", -1.0));
+  min_y_ = static_cast<float>(node.declare_parameter(name + ".min_y", -1.0));
+  min_z_ = static_cast<float>(node.declare_parameter(name + ".min_z", -1.0));
+  max_x_ = static_cast<float>(node.declare_parameter(name + ".max_x", 1.0));
+  max_y_ = static_cast<float>(node.declare_parameter(name + ".max_y", 1.0));
+  max_z_ = static_cast<float>(node.declare_parameter(name + ".max_z", 1.0));
+  negative_ = static_cast<bool>(node.declare_parameter(name + ".negative", false));
+}
+
+bool CropBoxStage::configure(const PointCloud2 & cloud)
+{
+  return getXYZOffsets(cloud, x_offset_, y_offset_, z_offset_);
+}
+
+bool CropBoxStage::keep(const uint8_t * point) const
+{
+  const auto x = readField<float>(point, x_offset_);
+  const auto y = readField<float>(point, y_offset_);
+  const auto z = readField<float>(point, z_offset_);
+  if (!negative_) {
+    return min_z_ < z && z < max_z_ && min_y_ < y && y < max_y_ && min_x_ < x && x < max_x_;
+  }
+  return min_z_ > z || z > max_z_ || min_y_ > y || y > max_y_ || min_x_ > x || x > max_x_;
+}
+
+void CropBoxStage::updateParameters(const std::vector<rclcpp::Parameter> & p)
+{
+  double value;
+  if (get_param(p, name_ + ".min_x", value)) min_x_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".min_y", value)) min_y_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".min_z", value)) min_z_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".max_x", value)) max_x_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".max_y", value)) max_y_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".max_z", value)) max_z_ = static_cast<float>(value);
+  get_param(p, name_ + ".negative", negative_);
+}
+
+PassThroughStage::PassThroughStage(rclcpp::Node & node, const std::string & name)
+: PipelineStage(name)
+{
+  field_name_ = static_cast<std::string>(node.declare_parameter(name + ".field_name", "z"));
+  min_value_ = static_cast<float>(node.declare_parameter(name + ".min_value", -1.0));
+  max_value_ = static_cast<float>(node.declare_parameter(name + ".max_value", 1.0));
+  negative_ = static_cast<bool>(node.declare_parameter(name + ".negative", false));
+}
+
+bool PassThroughStage::configure(const PointCloud2 & cloud)
+{
+  return getFieldOffset(cloud, field_name_, PointField::FLOAT32, field_offset_);
+}
+
+bool PassThroughStage::keep(const uint8_t * point) const
+{
+  const auto value = readField<float>(point, field_offset_);
+  const bool is_inside = min_value_ <= value && value <= max_value_;
+  return is_inside != negative_;
+}
+
+void PassThroughStage::updateParameters(const std::vector<rclcpp::Parameter> & p)
+{
+  double value;
+  get_param(p, name_ + ".field_name", field_name_);
+  if (get_param(p, name_ + ".min_value", value)) min_value_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".max_value", value)) max_value_ = static_cast<float>(value);
+  get_param(p, name_ + ".negative", negative_);
+}
+
+RingOutlierStage::RingOutlierStage(rclcpp::Node & node, const std::string & name)
+: PipelineStage(name)
+{
+  distance_ratio_ = static_cast<double>(node.declare_parameter(name + ".distance_ratio", 1.03));
+  object_length_threshold_ =
+    static_cast<double>(node.declare_parameter(name + ".object_length_threshold", 0.1));
+  num_points_threshold_ =
+    static_cast<int>(node.declare_parameter(name + ".num_points_threshold", 4));
+}
+
+bool RingOutlierStage::configure(const PointCloud2 & cloud)
+{
+  return getXYZOffsets(cloud, x_offset_, y_offset_, z_offset_) &&
+         getFieldOffset(cloud, "ring", PointField::UINT16, ring_offset_) &&
+         getFieldOffset(cloud, "azimuth", PointField::FLOAT32, azimuth_offset_) &&
+         getFieldOffset(cloud, "distance", PointField::FLOAT32, distance_offset_);
+}
+
+void RingOutlierStage::apply(const PointCloud2 & cloud, std::vector<uint8_t> & mask)
+{
+  const auto * data = cloud.data.data();
+  const size_t point_step = cloud.point_step;
+
+  std::unordered_map<uint16_t, std::vector<size_t>> ring_map;
+  ring_map.reserve(128);
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (mask[i]) {
+      ring_map[readField<uint16_t>(data + i * point_step, ring_offset_)].push_back(i);
+    }
+  }
+
+  // every point is dropped unless it belongs to a segment that is a cluster
+  std::vector<size_t> segment;
+  for (const auto & ring : ring_map) {
+    const auto & ring_indices = ring.second;
+    for (const auto & i : ring_indices) {
+      mask[i] = 0;
+    }
+    if (ring_indices.size() < 2) {
+      continue;
+    }
+
+    segment.clear();
+    for (size_t idx = 0; idx + 1 < ring_indices.size(); ++idx) {
+      const auto * current_pt = data + ring_indices[idx] * point_step;
+      const auto * next_pt = data + ring_indices[idx + 1] * point_step;
+      segment.push_back(ring_indices[idx]);
+
+      float azimuth_diff = readField<float>(next_pt, azimuth_offset_) -
+                           readField<float>(current_pt, azimuth_offset_);
+      azimuth_diff = azimuth_diff < 0.f ? azimuth_diff + 36000.f : azimuth_diff;
+
+      const auto current_distance = readField<float>(current_pt, distance_offset_);
+      const auto next_distance = readField<float>(next_pt, distance_offset_);
+      if (
+        std::max(current_distance, next_distance) <
+          std::min(current_distance, next_distance) * distance_ratio_ &&
+        azimuth_diff < 100.f) {
+        continue;
+      }
+      if (isCluster(cloud, segment)) {
+        for (const auto & i : segment) {
+          mask[i] = 1;
+        }
+      }
+      segment.clear();
+    }
+    if (!segment.empty() && isCluster(cloud, segment)) {
+      for (const auto & i : segment) {
+        mask[i] = 1;
+      }
+    }
+  }
+}
+
+bool RingOutlierStage::isCluster(
+  const PointCloud2 & cloud, const std::vector<size_t> & point_indices) const
+{
+  const auto * front_pt = cloud.data.data() + point_indices.front() * cloud.point_step;
+  const auto * back_pt = cloud.data.data() + point_indices.back() * cloud.point_step;
+
+  const auto x_diff = readField<float>(front_pt, x_offset_) - readField<float>(back_pt, x_offset_);
+  const auto y_diff = readField<float>(front_pt, y_offset_) - readField<float>(back_pt, y_offset_);
+  const auto z_diff = readField<float>(front_pt, z_offset_) - readField<float>(back_pt, z_offset_);
+  return static_cast<int>(point_indices.size()) > num_points_threshold_ ||
+         (x_diff * x_diff) + (y_diff * y_diff) + (z_diff * z_diff) >=
+           object_length_threshold_ * object_length_threshold_;
+}
+
+void RingOutlierStage::updateParameters(const std::vector<rclcpp::Parameter> & p)
+{
+  get_param(p, name_ + ".distance_ratio", distance_ratio_);
+  get_param(p, name_ + ".object_length_threshold", object_length_threshold_);
+  get_param(p, name_ + ".num_points_threshold", num_points_threshold_);
+}
+
+VoxelGridDownsampleStage::VoxelGridDownsampleStage(rclcpp::Node & node, const std::string & name)
+: PipelineStage(name)
+{
+  voxel_size_x_ = static_cast<float>(node.declare_parameter(name + ".voxel_size_x", 0.3));
+  voxel_size_y_ = static_cast<float>(node.declare_parameter(name + ".voxel_size_y", 0.3));
+  voxel_size_z_ = static_cast<float>(node.declare_parameter(name + ".voxel_size_z", 0.1));
+}
+
+bool VoxelGridDownsampleStage::configure(const PointCloud2 & cloud)
+{
+  return getXYZOffsets(cloud, x_offset_, y_offset_, z_offset_);
+}
+
+void VoxelGridDownsampleStage::apply(const PointCloud2 & cloud, std::vector<uint8_t> & mask)
+{
+  struct Voxel
+  {
+    double sum_x{0.0}, sum_y{0.0}, sum_z{0.0};
+    size_t num_points{0};
+    size_t nearest_index{0};
+    double nearest_distance{std::numeric_limits<double>::max()};
+  };
+
+  // 21 bits per axis is enough for any practical range and voxel size
+  const auto toKey = [this](const float x, const float y, const float z) {
+    constexpr int64_t bias = int64_t{1} << 20;
+    constexpr int64_t bit_mask = (int64_t{1} << 21) - 1;
+    const auto ix = static_cast<int64_t>(std::floor(x / voxel_size_x_)) + bias;
+    const auto iy = static_cast<int64_t>(std::floor(y / voxel_size_y_)) + bias;
+    const auto iz = static_cast<int64_t>(std::floor(z / voxel_size_z_)) + bias;
+    return ((ix & bit_mask) << 42) | ((iy & bit_mask) << 21) | (iz & bit_mask);
+  };
+
+  const auto * data = cloud.data.data();
+  const size_t point_step = cloud.point_step;
+
+  std::unordered_map<int64_t, Voxel> voxels;
+  std::vector<int64_t> keys(mask.size());
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (!mask[i]) {
+      continue;
+    }
+    const auto * pt = data + i * point_step;
+    const auto x = readField<float>(pt, x_offset_);
+    const auto y = readField<float>(pt, y_offset_);
+    const auto z = readField<float>(pt, z_offset_);
+    keys[i] = toKey(x, y, z);
+    auto & voxel = voxels[keys[i]];
+    voxel.sum_x += x;
+    voxel.sum_y += y;
+    voxel.sum_z += z;
+    ++voxel.num_points;
+  }
+
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (!mask[i]) {
+      continue;
+    }
+    const auto * pt = data + i * point_step;
+    auto & voxel = voxels.at(keys[i]);
+    const auto n = static_cast<double>(voxel.num_points);
+    const double dx = readField<float>(pt, x_offset_) - voxel.sum_x / n;
+    const double dy = readField<float>(pt, y_offset_) - voxel.sum_y / n;
+    const double dz = readField<float>(pt, z_offset_) - voxel.sum_z / n;
+    const double distance = dx * dx + dy * dy + dz * dz;
+    if (distance < voxel.nearest_distance) {
+      voxel.nearest_distance = distance;
+      voxel.nearest_index = i;
+    }
+  }
+
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (mask[i] && voxels.at(keys[i]).nearest_index != i) {
+      mask[i] = 0;
+    }
+  }
+}
+
+void VoxelGridDownsampleStage::updateParameters(const std::vector<rclcpp::Parameter> & p)
+{
+  double value;
+  if (get_param(p, name_ + ".voxel_size_x", value)) voxel_size_x_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".voxel_size_y", value)) voxel_size_y_ = static_cast<float>(value);
+  if (get_param(p, name_ + ".voxel_size_z", value)) voxel_size_z_ = static_cast<float>(value);
+}
+
+std::unique_ptr<PipelineStage> createPipelineStage(
+  const std::string & type, rclcpp::Node & node, const std::string & name)
+{
+  using Factory =
+    std::function<std::unique_ptr<PipelineStage>(rclcpp::Node &, const std::string &)>;
+  static const std::unordered_map<std::string, Factory> registry = {
+    {"crop_box",
+     [](rclcpp::Node & n, const std::string & s) { return std::make_unique<CropBoxStage>(n, s); }},
+    {"passthrough",
+     [](rclcpp::Node & n, const std::string & s) {
+       return std::make_unique<PassThroughStage>(n, s);
+     }},
+    {"ring_outlier",
+     [](rclcpp::Node & n, const std::string & s) {
+       return std::make_unique<RingOutlierStage>(n, s);
+     }},
+    {"voxel_grid_downsample",
+     [](rclcpp::Node & n, const std::string & s) {
+       return std::make_unique<VoxelGridDownsampleStage>(n, s);
+     }},
+  };
+
+  const auto it = registry.find(type);
+  if (it == registry.end()) {
+    return nullptr;
+  }
+  return it->second(node, name);
+}
+}  // namespace pointcloud_preprocessor
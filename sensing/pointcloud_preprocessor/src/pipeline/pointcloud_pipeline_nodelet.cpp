@@ -0,0 +1,173 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pointcloud_preprocessor/pipeline/pointcloud_pipeline_nodelet.hpp"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pointcloud_preprocessor
+{
+PointCloudPipelineComponent::PointCloudPipelineComponent(const rclcpp::NodeOptions & options)
+: Filter("PointCloudPipeline", options)
+{
+  // initialize debug tool
+  {
+    using tier4_autoware_utils::DebugPublisher;
+    using tier4_autoware_utils::StopWatch;
+    stop_watch_ptr_ = std::make_unique<StopWatch<std::chrono::milliseconds>>();
+    debug_publisher_ = std::make_unique<DebugPublisher>(this, "pointcloud_pipeline");
+    stop_watch_ptr_->tic("cyclic_time");
+    stop_watch_ptr_->tic("processing_time");
+  }
+
+  // create stages
+  {
+    const auto stage_names =
+      declare_parameter<std::vector<std::string>>("stages", std::vector<std::string>{});
+    for (const auto & stage_name : stage_names) {
+      const auto type = declare_parameter<std::string>(stage_name + ".type", "");
+      auto stage = createPipelineStage(type, *this, stage_name);
+      if (!stage) {
+        throw std::invalid_argument(
+          "unknown pipeline stage type \"" + type + "\" for stage \"" + stage_name + "\"");
+      }
+      stages_.push_back(std::move(stage));
+    }
+
+    for (const auto & stage : stages_) {
+      if (
+        stage->isPointwise() && !stage_groups_.empty() && stage_groups_.back().is_pointwise) {
+        stage_groups_.back().stages.push_back(stage.get());
+        continue;
+      }
+      stage_groups_.push_back(StageGroup{{stage.get()}, stage->isPointwise()});
+    }
+  }
+
+  using std::placeholders::_1;
+  set_param_res_ = this->add_on_set_parameters_callback(
+    std::bind(&PointCloudPipelineComponent::paramCallback, this, _1));
+}
+
+void PointCloudPipelineComponent::filter(
+  const PointCloud2ConstPtr & input, [[maybe_unused]] const IndicesPtr & indices,
+  PointCloud2 & output)
+{
+  std::scoped_lock lock(mutex_);
+  stop_watch_ptr_->toc("processing_time", true);
+
+  // the output is the only copy of the points, every stage works on it in place
+  output = *input;
+  output.height = 1;
+
+  for (const auto & stage : stages_) {
+    if (!stage->configure(output)) {
+      RCLCPP_WARN_THROTTLE(
+        get_logger(), *get_clock(), 5000,
+        "input point layout is not supported by stage \"%s\", skip filtering",
+        stage->getName().c_str());
+      return;
+    }
+  }
+
+  keep_mask_.assign(output.data.size() / output.point_step, 1);
+
+  for (const auto & group : stage_groups_) {
+    const auto & group_name = group.stages.front()->getName();
+    stop_watch_ptr_->tic(group_name);
+    if (group.is_pointwise) {
+      runPointwiseStages(group.stages, output);
+    } else {
+      group.stages.front()->apply(output, keep_mask_);
+    }
+    if (debug_publisher_) {
+      debug_publisher_->publish<tier4_debug_msgs::msg::Float64Stamped>(
+        "debug/" + group_name + "/processing_time_ms", stop_watch_ptr_->toc(group_name, true));
+    }
+  }
+
+  compact(output);
+
+  // add processing time for debug
+  if (debug_publisher_) {
+    const double cyclic_time_ms = stop_watch_ptr_->toc("cyclic_time", true);
+    const double processing_time_ms = stop_watch_ptr_->toc("processing_time", true);
+    debug_publisher_->publish<tier4_debug_msgs::msg::Float64Stamped>(
+      "debug/cyclic_time_ms", cyclic_time_ms);
+    debug_publisher_->publish<tier4_debug_msgs::msg::Float64Stamped>(
+      "debug/processing_time_ms", processing_time_ms);
+  }
+}
+
+void PointCloudPipelineComponent::runPointwiseStages(
+  const std::vector<PipelineStage *> & stages, const PointCloud2 & cloud)
+{
+  const auto * data = cloud.data.data();
+  const size_t point_step = cloud.point_step;
+  for (size_t i = 0; i < keep_mask_.size(); ++i) {
+    if (!keep_mask_[i]) {
+      continue;
+    }
+    const auto * point = data + i * point_step;
+    for (const auto * stage : stages) {
+      if (!stage->keep(point)) {
+        keep_mask_[i] = 0;
+        break;
+      }
+    }
+  }
+}
+
+void PointCloudPipelineComponent::compact(PointCloud2 & cloud) const
+{
+  const size_t point_step = cloud.point_step;
+  size_t num_kept = 0;
+  for (size_t i = 0; i < keep_mask_.size(); ++i) {
+    if (!keep_mask_[i]) {
+      continue;
+    }
+    if (num_kept != i) {
+      std::memcpy(&cloud.data[num_kept * point_step], &cloud.data[i * point_step], point_step);
+    }
+    ++num_kept;
+  }
+
+  cloud.data.resize(num_kept * point_step);
+  cloud.width = static_cast<uint32_t>(num_kept);
+  cloud.row_step = static_cast<uint32_t>(cloud.data.size());
+}
+
+rcl_interfaces::msg::SetParametersResult PointCloudPipelineComponent::paramCallback(
+  const std::vector<rclcpp::Parameter> & p)
+{
+  std::scoped_lock lock(mutex_);
+
+  for (const auto & stage : stages_) {
+    stage->updateParameters(p);
+  }
+
+  rcl_interfaces::msg::SetParametersResult result;
+  result.successful = true;
+  result.reason = "success";
+
+  return result;
+}
+}  // namespace pointcloud_preprocessor
+
+#include <rclcpp_components/register_node_macro.hpp>
+RCLCPP_COMPONENTS_REGISTER_NODE(pointcloud_preprocessor::PointCloudPipelineComponent)
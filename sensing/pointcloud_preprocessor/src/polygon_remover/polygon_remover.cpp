@@ -14,6 +14,8 @@
 
 #include "pointcloud_preprocessor/polygon_remover/polygon_remover.hpp"
 
+#include <vector>
+
 namespace pointcloud_preprocessor
 {
 PolygonRemoverComponent::PolygonRemoverComponent(const rclcpp::NodeOptions & options)
@@ -68,6 +70,14 @@ void PolygonRemoverComponent::update_polygon(
   const geometry_msgs::msg::Polygon::ConstSharedPtr & polygon_in)
 {
   pointcloud_preprocessor::utils::to_cgal_polygon(*polygon_in, polygon_cgal_);
+  std::vector<float> xs;
+  std::vector<float> ys;
+  for (const auto & vertex : polygon_cgal_) {
+    xs.push_back(static_cast<float>(vertex.x()));
+    ys.push_back(static_cast<float>(vertex.y()));
+  }
+  crop_regions_.clear();
+  crop_regions_.addPolygon(xs, ys);
   if (will_visualize_) {
     marker_.ns = "";
     marker_.id = 0;
@@ -129,8 +139,7 @@ sensor_msgs::msg::PointCloud2 PolygonRemoverComponent::remove_updated_polygon_fr
   }
 
   PointCloud2 cloud_out;
-  pointcloud_preprocessor::utils::remove_polygon_cgal_from_cloud(
-    *cloud_in, polygon_cgal_, cloud_out);
+  crop_regions_.filter(*cloud_in, true, cloud_out);
   return cloud_out;
 }
 }  // namespace pointcloud_preprocessor
@@ -0,0 +1,320 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pointcloud_preprocessor/utility/crop_regions.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr size_t batch_size = 64;
+
+/** \brief Coordinates of up to 64 points, the bit i of a mask stands for the point i */
+struct Batch
+{
+  alignas(32) float x[batch_size];
+  alignas(32) float y[batch_size];
+  alignas(32) float z[batch_size];
+  size_t size;
+};
+
+uint64_t getLowBits(const size_t n) { return n >= 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1; }
+
+uint64_t getInsideBoxBits(const Batch & b, const pointcloud_preprocessor::utils::CropBox & box)
+{
+  uint64_t bits = 0;
+  size_t i = 0;
+#if defined(__AVX__)
+  const __m256 min_x = _mm256_set1_ps(box.min_x);
+  const __m256 max_x = _mm256_set1_ps(box.max_x);
+  const __m256 min_y = _mm256_set1_ps(box.min_y);
+  const __m256 max_y = _mm256_set1_ps(box.max_y);
+  const __m256 min_z = _mm256_set1_ps(box.min_z);
+  const __m256 max_z = _mm256_set1_ps(box.max_z);
+  for (; i + 8 <= b.size; i += 8) {
+    const __m256 x = _mm256_load_ps(b.x + i);
+    const __m256 y = _mm256_load_ps(b.y + i);
+    const __m256 z = _mm256_load_ps(b.z + i);
+    __m256 m = _mm256_cmp_ps(x, min_x, _CMP_GT_OQ);
+    m = _mm256_and_ps(m, _mm256_cmp_ps(x, max_x, _CMP_LT_OQ));
+    m = _mm256_and_ps(m, _mm256_cmp_ps(y, min_y, _CMP_GT_OQ));
+    m = _mm256_and_ps(m, _mm256_cmp_ps(y, max_y, _CMP_LT_OQ));
+    m = _mm256_and_ps(m, _mm256_cmp_ps(z, min_z, _CMP_GT_OQ));
+    m = _mm256_and_ps(m, _mm256_cmp_ps(z, max_z, _CMP_LT_OQ));
+    bits |= static_cast<uint64_t>(_mm256_movemask_ps(m)) << i;
+  }
+#elif defined(__SSE2__)
+  const __m128 min_x = _mm_set1_ps(box.min_x);
+  const __m128 max_x = _mm_set1_ps(box.max_x);
+  const __m128 min_y = _mm_set1_ps(box.min_y);
+  const __m128 max_y = _mm_set1_ps(box.max_y);
+  const __m128 min_z = _mm_set1_ps(box.min_z);
+  const __m128 max_z = _mm_set1_ps(box.max_z);
+  for (; i + 4 <= b.size; i += 4) {
+    const __m128 x = _mm_load_ps(b.x + i);
+    const __m128 y = _mm_load_ps(b.y + i);
+    const __m128 z = _mm_load_ps(b.z + i);
+    __m128 m = _mm_and_ps(_mm_cmpgt_ps(x, min_x), _mm_cmplt_ps(x, max_x));
+    m = _mm_and_ps(m, _mm_cmpgt_ps(y, min_y));
+    m = _mm_and_ps(m, _mm_cmplt_ps(y, max_y));
+    m = _mm_and_ps(m, _mm_cmpgt_ps(z, min_z));
+    m = _mm_and_ps(m, _mm_cmplt_ps(z, max_z));
+    bits |= static_cast<uint64_t>(_mm_movemask_ps(m)) << i;
+  }
+#endif
+  for (; i < b.size; ++i) {
+    if (
+      box.min_z < b.z[i] && b.z[i] < box.max_z && box.min_y < b.y[i] && b.y[i] < box.max_y &&
+      box.min_x < b.x[i] && b.x[i] < box.max_x) {
+      bits |= uint64_t{1} << i;
+    }
+  }
+  return bits;
+}
+
+uint64_t getOutsideBoxBits(const Batch & b, const pointcloud_preprocessor::utils::CropBox & box)
+{
+  uint64_t bits = 0;
+  size_t i = 0;
+#if defined(__AVX__)
+  const __m256 min_x = _mm256_set1_ps(box.min_x);
+  const __m256 max_x = _mm256_set1_ps(box.max_x);
+  const __m256 min_y = _mm256_set1_ps(box.min_y);
+  const __m256 max_y = _mm256_set1_ps(box.max_y);
+  const __m256 min_z = _mm256_set1_ps(box.min_z);
+  const __m256 max_z = _mm256_set1_ps(box.max_z);
+  for (; i + 8 <= b.size; i += 8) {
+    const __m256 x = _mm256_load_ps(b.x + i);
+    const __m256 y = _mm256_load_ps(b.y + i);
+    const __m256 z = _mm256_load_ps(b.z + i);
+    __m256 m = _mm256_cmp_ps(x, min_x, _CMP_LT_OQ);
+    m = _mm256_or_ps(m, _mm256_cmp_ps(x, max_x, _CMP_GT_OQ));
+    m = _mm256_or_ps(m, _mm256_cmp_ps(y, min_y, _CMP_LT_OQ));
+    m = _mm256_or_ps(m, _mm256_cmp_ps(y, max_y, _CMP_GT_OQ));
+    m = _mm256_or_ps(m, _mm256_cmp_ps(z, min_z, _CMP_LT_OQ));
+    m = _mm256_or_ps(m, _mm256_cmp_ps(z, max_z, _CMP_GT_OQ));
+    bits |= static_cast<uint64_t>(_mm256_movemask_ps(m)) << i;
+  }
+#elif defined(__SSE2__)
+  const __m128 min_x = _mm_set1_ps(box.min_x);
+  const __m128 max_x = _mm_set1_ps(box.max_x);
+  const __m128 min_y = _mm_set1_ps(box.min_y);
+  const __m128 max_y = _mm_set1_ps(box.max_y);
+  const __m128 min_z = _mm_set1_ps(box.min_z);
+  const __m128 max_z = _mm_set1_ps(box.max_z);
+  for (; i + 4 <= b.size; i += 4) {
+    const __m128 x = _mm_load_ps(b.x + i);
+    const __m128 y = _mm_load_ps(b.y + i);
+    const __m128 z = _mm_load_ps(b.z + i);
+    __m128 m = _mm_or_ps(_mm_cmplt_ps(x, min_x), _mm_cmpgt_ps(x, max_x));
+    m = _mm_or_ps(m, _mm_cmplt_ps(y, min_y));
+    m = _mm_or_ps(m, _mm_cmpgt_ps(y, max_y));
+    m = _mm_or_ps(m, _mm_cmplt_ps(z, min_z));
+    m = _mm_or_ps(m, _mm_cmpgt_ps(z, max_z));
+    bits |= static_cast<uint64_t>(_mm_movemask_ps(m)) << i;
+  }
+#endif
+  for (; i < b.size; ++i) {
+    if (
+      box.min_z > b.z[i] || b.z[i] > box.max_z || box.min_y > b.y[i] || b.y[i] > box.max_y ||
+      box.min_x > b.x[i] || b.x[i] > box.max_x) {
+      bits |= uint64_t{1} << i;
+    }
+  }
+  return bits;
+}
+
+// crossing number test, an edge toggles the points whose ray to +x crosses it
+uint64_t getInsidePolygonBits(
+  const Batch & b, const std::vector<float> & xs, const std::vector<float> & ys,
+  const std::vector<float> & inverse_slopes)
+{
+  uint64_t bits = 0;
+  const size_t num_vertices = xs.size();
+  for (size_t e = 0; e < num_vertices; ++e) {
+    const size_t next = e + 1 == num_vertices ? 0 : e + 1;
+    const float xi = xs[e];
+    const float yi = ys[e];
+    const float yj = ys[next];
+    const float inverse_slope = inverse_slopes[e];
+
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256 v_xi = _mm256_set1_ps(xi);
+    const __m256 v_yi = _mm256_set1_ps(yi);
+    const __m256 v_yj = _mm256_set1_ps(yj);
+    const __m256 v_inverse_slope = _mm256_set1_ps(inverse_slope);
+    for (; i + 8 <= b.size; i += 8) {
+      const __m256 x = _mm256_load_ps(b.x + i);
+      const __m256 y = _mm256_load_ps(b.y + i);
+      const __m256 is_crossing =
+        _mm256_xor_ps(_mm256_cmp_ps(v_yi, y, _CMP_GT_OQ), _mm256_cmp_ps(v_yj, y, _CMP_GT_OQ));
+      const __m256 x_intersection =
+        _mm256_add_ps(v_xi, _mm256_mul_ps(_mm256_sub_ps(y, v_yi), v_inverse_slope));
+      const __m256 m = _mm256_and_ps(is_crossing, _mm256_cmp_ps(x, x_intersection, _CMP_LT_OQ));
+      bits ^= static_cast<uint64_t>(_mm256_movemask_ps(m)) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128 v_xi = _mm_set1_ps(xi);
+    const __m128 v_yi = _mm_set1_ps(yi);
+    const __m128 v_yj = _mm_set1_ps(yj);
+    const __m128 v_inverse_slope = _mm_set1_ps(inverse_slope);
+    for (; i + 4 <= b.size; i += 4) {
+      const __m128 x = _mm_load_ps(b.x + i);
+      const __m128 y = _mm_load_ps(b.y + i);
+      const __m128 is_crossing = _mm_xor_ps(_mm_cmpgt_ps(v_yi, y), _mm_cmpgt_ps(v_yj, y));
+      const __m128 x_intersection =
+        _mm_add_ps(v_xi, _mm_mul_ps(_mm_sub_ps(y, v_yi), v_inverse_slope));
+      const __m128 m = _mm_and_ps(is_crossing, _mm_cmplt_ps(x, x_intersection));
+      bits ^= static_cast<uint64_t>(_mm_movemask_ps(m)) << i;
+    }
+#endif
+    for (; i < b.size; ++i) {
+      const bool is_crossing = (yi > b.y[i]) != (yj > b.y[i]);
+      if (is_crossing && b.x[i] < xi + (b.y[i] - yi) * inverse_slope) {
+        bits ^= uint64_t{1} << i;
+      }
+    }
+  }
+  return bits;
+}
+
+bool getFieldOffset(
+  const sensor_msgs::msg::PointCloud2 & cloud, const std::string & name, uint32_t & offset)
+{
+  for (const auto & field : cloud.fields) {
+    if (field.name == name && field.datatype == sensor_msgs::msg::PointField::FLOAT32) {
+      offset = field.offset;
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+namespace pointcloud_preprocessor::utils
+{
+void CropRegions::addBox(const CropBox & box) { boxes_.push_back(box); }
+
+void CropRegions::addPolygon(const std::vector<float> & xs, const std::vector<float> & ys)
+{
+  if (xs.size() != ys.size() || xs.size() < 3) {
+    throw std::invalid_argument("a polygon needs at least 3 vertices");
+  }
+
+  Polygon polygon;
+  polygon.xs = xs;
+  polygon.ys = ys;
+  polygon.inverse_slopes.resize(xs.size());
+  for (size_t e = 0; e < xs.size(); ++e) {
+    const size_t next = e + 1 == xs.size() ? 0 : e + 1;
+    const float dy = ys[next] - ys[e];
+    polygon.inverse_slopes[e] = dy == 0.0f ? 0.0f : (xs[next] - xs[e]) / dy;
+  }
+  polygon.min_x = *std::min_element(xs.begin(), xs.end());
+  polygon.max_x = *std::max_element(xs.begin(), xs.end());
+  polygon.min_y = *std::min_element(ys.begin(), ys.end());
+  polygon.max_y = *std::max_element(ys.begin(), ys.end());
+  polygons_.push_back(std::move(polygon));
+}
+
+void CropRegions::clear()
+{
+  boxes_.clear();
+  polygons_.clear();
+}
+
+void CropRegions::filter(
+  const sensor_msgs::msg::PointCloud2 & input, const bool negative,
+  sensor_msgs::msg::PointCloud2 & output) const
+{
+  uint32_t x_offset, y_offset, z_offset;
+  if (
+    !getFieldOffset(input, "x", x_offset) || !getFieldOffset(input, "y", y_offset) ||
+    !getFieldOffset(input, "z", z_offset)) {
+    throw std::invalid_argument("input pointcloud does not have float32 x, y and z fields");
+  }
+
+  const size_t point_step = input.point_step;
+  const size_t num_points = point_step == 0 ? 0 : input.data.size() / point_step;
+  output.data.resize(num_points * point_step);
+
+  const uint8_t * input_data = input.data.data();
+  uint8_t * output_data = output.data.data();
+  size_t num_kept = 0;
+  Batch batch;
+  for (size_t begin = 0; begin < num_points; begin += batch_size) {
+    batch.size = std::min(batch_size, num_points - begin);
+    for (size_t i = 0; i < batch.size; ++i) {
+      const uint8_t * point = input_data + (begin + i) * point_step;
+      std::memcpy(&batch.x[i], point + x_offset, sizeof(float));
+      std::memcpy(&batch.y[i], point + y_offset, sizeof(float));
+      std::memcpy(&batch.z[i], point + z_offset, sizeof(float));
+    }
+
+    uint64_t keep_bits = negative ? getLowBits(batch.size) : 0;
+    for (const auto & box : boxes_) {
+      if (negative) {
+        keep_bits &= getOutsideBoxBits(batch, box);
+      } else {
+        keep_bits |= getInsideBoxBits(batch, box);
+      }
+    }
+    for (const auto & polygon : polygons_) {
+      // points outside of the bounding box can not be inside of the polygon
+      const CropBox bounding_box{polygon.min_x, polygon.max_x, polygon.min_y,
+                                 polygon.max_y, -1.0e30f,      1.0e30f};
+      const uint64_t candidate_bits = ~getOutsideBoxBits(batch, bounding_box);
+      if ((candidate_bits & getLowBits(batch.size)) == 0) {
+        continue;
+      }
+      const uint64_t inside_bits =
+        candidate_bits &
+        getInsidePolygonBits(batch, polygon.xs, polygon.ys, polygon.inverse_slopes);
+      if (negative) {
+        keep_bits &= ~inside_bits;
+      } else {
+        keep_bits |= inside_bits;
+      }
+    }
+
+    for (size_t i = 0; i < batch.size; ++i) {
+      if ((keep_bits >> i) & 1) {
+        std::memcpy(
+          output_data + num_kept * point_step, input_data + (begin + i) * point_step, point_step);
+        ++num_kept;
+      }
+    }
+  }
+
+  output.data.resize(num_kept * point_step);
+  output.header = input.header;
+  output.height = 1;
+  output.fields = input.fields;
+  output.is_bigendian = input.is_bigendian;
+  output.point_step = input.point_step;
+  output.is_dense = input.is_dense;
+  output.width = static_cast<uint32_t>(num_kept);
+  output.row_step = static_cast<uint32_t>(output.data.size());
+}
+}  // namespace pointcloud_preprocessor::utils
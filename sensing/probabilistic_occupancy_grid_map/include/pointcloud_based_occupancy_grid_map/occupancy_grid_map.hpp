@@ -59,6 +59,8 @@
 #include <sensor_msgs/msg/laser_scan.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 
+#include <vector>
+
 namespace costmap_2d
 {
 using geometry_msgs::msg::Pose;
@@ -83,8 +85,52 @@ public:
     const unsigned char cost);
 
 private:
+  struct BinInfo
+  {
+    BinInfo() = default;
+    BinInfo(const double _range, const double _wx, const double _wy)
+    : range(_range), wx(_wx), wy(_wy)
+    {
+    }
+    double range;
+    double wx;
+    double wy;
+  };
+
+  // points of angle bin i are points[bin_begin[i]] ... points[bin_begin[i + 1] - 1], by distance
+  struct AngleBins
+  {
+    std::vector<BinInfo> points;
+    std::vector<size_t> bin_begin;
+  };
+
   bool worldToMap(double wx, double wy, unsigned int & mx, unsigned int & my) const;
 
+  void createAngleBins(
+    const PointCloud2 & pointcloud, const PointCloud2 & trans_pointcloud,
+    const size_t angle_bin_size, AngleBins & angle_bins) const;
+
+  // `write_cell(index, cost)` is called for the cells of a bin in the order they are written
+  template <typename CellWriter>
+  void raytraceFreespace(
+    const BinInfo * raw_begin, const BinInfo * raw_end, const BinInfo * obstacle_begin,
+    const BinInfo * obstacle_end, const Pose & robot_pose, CellWriter & write_cell) const;
+  template <typename CellWriter>
+  void raytraceUnknown(
+    const BinInfo * raw_begin, const BinInfo * raw_end, const BinInfo * obstacle_begin,
+    const BinInfo * obstacle_end, CellWriter & write_cell) const;
+  template <typename CellWriter>
+  void raytraceOccupied(
+    const BinInfo * obstacle_begin, const BinInfo * obstacle_end, CellWriter & write_cell) const;
+
+  template <typename CellWriter>
+  void setCellValue(
+    const double wx, const double wy, const unsigned char cost, CellWriter & write_cell) const;
+  template <typename CellWriter>
+  void raytrace(
+    const double source_x, const double source_y, const double target_x, const double target_y,
+    const unsigned char cost, CellWriter & write_cell) const;
+
   rclcpp::Logger logger_{rclcpp::get_logger("pointcloud_based_occupancy_grid_map")};
   rclcpp::Clock clock_{RCL_ROS_TIME};
 };
@@ -0,0 +1,67 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROLLING_GRID_HPP_
+#define ROLLING_GRID_HPP_
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace costmap_2d
+{
+/**
+ * @brief Move the cells of a row-major grid in place when its origin moves by (cell_ox, cell_oy)
+ * cells, i.e. the new cell (x, y) is the old cell (x + cell_ox, y + cell_oy). The cells which
+ * enter the grid are set to `default_value`. Unlike Costmap2D::updateOrigin, neither a temporary
+ * copy nor a reset of the whole grid is needed.
+ */
+inline void shiftRollingGrid(
+  unsigned char * grid, const int size_x, const int size_y, const int cell_ox, const int cell_oy,
+  const unsigned char default_value)
+{
+  if (std::abs(cell_ox) >= size_x || std::abs(cell_oy) >= size_y) {
+    std::memset(grid, default_value, static_cast<size_t>(size_x) * size_y);
+    return;
+  }
+  if (cell_ox == 0 && cell_oy == 0) {
+    return;
+  }
+
+  const int copy_size = size_x - std::abs(cell_ox);
+  const int dst_x = std::max(-cell_ox, 0);
+  const int src_x = std::max(cell_ox, 0);
+  // the uncovered columns are on the right when moving forward, on the left otherwise
+  const int fill_x = cell_ox > 0 ? copy_size : 0;
+  const int fill_size = size_x - copy_size;
+
+  // rows are visited so that a source row is always read before it is overwritten
+  const int y_begin = cell_oy >= 0 ? 0 : size_y - 1;
+  const int y_end = cell_oy >= 0 ? size_y : -1;
+  const int y_step = cell_oy >= 0 ? 1 : -1;
+  for (int y = y_begin; y != y_end; y += y_step) {
+    unsigned char * dst_row = grid + static_cast<size_t>(y) * size_x;
+    const int src_y = y + cell_oy;
+    if (src_y < 0 || size_y <= src_y) {
+      std::memset(dst_row, default_value, size_x);
+      continue;
+    }
+    const unsigned char * src_row = grid + static_cast<size_t>(src_y) * size_x;
+    std::memmove(dst_row + dst_x, src_row + src_x, copy_size);
+    std::memset(dst_row + fill_x, default_value, fill_size);
+  }
+}
+}  // namespace costmap_2d
+
+#endif  // ROLLING_GRID_HPP_
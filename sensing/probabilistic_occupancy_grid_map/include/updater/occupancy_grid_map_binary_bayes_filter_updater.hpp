@@ -20,6 +20,8 @@
 #include <eigen3/Eigen/Core>
 #include <eigen3/Eigen/Geometry>
 
+#include <vector>
+
 namespace costmap_2d
 {
 class OccupancyGridMapBBFUpdater : public OccupancyGridMapUpdaterInterface
@@ -35,12 +37,16 @@ public:
       1.0 - probability_matrix_(OCCUPIED, OCCUPIED);
     probability_matrix_(Index::FREE, Index::FREE) = 0.8;
     probability_matrix_(Index::OCCUPIED, Index::FREE) = 1.0 - probability_matrix_(FREE, FREE);
+    createBBFTable();
   }
   bool update(const Costmap2D & single_frame_occupancy_grid_map) override;
 
 private:
   inline unsigned char applyBBF(const unsigned char & z, const unsigned char & o);
+  void createBBFTable();
   Eigen::Matrix2f probability_matrix_;
+  // applyBBF(z, o) at index (z << 8) | o, the filter only depends on the two cost values
+  std::vector<unsigned char> bbf_table_;
 };
 
 }  // namespace costmap_2d
@@ -16,9 +16,12 @@
 #define UPDATER__OCCUPANCY_GRID_MAP_UPDATER_INTERFACE_HPP_
 
 #include "cost_value.hpp"
+#include "rolling_grid.hpp"
 
 #include <nav2_costmap_2d/costmap_2d.hpp>
 
+#include <cmath>
+
 namespace costmap_2d
 {
 class OccupancyGridMapUpdaterInterface : public nav2_costmap_2d::Costmap2D
@@ -32,6 +35,18 @@ public:
   }
   virtual ~OccupancyGridMapUpdaterInterface() = default;
   virtual bool update(const Costmap2D & single_frame_occupancy_grid_map) = 0;
+
+  // the grid rolls with the vehicle, so only the cells which enter it are reset
+  void updateOrigin(double new_origin_x, double new_origin_y) override
+  {
+    const int cell_ox{static_cast<int>(std::floor((new_origin_x - origin_x_) / resolution_))};
+    const int cell_oy{static_cast<int>(std::floor((new_origin_y - origin_y_) / resolution_))};
+    shiftRollingGrid(
+      costmap_, static_cast<int>(size_x_), static_cast<int>(size_y_), cell_ox, cell_oy,
+      default_value_);
+    origin_x_ = origin_x_ + cell_ox * resolution_;
+    origin_y_ = origin_y_ + cell_oy * resolution_;
+  }
 };
 
 }  // namespace costmap_2d
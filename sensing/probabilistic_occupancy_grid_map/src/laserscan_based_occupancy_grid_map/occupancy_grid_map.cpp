@@ -52,6 +52,7 @@
 #include "laserscan_based_occupancy_grid_map/occupancy_grid_map.hpp"
 
 #include "cost_value.hpp"
+#include "rolling_grid.hpp"
 
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 
@@ -86,52 +87,17 @@ bool OccupancyGridMap::worldToMap(double wx, double wy, unsigned int & mx, unsig
 void OccupancyGridMap::updateOrigin(double new_origin_x, double new_origin_y)
 {
   // project the new origin into the grid
-  int cell_ox{static_cast<int>(std::floor((new_origin_x - origin_x_) / resolution_))};
-  int cell_oy{static_cast<int>(std::floor((new_origin_y - origin_y_) / resolution_))};
+  const int cell_ox{static_cast<int>(std::floor((new_origin_x - origin_x_) / resolution_))};
+  const int cell_oy{static_cast<int>(std::floor((new_origin_y - origin_y_) / resolution_))};
 
-  // compute the associated world coordinates for the origin cell
-  // because we want to keep things grid-aligned
-  double new_grid_ox{origin_x_ + cell_ox * resolution_};
-  double new_grid_oy{origin_y_ + cell_oy * resolution_};
+  // move the overlapping cells in place, only the cells which enter the grid are reset
+  shiftRollingGrid(
+    costmap_, static_cast<int>(size_x_), static_cast<int>(size_y_), cell_ox, cell_oy,
+    default_value_);
 
-  // To save casting from unsigned int to int a bunch of times
-  int size_x{static_cast<int>(size_x_)};
-  int size_y{static_cast<int>(size_y_)};
-
-  // we need to compute the overlap of the new and existing windows
-  int lower_left_x{std::min(std::max(cell_ox, 0), size_x)};
-  int lower_left_y{std::min(std::max(cell_oy, 0), size_y)};
-  int upper_right_x{std::min(std::max(cell_ox + size_x, 0), size_x)};
-  int upper_right_y{std::min(std::max(cell_oy + size_y, 0), size_y)};
-
-  unsigned int cell_size_x = upper_right_x - lower_left_x;
-  unsigned int cell_size_y = upper_right_y - lower_left_y;
-
-  // we need a map to store the obstacles in the window temporarily
-  unsigned char * local_map = new unsigned char[cell_size_x * cell_size_y];
-
-  // copy the local window in the costmap to the local map
-  copyMapRegion(
-    costmap_, lower_left_x, lower_left_y, size_x_, local_map, 0, 0, cell_size_x, cell_size_x,
-    cell_size_y);
-
-  // now we'll set the costmap to be completely unknown if we track unknown space
-  resetMaps();
-
-  // update the origin with the appropriate world coordinates
-  origin_x_ = new_grid_ox;
-  origin_y_ = new_grid_oy;
-
-  // compute the starting cell location for copying data back in
-  int start_x{lower_left_x - cell_ox};
-  int start_y{lower_left_y - cell_oy};
-
-  // now we want to copy the overlapping information back into the map, but in its new location
-  copyMapRegion(
-    local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x, cell_size_y);
-
-  // make sure to clean up
-  delete[] local_map;
+  // update the origin with the grid-aligned world coordinates
+  origin_x_ = origin_x_ + cell_ox * resolution_;
+  origin_y_ = origin_y_ + cell_oy * resolution_;
 }
 
 void OccupancyGridMap::raytrace2D(const PointCloud2 & pointcloud, const Pose & robot_pose)
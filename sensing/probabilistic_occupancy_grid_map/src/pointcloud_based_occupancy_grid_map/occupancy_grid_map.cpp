@@ -52,6 +52,7 @@
 #include "pointcloud_based_occupancy_grid_map/occupancy_grid_map.hpp"
 
 #include "cost_value.hpp"
+#include "rolling_grid.hpp"
 
 #include <pcl_ros/transforms.hpp>
 #include <tier4_autoware_utils/tier4_autoware_utils.hpp>
@@ -67,7 +68,13 @@
 #include <tf2_sensor_msgs/tf2_sensor_msgs.hpp>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <algorithm>
+#include <vector>
+
 namespace
 {
 void transformPointcloud(
@@ -112,52 +119,17 @@ bool OccupancyGridMap::worldToMap(double wx, double wy, unsigned int & mx, unsig
 void OccupancyGridMap::updateOrigin(double new_origin_x, double new_origin_y)
 {
   // project the new origin into the grid
-  int cell_ox{static_cast<int>(std::floor((new_origin_x - origin_x_) / resolution_))};
-  int cell_oy{static_cast<int>(std::floor((new_origin_y - origin_y_) / resolution_))};
-
-  // compute the associated world coordinates for the origin cell
-  // because we want to keep things grid-aligned
-  double new_grid_ox{origin_x_ + cell_ox * resolution_};
-  double new_grid_oy{origin_y_ + cell_oy * resolution_};
-
-  // To save casting from unsigned int to int a bunch of times
-  int size_x{static_cast<int>(size_x_)};
-  int size_y{static_cast<int>(size_y_)};
-
-  // we need to compute the overlap of the new and existing windows
-  int lower_left_x{std::min(std::max(cell_ox, 0), size_x)};
-  int lower_left_y{std::min(std::max(cell_oy, 0), size_y)};
-  int upper_right_x{std::min(std::max(cell_ox + size_x, 0), size_x)};
-  int upper_right_y{std::min(std::max(cell_oy + size_y, 0), size_y)};
-
-  unsigned int cell_size_x = upper_right_x - lower_left_x;
-  unsigned int cell_size_y = upper_right_y - lower_left_y;
-
-  // we need a map to store the obstacles in the window temporarily
-  unsigned char * local_map = new unsigned char[cell_size_x * cell_size_y];
-
-  // copy the local window in the costmap to the local map
-  copyMapRegion(
-    costmap_, lower_left_x, lower_left_y, size_x_, local_map, 0, 0, cell_size_x, cell_size_x,
-    cell_size_y);
-
-  // now we'll set the costmap to be completely unknown if we track unknown space
-  resetMaps();
-
-  // update the origin with the appropriate world coordinates
-  origin_x_ = new_grid_ox;
-  origin_y_ = new_grid_oy;
-
-  // compute the starting cell location for copying data back in
-  int start_x{lower_left_x - cell_ox};
-  int start_y{lower_left_y - cell_oy};
+  const int cell_ox{static_cast<int>(std::floor((new_origin_x - origin_x_) / resolution_))};
+  const int cell_oy{static_cast<int>(std::floor((new_origin_y - origin_y_) / resolution_))};
 
-  // now we want to copy the overlapping information back into the map, but in its new location
-  copyMapRegion(
-    local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x, cell_size_y);
+  // move the overlapping cells in place, only the cells which enter the grid are reset
+  shiftRollingGrid(
+    costmap_, static_cast<int>(size_x_), static_cast<int>(size_y_), cell_ox, cell_oy,
+    default_value_);
 
-  // make sure to clean up
-  delete[] local_map;
+  // update the origin with the grid-aligned world coordinates
+  origin_x_ = origin_x_ + cell_ox * resolution_;
+  origin_y_ = origin_y_ + cell_oy * resolution_;
 }
 
 void OccupancyGridMap::updateWithPointCloud(
@@ -174,175 +146,321 @@ void OccupancyGridMap::updateWithPointCloud(
   transformPointcloud(raw_pointcloud, robot_pose, trans_raw_pointcloud);
   transformPointcloud(obstacle_pointcloud, robot_pose, trans_obstacle_pointcloud);
 
-  // Create angle bins
-  struct BinInfo
-  {
-    BinInfo() = default;
-    BinInfo(const double _range, const double _wx, const double _wy)
-    : range(_range), wx(_wx), wy(_wy)
-    {
+  // Create angle bins sorted by distance
+  AngleBins raw_pointcloud_angle_bins, obstacle_pointcloud_angle_bins;
+  createAngleBins(raw_pointcloud, trans_raw_pointcloud, angle_bin_size, raw_pointcloud_angle_bins);
+  createAngleBins(
+    obstacle_pointcloud, trans_obstacle_pointcloud, angle_bin_size,
+    obstacle_pointcloud_angle_bins);
+
+  const int bin_num = static_cast<int>(angle_bin_size);
+  const auto trace_bin = [&](const int step, const int bin_index, auto & write_cell) {
+    const auto * raw_begin = raw_pointcloud_angle_bins.points.data() +
+                             raw_pointcloud_angle_bins.bin_begin.at(bin_index);
+    const auto * raw_end = raw_pointcloud_angle_bins.points.data() +
+                           raw_pointcloud_angle_bins.bin_begin.at(bin_index + 1);
+    const auto * obstacle_begin = obstacle_pointcloud_angle_bins.points.data() +
+                                  obstacle_pointcloud_angle_bins.bin_begin.at(bin_index);
+    const auto * obstacle_end = obstacle_pointcloud_angle_bins.points.data() +
+                                obstacle_pointcloud_angle_bins.bin_begin.at(bin_index + 1);
+    if (step == 0) {
+      // First step: Initialize cells to the final point with freespace
+      raytraceFreespace(raw_begin, raw_end, obstacle_begin, obstacle_end, robot_pose, write_cell);
+    } else if (step == 1) {
+      // Second step: Add uknown cell
+      raytraceUnknown(raw_begin, raw_end, obstacle_begin, obstacle_end, write_cell);
+    } else {
+      // Third step: Overwrite occupied cell
+      raytraceOccupied(obstacle_begin, obstacle_end, write_cell);
     }
-    double range;
-    double wx;
-    double wy;
   };
-  std::vector</*angle bin*/ std::vector<BinInfo>> obstacle_pointcloud_angle_bins;
-  std::vector</*angle bin*/ std::vector<BinInfo>> raw_pointcloud_angle_bins;
-  obstacle_pointcloud_angle_bins.resize(angle_bin_size);
-  raw_pointcloud_angle_bins.resize(angle_bin_size);
-  for (PointCloud2ConstIterator<float> iter_x(raw_pointcloud, "x"), iter_y(raw_pointcloud, "y"),
-       iter_wx(trans_raw_pointcloud, "x"), iter_wy(trans_raw_pointcloud, "y");
-       iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_wx, ++iter_wy) {
-    const double angle = atan2(*iter_y, *iter_x);
-    const int angle_bin_index = (angle - min_angle) / angle_increment;
-    raw_pointcloud_angle_bins.at(angle_bin_index)
-      .push_back(BinInfo(std::hypot(*iter_y, *iter_x), *iter_wx, *iter_wy));
+  constexpr int step_num = 3;
+
+#ifdef _OPENMP
+  const int thread_num = omp_get_max_threads();
+#else
+  const int thread_num = 1;
+#endif
+  if (thread_num <= 1) {
+    auto write_cell = [this](const unsigned int index, const unsigned char cost) {
+      costmap_[index] = cost;
+    };
+    for (int step = 0; step < step_num; ++step) {
+      for (int bin_index = 0; bin_index < bin_num; ++bin_index) {
+        trace_bin(step, bin_index, write_cell);
+      }
+    }
+    return;
+  }
+
+  // The rays of the bins are traced in parallel into the cell writes of each thread. The writes
+  // are then applied step by step in the order of the bins, so the map doesn't depend on the
+  // number of threads.
+  struct CellWrite
+  {
+    unsigned int index;
+    unsigned char cost;
+  };
+  struct WriteRange
+  {
+    int thread;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<std::vector<CellWrite>> thread_writes(thread_num);
+  std::vector<WriteRange> write_ranges(step_num * angle_bin_size);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int bin_index = 0; bin_index < bin_num; ++bin_index) {
+#ifdef _OPENMP
+    const int thread = omp_get_thread_num();
+#else
+    const int thread = 0;
+#endif
+    auto & writes = thread_writes.at(thread);
+    auto write_cell = [&writes](const unsigned int index, const unsigned char cost) {
+      writes.push_back(CellWrite{index, cost});
+    };
+    for (int step = 0; step < step_num; ++step) {
+      const size_t begin = writes.size();
+      trace_bin(step, bin_index, write_cell);
+      write_ranges.at(step * angle_bin_size + bin_index) =
+        WriteRange{thread, begin, writes.size()};
+    }
+  }
+
+  for (const auto & write_range : write_ranges) {
+    const auto & writes = thread_writes.at(write_range.thread);
+    for (size_t i = write_range.begin; i < write_range.end; ++i) {
+      costmap_[writes[i].index] = writes[i].cost;
+    }
   }
-  for (PointCloud2ConstIterator<float> iter_x(obstacle_pointcloud, "x"),
-       iter_y(obstacle_pointcloud, "y"), iter_wx(trans_obstacle_pointcloud, "x"),
-       iter_wy(trans_obstacle_pointcloud, "y");
+}
+
+void OccupancyGridMap::createAngleBins(
+  const PointCloud2 & pointcloud, const PointCloud2 & trans_pointcloud,
+  const size_t angle_bin_size, AngleBins & angle_bins) const
+{
+  constexpr double min_angle = tier4_autoware_utils::deg2rad(-180.0);
+  constexpr double angle_increment = tier4_autoware_utils::deg2rad(0.1);
+
+  const size_t point_num = static_cast<size_t>(pointcloud.width) * pointcloud.height;
+  std::vector<BinInfo> points;
+  std::vector<size_t> bin_indices;
+  points.reserve(point_num);
+  bin_indices.reserve(point_num);
+  double max_range = 0.0;
+  for (PointCloud2ConstIterator<float> iter_x(pointcloud, "x"), iter_y(pointcloud, "y"),
+       iter_wx(trans_pointcloud, "x"), iter_wy(trans_pointcloud, "y");
        iter_x != iter_x.end(); ++iter_x, ++iter_y, ++iter_wx, ++iter_wy) {
     const double angle = atan2(*iter_y, *iter_x);
-    int angle_bin_index = (angle - min_angle) / angle_increment;
-    obstacle_pointcloud_angle_bins.at(angle_bin_index)
-      .push_back(BinInfo(std::hypot(*iter_y, *iter_x), *iter_wx, *iter_wy));
+    const int angle_bin_index = (angle - min_angle) / angle_increment;
+    bin_indices.push_back(static_cast<size_t>(angle_bin_index));
+    points.emplace_back(std::hypot(*iter_y, *iter_x), *iter_wx, *iter_wy);
+    max_range = std::max(max_range, points.back().range);
   }
 
-  // Sort by distance
-  for (auto & obstacle_pointcloud_angle_bin : obstacle_pointcloud_angle_bins) {
-    std::sort(
-      obstacle_pointcloud_angle_bin.begin(), obstacle_pointcloud_angle_bin.end(),
-      [](auto a, auto b) { return a.range < b.range; });
+  // Radix sort by (angle bin, distance bucket of a cell size), no comparison sort per bin
+  const size_t range_bucket_size = static_cast<size_t>(max_range / resolution_) + 1;
+  std::vector<size_t> count(std::max(range_bucket_size, angle_bin_size) + 1);
+  const auto counting_sort = [&count](
+                               const std::vector<size_t> & input, const size_t key_size,
+                               const auto & get_key, std::vector<size_t> & output) {
+    std::fill(count.begin(), count.begin() + key_size + 1, 0);
+    for (const auto i : input) {
+      ++count[get_key(i) + 1];
+    }
+    for (size_t key = 1; key <= key_size; ++key) {
+      count[key] += count[key - 1];
+    }
+    output.resize(input.size());
+    for (const auto i : input) {
+      output[count[get_key(i)]++] = i;
+    }
+  };
+  std::vector<size_t> order(points.size()), range_order, bin_order;
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
   }
-  for (auto & raw_pointcloud_angle_bin : raw_pointcloud_angle_bins) {
-    std::sort(raw_pointcloud_angle_bin.begin(), raw_pointcloud_angle_bin.end(), [](auto a, auto b) {
-      return a.range < b.range;
-    });
+  counting_sort(
+    order, range_bucket_size,
+    [&](const size_t i) { return static_cast<size_t>(points[i].range / resolution_); },
+    range_order);
+  counting_sort(
+    range_order, angle_bin_size, [&](const size_t i) { return bin_indices[i]; }, bin_order);
+
+  angle_bins.points.resize(points.size());
+  angle_bins.bin_begin.assign(angle_bin_size + 1, 0);
+  for (size_t i = 0; i < bin_order.size(); ++i) {
+    angle_bins.points[i] = points[bin_order[i]];
+    ++angle_bins.bin_begin[bin_indices[bin_order[i]] + 1];
+  }
+  for (size_t bin_index = 0; bin_index < angle_bin_size; ++bin_index) {
+    angle_bins.bin_begin[bin_index + 1] += angle_bins.bin_begin[bin_index];
   }
 
-  // First step: Initialize cells to the final point with freespace
-  constexpr double distance_margin = 1.0;
-  for (size_t bin_index = 0; bin_index < obstacle_pointcloud_angle_bins.size(); ++bin_index) {
-    auto & obstacle_pointcloud_angle_bin = obstacle_pointcloud_angle_bins.at(bin_index);
-    auto & raw_pointcloud_angle_bin = raw_pointcloud_angle_bins.at(bin_index);
-
-    BinInfo end_distance;
-    if (raw_pointcloud_angle_bin.empty() && obstacle_pointcloud_angle_bin.empty()) {
-      continue;
-    } else if (raw_pointcloud_angle_bin.empty()) {
-      end_distance = obstacle_pointcloud_angle_bin.back();
-    } else if (obstacle_pointcloud_angle_bin.empty()) {
-      end_distance = raw_pointcloud_angle_bin.back();
-    } else {
-      end_distance = obstacle_pointcloud_angle_bin.back().range + distance_margin <
-                         raw_pointcloud_angle_bin.back().range
-                       ? raw_pointcloud_angle_bin.back()
-                       : obstacle_pointcloud_angle_bin.back();
+  // Sort by distance, the points of a bin are only unordered within a bucket
+  for (size_t bin_index = 0; bin_index < angle_bin_size; ++bin_index) {
+    const auto begin = angle_bins.points.begin() + angle_bins.bin_begin[bin_index];
+    const auto end = angle_bins.points.begin() + angle_bins.bin_begin[bin_index + 1];
+    for (auto itr = begin; itr != end; ++itr) {
+      for (auto sorted = itr; sorted != begin && sorted->range < (sorted - 1)->range; --sorted) {
+        std::iter_swap(sorted, sorted - 1);
+      }
     }
-    raytrace(
-      robot_pose.position.x, robot_pose.position.y, end_distance.wx, end_distance.wy,
-      occupancy_cost_value::FREE_SPACE);
   }
+}
 
-  // Second step: Add uknown cell
-  for (size_t bin_index = 0; bin_index < obstacle_pointcloud_angle_bins.size(); ++bin_index) {
-    auto & obstacle_pointcloud_angle_bin = obstacle_pointcloud_angle_bins.at(bin_index);
-    auto & raw_pointcloud_angle_bin = raw_pointcloud_angle_bins.at(bin_index);
-    auto raw_distance_iter = raw_pointcloud_angle_bin.begin();
-    for (size_t dist_index = 0; dist_index < obstacle_pointcloud_angle_bin.size(); ++dist_index) {
-      // Calculate next raw point from obstacle point
-      while (raw_distance_iter != raw_pointcloud_angle_bin.end()) {
-        if (
-          raw_distance_iter->range <
-          obstacle_pointcloud_angle_bin.at(dist_index).range + distance_margin)
-          raw_distance_iter++;
-        else
-          break;
-      }
+template <typename CellWriter>
+void OccupancyGridMap::raytraceFreespace(
+  const BinInfo * raw_begin, const BinInfo * raw_end, const BinInfo * obstacle_begin,
+  const BinInfo * obstacle_end, const Pose & robot_pose, CellWriter & write_cell) const
+{
+  constexpr double distance_margin = 1.0;
+  BinInfo end_distance;
+  if (raw_begin == raw_end && obstacle_begin == obstacle_end) {
+    return;
+  } else if (raw_begin == raw_end) {
+    end_distance = *(obstacle_end - 1);
+  } else if (obstacle_begin == obstacle_end) {
+    end_distance = *(raw_end - 1);
+  } else {
+    end_distance = (obstacle_end - 1)->range + distance_margin < (raw_end - 1)->range
+                     ? *(raw_end - 1)
+                     : *(obstacle_end - 1);
+  }
+  raytrace(
+    robot_pose.position.x, robot_pose.position.y, end_distance.wx, end_distance.wy,
+    occupancy_cost_value::FREE_SPACE, write_cell);
+}
 
-      // There is no point far than the obstacle point.
-      const bool no_freespace_point = (raw_distance_iter == raw_pointcloud_angle_bin.end());
-
-      if (dist_index + 1 == obstacle_pointcloud_angle_bin.size()) {
-        const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
-        if (!no_freespace_point) {
-          const auto & target = *raw_distance_iter;
-          raytrace(
-            source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION);
-          setCellValue(target.wx, target.wy, occupancy_cost_value::FREE_SPACE);
-        }
-        continue;
-      }
+template <typename CellWriter>
+void OccupancyGridMap::raytraceUnknown(
+  const BinInfo * raw_begin, const BinInfo * raw_end, const BinInfo * obstacle_begin,
+  const BinInfo * obstacle_end, CellWriter & write_cell) const
+{
+  constexpr double distance_margin = 1.0;
+  const size_t obstacle_num = obstacle_end - obstacle_begin;
+  auto raw_distance_iter = raw_begin;
+  for (size_t dist_index = 0; dist_index < obstacle_num; ++dist_index) {
+    // Calculate next raw point from obstacle point
+    while (raw_distance_iter != raw_end) {
+      if (raw_distance_iter->range < obstacle_begin[dist_index].range + distance_margin)
+        raw_distance_iter++;
+      else
+        break;
+    }
 
-      auto next_obstacle_point_distance = std::abs(
-        obstacle_pointcloud_angle_bin.at(dist_index + 1).range -
-        obstacle_pointcloud_angle_bin.at(dist_index).range);
-      if (next_obstacle_point_distance <= distance_margin) {
-        continue;
-      } else if (no_freespace_point) {
-        const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
-        const auto & target = obstacle_pointcloud_angle_bin.at(dist_index + 1);
-        raytrace(source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION);
-        continue;
-      }
+    // There is no point far than the obstacle point.
+    const bool no_freespace_point = (raw_distance_iter == raw_end);
 
-      auto next_raw_distance =
-        std::abs(obstacle_pointcloud_angle_bin.at(dist_index).range - raw_distance_iter->range);
-      if (next_raw_distance < next_obstacle_point_distance) {
-        const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
+    if (dist_index + 1 == obstacle_num) {
+      const auto & source = obstacle_begin[dist_index];
+      if (!no_freespace_point) {
         const auto & target = *raw_distance_iter;
-        raytrace(source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION);
-        setCellValue(target.wx, target.wy, occupancy_cost_value::FREE_SPACE);
-        continue;
-      } else {
-        const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
-        const auto & target = obstacle_pointcloud_angle_bin.at(dist_index + 1);
-        raytrace(source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION);
-        continue;
+        raytrace(
+          source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION,
+          write_cell);
+        setCellValue(target.wx, target.wy, occupancy_cost_value::FREE_SPACE, write_cell);
       }
+      continue;
+    }
+
+    auto next_obstacle_point_distance =
+      std::abs(obstacle_begin[dist_index + 1].range - obstacle_begin[dist_index].range);
+    if (next_obstacle_point_distance <= distance_margin) {
+      continue;
+    } else if (no_freespace_point) {
+      const auto & source = obstacle_begin[dist_index];
+      const auto & target = obstacle_begin[dist_index + 1];
+      raytrace(
+        source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION,
+        write_cell);
+      continue;
+    }
+
+    auto next_raw_distance = std::abs(obstacle_begin[dist_index].range - raw_distance_iter->range);
+    if (next_raw_distance < next_obstacle_point_distance) {
+      const auto & source = obstacle_begin[dist_index];
+      const auto & target = *raw_distance_iter;
+      raytrace(
+        source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION,
+        write_cell);
+      setCellValue(target.wx, target.wy, occupancy_cost_value::FREE_SPACE, write_cell);
+      continue;
+    } else {
+      const auto & source = obstacle_begin[dist_index];
+      const auto & target = obstacle_begin[dist_index + 1];
+      raytrace(
+        source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::NO_INFORMATION,
+        write_cell);
+      continue;
     }
   }
+}
 
-  // Third step: Overwrite occupied cell
-  for (size_t bin_index = 0; bin_index < obstacle_pointcloud_angle_bins.size(); ++bin_index) {
-    auto & obstacle_pointcloud_angle_bin = obstacle_pointcloud_angle_bins.at(bin_index);
-    for (size_t dist_index = 0; dist_index < obstacle_pointcloud_angle_bin.size(); ++dist_index) {
-      const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
-      setCellValue(source.wx, source.wy, occupancy_cost_value::LETHAL_OBSTACLE);
+template <typename CellWriter>
+void OccupancyGridMap::raytraceOccupied(
+  const BinInfo * obstacle_begin, const BinInfo * obstacle_end, CellWriter & write_cell) const
+{
+  constexpr double distance_margin = 1.0;
+  const size_t obstacle_num = obstacle_end - obstacle_begin;
+  for (size_t dist_index = 0; dist_index < obstacle_num; ++dist_index) {
+    const auto & source = obstacle_begin[dist_index];
+    setCellValue(source.wx, source.wy, occupancy_cost_value::LETHAL_OBSTACLE, write_cell);
 
-      if (dist_index + 1 == obstacle_pointcloud_angle_bin.size()) {
-        continue;
-      }
+    if (dist_index + 1 == obstacle_num) {
+      continue;
+    }
 
-      auto next_obstacle_point_distance = std::abs(
-        obstacle_pointcloud_angle_bin.at(dist_index + 1).range -
-        obstacle_pointcloud_angle_bin.at(dist_index).range);
-      if (next_obstacle_point_distance <= distance_margin) {
-        const auto & source = obstacle_pointcloud_angle_bin.at(dist_index);
-        const auto & target = obstacle_pointcloud_angle_bin.at(dist_index + 1);
-        raytrace(source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::LETHAL_OBSTACLE);
-        continue;
-      }
+    auto next_obstacle_point_distance =
+      std::abs(obstacle_begin[dist_index + 1].range - obstacle_begin[dist_index].range);
+    if (next_obstacle_point_distance <= distance_margin) {
+      const auto & target = obstacle_begin[dist_index + 1];
+      raytrace(
+        source.wx, source.wy, target.wx, target.wy, occupancy_cost_value::LETHAL_OBSTACLE,
+        write_cell);
+      continue;
     }
   }
 }
 
 void OccupancyGridMap::setCellValue(const double wx, const double wy, const unsigned char cost)
 {
-  MarkCell marker(costmap_, cost);
+  auto write_cell = [this](const unsigned int index, const unsigned char cost) {
+    costmap_[index] = cost;
+  };
+  setCellValue(wx, wy, cost, write_cell);
+}
+
+template <typename CellWriter>
+void OccupancyGridMap::setCellValue(
+  const double wx, const double wy, const unsigned char cost, CellWriter & write_cell) const
+{
   unsigned int mx{};
   unsigned int my{};
   if (!worldToMap(wx, wy, mx, my)) {
     RCLCPP_DEBUG(logger_, "Computing map coords failed");
     return;
   }
-  const unsigned int index = getIndex(mx, my);
-  marker(index);
+  write_cell(getIndex(mx, my), cost);
 }
 
 void OccupancyGridMap::raytrace(
   const double source_x, const double source_y, const double target_x, const double target_y,
   const unsigned char cost)
+{
+  auto write_cell = [this](const unsigned int index, const unsigned char cost) {
+    costmap_[index] = cost;
+  };
+  raytrace(source_x, source_y, target_x, target_y, cost, write_cell);
+}
+
+template <typename CellWriter>
+void OccupancyGridMap::raytrace(
+  const double source_x, const double source_y, const double target_x, const double target_y,
+  const unsigned char cost, CellWriter & write_cell) const
 {
   unsigned int x0{};
   unsigned int y0{};
@@ -403,9 +521,31 @@ void OccupancyGridMap::raytrace(
     return;
   }
 
-  constexpr unsigned int cell_raytrace_range = 10000;  // large number to ignore range threshold
-  MarkCell marker(costmap_, cost);
-  raytraceLine(marker, x0, y0, x1, y1, cell_raytrace_range);
+  // integer DDA (Bresenham) over the flat cell buffer, the same cells as Costmap2D::raytraceLine
+  const int dx = static_cast<int>(x1) - static_cast<int>(x0);
+  const int dy = static_cast<int>(y1) - static_cast<int>(y0);
+  const unsigned int abs_dx = std::abs(dx);
+  const unsigned int abs_dy = std::abs(dy);
+  const int offset_dx = dx > 0 ? 1 : -1;
+  const int offset_dy = (dy > 0 ? 1 : -1) * static_cast<int>(size_x_);
+  const bool is_x_major = abs_dx >= abs_dy;
+  const unsigned int abs_da = is_x_major ? abs_dx : abs_dy;
+  const unsigned int abs_db = is_x_major ? abs_dy : abs_dx;
+  const int offset_a = is_x_major ? offset_dx : offset_dy;
+  const int offset_b = is_x_major ? offset_dy : offset_dx;
+
+  unsigned int offset = getIndex(x0, y0);
+  unsigned int error_b = abs_da / 2;
+  for (unsigned int i = 0; i < abs_da; ++i) {
+    write_cell(offset, cost);
+    offset += offset_a;
+    error_b += abs_db;
+    if (error_b >= abs_da) {
+      offset += offset_b;
+      error_b -= abs_da;
+    }
+  }
+  write_cell(offset, cost);
 }
 
 }  // namespace costmap_2d
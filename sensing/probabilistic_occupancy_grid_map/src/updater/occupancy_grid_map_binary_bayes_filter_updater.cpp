@@ -45,15 +45,26 @@ inline unsigned char OccupancyGridMapBBFUpdater::applyBBF(
     static_cast<unsigned char>(254));
 }
 
+void OccupancyGridMapBBFUpdater::createBBFTable()
+{
+  bbf_table_.resize(256 * 256);
+  for (int z = 0; z < 256; ++z) {
+    for (int o = 0; o < 256; ++o) {
+      bbf_table_[(z << 8) | o] = applyBBF(z, o);
+    }
+  }
+}
+
 bool OccupancyGridMapBBFUpdater::update(const Costmap2D & single_frame_occupancy_grid_map)
 {
   updateOrigin(
     single_frame_occupancy_grid_map.getOriginX(), single_frame_occupancy_grid_map.getOriginY());
-  for (unsigned int x = 0; x < getSizeInCellsX(); x++) {
-    for (unsigned int y = 0; y < getSizeInCellsY(); y++) {
-      unsigned int index = getIndex(x, y);
-      costmap_[index] = applyBBF(single_frame_occupancy_grid_map.getCost(x, y), costmap_[index]);
-    }
+  // both maps have the same size, so the cells are visited in memory order
+  const unsigned char * z = single_frame_occupancy_grid_map.getCharMap();
+  const unsigned char * table = bbf_table_.data();
+  const size_t cell_num = static_cast<size_t>(getSizeInCellsX()) * getSizeInCellsY();
+  for (size_t index = 0; index < cell_num; ++index) {
+    costmap_[index] = table[(static_cast<size_t>(z[index]) << 8) | costmap_[index]];
   }
   return true;
 }
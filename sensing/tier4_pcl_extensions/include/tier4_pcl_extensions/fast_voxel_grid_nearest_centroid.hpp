@@ -0,0 +1,93 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_HPP_
+#define TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_HPP_
+
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/point_types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace pcl
+{
+/** \brief Same output as VoxelGridNearestCentroid: every voxel is approximated with the input
+ * point closest to its centroid, and the voxels are output in ascending voxel index order.
+ *
+ * Instead of inserting every point into a std::map of leaves, the voxel index of every point is
+ * computed in parallel and the (voxel index, point index) pairs are sorted with a stable radix
+ * sort, so that the points of a voxel become one contiguous run. The runs are then reduced in
+ * parallel. All work buffers are members and are reused by the next call of filter().
+ */
+template <typename PointT>
+class FastVoxelGridNearestCentroid : public VoxelGrid<PointT>
+{
+protected:
+  using VoxelGrid<PointT>::filter_name_;
+  using VoxelGrid<PointT>::getClassName;
+  using VoxelGrid<PointT>::input_;
+  using VoxelGrid<PointT>::indices_;
+  using VoxelGrid<PointT>::filter_limit_negative_;
+  using VoxelGrid<PointT>::filter_limit_min_;
+  using VoxelGrid<PointT>::filter_limit_max_;
+  using VoxelGrid<PointT>::filter_field_name_;
+  using VoxelGrid<PointT>::min_points_per_voxel_;
+
+  using VoxelGrid<PointT>::min_b_;
+  using VoxelGrid<PointT>::max_b_;
+  using VoxelGrid<PointT>::inverse_leaf_size_;
+  using VoxelGrid<PointT>::div_b_;
+  using VoxelGrid<PointT>::divb_mul_;
+
+  typedef typename Filter<PointT>::PointCloud PointCloud;
+
+public:
+  typedef pcl::shared_ptr<FastVoxelGridNearestCentroid<PointT>> Ptr;
+  typedef pcl::shared_ptr<const FastVoxelGridNearestCentroid<PointT>> ConstPtr;
+
+  FastVoxelGridNearestCentroid() { filter_name_ = "FastVoxelGridNearestCentroid"; }
+
+protected:
+  /** \brief Filter cloud.
+   * \param[out] output cloud containing the point nearest to the centroid of each voxel
+   */
+  void applyFilter(PointCloud & output) override;
+
+  /** \brief Sort \ref voxel_indices_ and \ref point_indices_ by voxel index. */
+  void sortByVoxelIndex();
+
+  /** \brief Voxel index of each point, std::numeric_limits<uint32_t>::max() if it is skipped */
+  std::vector<std::uint32_t> voxel_indices_;
+
+  /** \brief Input point index of each entry of \ref voxel_indices_ */
+  std::vector<std::uint32_t> point_indices_;
+
+  /** \brief Scratch buffers of the radix sort */
+  std::vector<std::uint32_t> sorted_voxel_indices_;
+  std::vector<std::uint32_t> sorted_point_indices_;
+
+  /** \brief Begin of each voxel in the sorted buffers, followed by the end of the last voxel */
+  std::vector<std::size_t> voxel_begins_;
+
+  /** \brief Selected input point index of each voxel, -1 if the voxel has too few points */
+  std::vector<std::int64_t> nearest_point_indices_;
+};
+}  // namespace pcl
+
+#ifdef PCL_NO_PRECOMPILE
+#include "tier4_pcl_extensions/fast_voxel_grid_nearest_centroid_impl.hpp"
+#endif
+
+#endif  // TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_HPP_
@@ -0,0 +1,241 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_IMPL_HPP_
+#define TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_IMPL_HPP_
+
+#include "tier4_pcl_extensions/fast_voxel_grid_nearest_centroid.hpp"
+
+#include <pcl/common/common.h>
+#include <pcl/common/io.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void pcl::FastVoxelGridNearestCentroid<PointT>::applyFilter(PointCloud & output)
+{
+  // Has the input dataset been set already?
+  if (!input_) {
+    PCL_WARN("[pcl::%s::applyFilter] No input dataset given!\n", getClassName().c_str());
+    output.width = output.height = 0;
+    output.points.clear();
+    return;
+  }
+
+  output.height = 1;       // downsampling breaks the organized structure
+  output.is_dense = true;  // we filter out invalid points
+  output.points.clear();
+
+  // Get the offset of the field used to filter points, if any
+  int distance_offset = -1;
+  if (!filter_field_name_.empty()) {
+    std::vector<pcl::PCLPointField> fields;
+    const int distance_idx = pcl::getFieldIndex<PointT>(filter_field_name_, fields);
+    if (distance_idx == -1) {
+      PCL_WARN(
+        "[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName().c_str(),
+        distance_idx);
+      output.width = 0;
+      return;
+    }
+    distance_offset = static_cast<int>(fields[distance_idx].offset);
+  }
+
+  // Get the minimum and maximum dimensions
+  Eigen::Vector4f min_p, max_p;
+  if (!filter_field_name_.empty()) {
+    getMinMax3D<PointT>(
+      input_, *indices_, filter_field_name_, static_cast<float>(filter_limit_min_),
+      static_cast<float>(filter_limit_max_), min_p, max_p, filter_limit_negative_);
+  } else {
+    getMinMax3D<PointT>(*input_, *indices_, min_p, max_p);
+  }
+
+  // Check that the leaf size is not too small, given the size of the data
+  std::int64_t dx = static_cast<std::int64_t>((max_p[0] - min_p[0]) * inverse_leaf_size_[0]) + 1;
+  std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1]) + 1;
+  std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2]) + 1;
+
+  if ((dx * dy * dz) > std::numeric_limits<std::int32_t>::max()) {
+    PCL_WARN(
+      "[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would "
+      "overflow.",  // NOLINT
+      getClassName().c_str());
+    output.clear();
+    return;
+  }
+
+  // Compute the minimum and maximum bounding box values
+  min_b_[0] = static_cast<int>(floor(min_p[0] * inverse_leaf_size_[0]));
+  max_b_[0] = static_cast<int>(floor(max_p[0] * inverse_leaf_size_[0]));
+  min_b_[1] = static_cast<int>(floor(min_p[1] * inverse_leaf_size_[1]));
+  max_b_[1] = static_cast<int>(floor(max_p[1] * inverse_leaf_size_[1]));
+  min_b_[2] = static_cast<int>(floor(min_p[2] * inverse_leaf_size_[2]));
+  max_b_[2] = static_cast<int>(floor(max_p[2] * inverse_leaf_size_[2]));
+
+  // Compute the number of divisions needed along all axis
+  div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones();
+  div_b_[3] = 0;
+
+  // Set up the division multiplier
+  divb_mul_ = Eigen::Vector4i(1, div_b_[0], div_b_[0] * div_b_[1], 0);
+
+  // First pass: compute the voxel index of every point
+  constexpr std::uint32_t skipped = std::numeric_limits<std::uint32_t>::max();
+  const auto num_points = static_cast<std::int64_t>(indices_->size());
+  voxel_indices_.resize(num_points);
+  point_indices_.resize(num_points);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (std::int64_t i = 0; i < num_points; ++i) {
+    const auto cp = (*indices_)[i];
+    const PointT & pt = input_->points[cp];
+    point_indices_[i] = static_cast<std::uint32_t>(cp);
+    voxel_indices_[i] = skipped;
+
+    if (!input_->is_dense) {
+      // Check if the point is invalid
+      if (!std::isfinite(pt.x) || !std::isfinite(pt.y) || !std::isfinite(pt.z)) {
+        continue;
+      }
+    }
+
+    if (distance_offset >= 0) {
+      float distance_value = 0;
+      memcpy(
+        &distance_value, reinterpret_cast<const std::uint8_t *>(&pt) + distance_offset,
+        sizeof(float));
+      if (filter_limit_negative_) {
+        // Use a threshold for cutting out points which inside the interval
+        if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_)) {
+          continue;
+        }
+      } else {
+        // Use a threshold for cutting out points which are too close/far away
+        if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_)) {
+          continue;
+        }
+      }
+    }
+
+    int ijk0 =
+      static_cast<int>(floor(pt.x * inverse_leaf_size_[0]) - static_cast<float>(min_b_[0]));
+    int ijk1 =
+      static_cast<int>(floor(pt.y * inverse_leaf_size_[1]) - static_cast<float>(min_b_[1]));
+    int ijk2 =
+      static_cast<int>(floor(pt.z * inverse_leaf_size_[2]) - static_cast<float>(min_b_[2]));
+    voxel_indices_[i] =
+      static_cast<std::uint32_t>(ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2]);
+  }
+
+  // Second pass: make the points of each voxel contiguous, skipped points come last
+  sortByVoxelIndex();
+
+  const auto num_valid = static_cast<std::size_t>(
+    std::lower_bound(voxel_indices_.begin(), voxel_indices_.end(), skipped) -
+    voxel_indices_.begin());
+  voxel_begins_.clear();
+  for (std::size_t i = 0; i < num_valid; ++i) {
+    if (i == 0 || voxel_indices_[i] != voxel_indices_[i - 1]) {
+      voxel_begins_.push_back(i);
+    }
+  }
+  voxel_begins_.push_back(num_valid);
+
+  // Third pass: find the point nearest to the centroid of each voxel
+  const auto num_voxels = static_cast<std::int64_t>(voxel_begins_.size()) - 1;
+  nearest_point_indices_.assign(std::max<std::int64_t>(num_voxels, 0), -1);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (std::int64_t v = 0; v < num_voxels; ++v) {
+    const auto begin = voxel_begins_[v];
+    const auto end = voxel_begins_[v + 1];
+    if (end - begin < min_points_per_voxel_) {
+      continue;
+    }
+
+    Eigen::Vector4f centroid = Eigen::Vector4f::Zero();
+    for (auto k = begin; k < end; ++k) {
+      const PointT & p = input_->points[point_indices_[k]];
+      centroid += Eigen::Vector4f(p.x, p.y, p.z, 0);
+    }
+    centroid /= static_cast<float>(end - begin);
+
+    float min_squared_distance = std::numeric_limits<float>::max();
+    for (auto k = begin; k < end; ++k) {
+      const PointT & p = input_->points[point_indices_[k]];
+      const float squared_distance = (p.x - centroid[0]) * (p.x - centroid[0]) +
+                                     (p.y - centroid[1]) * (p.y - centroid[1]) +
+                                     (p.z - centroid[2]) * (p.z - centroid[2]);
+      if (squared_distance < min_squared_distance) {
+        min_squared_distance = squared_distance;
+        nearest_point_indices_[v] = point_indices_[k];
+      }
+    }
+  }
+
+  output.points.reserve(nearest_point_indices_.size());
+  for (const auto index : nearest_point_indices_) {
+    if (index >= 0) {
+      output.points.push_back(input_->points[index]);
+    }
+  }
+  output.width = static_cast<std::uint32_t>(output.points.size());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void pcl::FastVoxelGridNearestCentroid<PointT>::sortByVoxelIndex()
+{
+  // LSD radix sort with 8 bit digits, which is stable and so keeps the input order in a voxel
+  const std::size_t num_points = voxel_indices_.size();
+  sorted_voxel_indices_.resize(num_points);
+  sorted_point_indices_.resize(num_points);
+
+  for (int shift = 0; shift < 32; shift += 8) {
+    std::array<std::size_t, 257> offsets{};
+    for (const auto voxel_index : voxel_indices_) {
+      ++offsets[((voxel_index >> shift) & 0xff) + 1];
+    }
+    // nothing to do if all the points have the same digit
+    if (std::find(offsets.begin() + 1, offsets.end(), num_points) != offsets.end()) {
+      continue;
+    }
+    for (std::size_t d = 1; d < offsets.size(); ++d) {
+      offsets[d] += offsets[d - 1];
+    }
+    for (std::size_t i = 0; i < num_points; ++i) {
+      const std::size_t dst = offsets[(voxel_indices_[i] >> shift) & 0xff]++;
+      sorted_voxel_indices_[dst] = voxel_indices_[i];
+      sorted_point_indices_[dst] = point_indices_[i];
+    }
+    std::swap(voxel_indices_, sorted_voxel_indices_);
+    std::swap(point_indices_, sorted_point_indices_);
+  }
+}
+
+#define PCL_INSTANTIATE_FastVoxelGridNearestCentroid(T) \
+  template class PCL_EXPORTS pcl::FastVoxelGridNearestCentroid<T>;
+
+#endif  // TIER4_PCL_EXTENSIONS__FAST_VOXEL_GRID_NEAREST_CENTROID_IMPL_HPP_
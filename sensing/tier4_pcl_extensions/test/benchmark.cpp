@@ -0,0 +1,125 @@
+// Copyright 2022 Tier IV, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tier4_pcl_extensions/fast_voxel_grid_nearest_centroid.hpp"
+#include "tier4_pcl_extensions/voxel_grid_nearest_centroid.hpp"
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace
+{
+// a ring scan of the ground with some walls, roughly like a 128 ring lidar at ~10 Hz
+pcl::PointCloud<pcl::PointXYZ>::Ptr generateCloud(const size_t num_points, std::mt19937 & engine)
+{
+  std::uniform_real_distribution<float> angle_dist(-M_PI, M_PI);
+  std::exponential_distribution<float> range_dist(1.0f / 20.0f);
+  std::normal_distribution<float> noise_dist(0.0f, 0.02f);
+  std::uniform_real_distribution<float> height_dist(0.0f, 3.0f);
+  std::bernoulli_distribution is_wall_dist(0.3);
+
+  auto cloud = pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>();
+  cloud->points.reserve(num_points);
+  for (size_t i = 0; i < num_points; ++i) {
+    const float angle = angle_dist(engine);
+    const float range = 2.0f + range_dist(engine);
+    const float z = is_wall_dist(engine) ? height_dist(engine) : noise_dist(engine);
+    cloud->points.emplace_back(range * std::cos(angle), range * std::sin(angle), z);
+  }
+  cloud->width = static_cast<uint32_t>(cloud->points.size());
+  cloud->height = 1;
+  return cloud;
+}
+
+template <class FilterT>
+double measure(
+  FilterT & filter, const pcl::PointCloud<pcl::PointXYZ>::Ptr & input,
+  pcl::PointCloud<pcl::PointXYZ> & output)
+{
+  const auto start = std::chrono::steady_clock::now();
+  filter.setInputCloud(input);
+  filter.filter(output);
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool isSameCloud(
+  const pcl::PointCloud<pcl::PointXYZ> & a, const pcl::PointCloud<pcl::PointXYZ> & b)
+{
+  if (a.points.size() != b.points.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.points.size(); ++i) {
+    if (
+      a.points[i].x != b.points[i].x || a.points[i].y != b.points[i].y ||
+      a.points[i].z != b.points[i].z) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main()
+{
+  std::ofstream result_file;
+  result_file.open("benchmark_results.csv");
+  result_file << "#NumPoints NumVoxels VoxelGridNearestCentroid FastVoxelGridNearestCentroid\n";
+
+  constexpr auto nb_iterations = 20;
+  constexpr float leaf_size_x = 0.3f;
+  constexpr float leaf_size_y = 0.3f;
+  constexpr float leaf_size_z = 0.1f;
+  std::mt19937 engine(0);
+
+  // the fast filter is kept between frames as in ApproximateDownsampleFilterComponent
+  pcl::FastVoxelGridNearestCentroid<pcl::PointXYZ> fast_filter;
+  fast_filter.setLeafSize(leaf_size_x, leaf_size_y, leaf_size_z);
+
+  for (const size_t num_points : {100000, 200000, 300000}) {
+    double map_duration_ms = 0.0;
+    double fast_duration_ms = 0.0;
+    size_t num_voxels = 0;
+    for (int i = 0; i < nb_iterations; ++i) {
+      const auto input = generateCloud(num_points, engine);
+
+      pcl::VoxelGridNearestCentroid<pcl::PointXYZ> map_filter;
+      map_filter.setLeafSize(leaf_size_x, leaf_size_y, leaf_size_z);
+      pcl::PointCloud<pcl::PointXYZ> map_output;
+      map_duration_ms += measure(map_filter, input, map_output);
+
+      pcl::PointCloud<pcl::PointXYZ> fast_output;
+      fast_duration_ms += measure(fast_filter, input, fast_output);
+
+      if (!isSameCloud(map_output, fast_output)) {
+        std::cerr << "outputs differ for " << num_points << " points" << std::endl;
+        return 1;
+      }
+      num_voxels = fast_output.points.size();
+    }
+    std::cout << num_points << " points: VoxelGridNearestCentroid "
+              << map_duration_ms / nb_iterations << " ms, FastVoxelGridNearestCentroid "
+              << fast_duration_ms / nb_iterations << " ms" << std::endl;
+    result_file << num_points << " " << num_voxels << " " << map_duration_ms / nb_iterations
+                << " " << fast_duration_ms / nb_iterations << "\n";
+  }
+  result_file.close();
+  return 0;
+}